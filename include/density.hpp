@@ -0,0 +1,255 @@
+// -*- C++ -*-
+//
+//===---------------------------- density ---------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file was largely inspired by the chrono library
+//  from the LLVM Compiler Infrastructure.
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_DENSITY_HPP
+#define METRICS_DENSITY_HPP
+
+#include "metric_config.hpp"
+#include "mass.hpp"
+#include "volume.hpp"
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace metric {
+
+// Gram per litre based, which is also kilogram per cubic metre.
+template <class _Rep, class _Period = std::ratio<1> > class density;
+
+template <typename A> struct __is_density: __is_specialization<A, density> {};
+
+
+template <class _ToDensity, class _Rep, class _Period>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __is_density<_ToDensity>::value,
+    _ToDensity
+>::type
+density_cast(const density<_Rep, _Period>& __fd)
+{
+    return __metric_cast<density<_Rep, _Period>, _ToDensity>()(__fd);
+}
+
+template <class _Rep, class _Period>
+class density
+{
+    static_assert(!__is_density<_Rep>::value, "A density representation can not be a density");
+    static_assert(std::__is_ratio<_Period>::value, "Second template parameter of density must be a std::ratio");
+    static_assert(_Period::num > 0, "density period must be positive");
+
+public:
+    typedef _Rep rep;
+    typedef _Period period;
+private:
+    rep __rep_;
+public:
+
+    inline METRICCONSTEXPR
+    density() = default;
+
+    template <class _Rep2>
+        inline METRICCONSTEXPR
+        explicit density(const _Rep2& __r,
+            typename std::enable_if
+            <
+               std::is_convertible<_Rep2, rep>::value &&
+               (treat_as_floating_point<rep>::value ||
+               !treat_as_floating_point<_Rep2>::value)
+            >::type* = 0) noexcept
+                : __rep_(__r) {}
+
+    // conversions
+    template <class _Rep2, class _Period2>
+        inline METRICCONSTEXPR
+		density(const density<_Rep2, _Period2>& __d,
+            typename std::enable_if
+            <
+                __no_overflow<_Period2, period>::value && (
+                treat_as_floating_point<rep>::value ||
+                (__no_overflow<_Period2, period>::type::den == 1 &&
+                 !treat_as_floating_point<_Rep2>::value))
+            >::type* = 0) noexcept
+                : __rep_(metric::density_cast<density>(__d).count()) {}
+
+    // observer
+
+    inline METRICCONSTEXPR rep count() const noexcept {return __rep_;}
+
+    // arithmetic
+
+    inline METRICCONSTEXPR density  operator+() const {return *this;}
+    inline METRICCONSTEXPR density  operator-() const {return density(-__rep_);}
+    inline const density& operator++()      {++__rep_; return *this;}
+    inline const density  operator++(int)   {return density(__rep_++);}
+    inline const density& operator--()      {--__rep_; return *this;}
+    inline const density  operator--(int)   {return density(__rep_--);}
+
+    inline const density& operator+=(const density& __d) {__rep_ += __d.count(); return *this;}
+    inline const density& operator-=(const density& __d) {__rep_ -= __d.count(); return *this;}
+
+    inline const density& operator*=(const rep& rhs) {__rep_ *= rhs; return *this;}
+    inline const density& operator/=(const rep& rhs) {__rep_ /= rhs; return *this;}
+    inline const density& operator%=(const rep& rhs) {__rep_ %= rhs; return *this;}
+    inline const density& operator%=(const density& rhs) {__rep_ %= rhs.count(); return *this;}
+
+    // special values
+
+    inline static METRICCONSTEXPR density zero() {return density(limits_values<rep>::zero());}
+    inline static METRICCONSTEXPR density min()  {return density(limits_values<rep>::min());}
+    inline static METRICCONSTEXPR density max()  {return density(limits_values<rep>::max());}
+};
+
+
+typedef density<long long, std::milli> milligram_per_litre;
+typedef density<long long            > gram_per_litre;
+typedef density<long long            > kilogram_per_cubic_metre;
+typedef density<long long, std::kilo > kilogram_per_litre;      // Also gram per millilitre.
+
+namespace literals {
+constexpr      milligram_per_litre operator ""_mg_l(unsigned long long v)  { return      milligram_per_litre(v); }
+constexpr           gram_per_litre operator ""_g_l(unsigned long long v)   { return           gram_per_litre(v); }
+constexpr kilogram_per_cubic_metre operator ""_kg_m3(unsigned long long v) { return kilogram_per_cubic_metre(v); }
+constexpr       kilogram_per_litre operator ""_kg_l(unsigned long long v)  { return       kilogram_per_litre(v); }
+} // namespace literals
+
+
+// Density of a fluid as a function of its temperature, in kilogram per cubic metre.
+namespace fluid {
+
+struct water    // Air saturated, 0 to 40 °C.  Source: https://www.ncbi.nlm.nih.gov/pmc/articles/PMC4909168/
+{
+    static METRICCONSTEXPR double value(double __celsius)
+    {
+        return 999.84847 + __celsius * (6.337563e-2 + __celsius * (-8.523829e-3 + __celsius * (6.943248e-5 + __celsius * -3.821216e-7)));
+    }
+};
+
+struct mercury  // Source: Techniques de l'ingénieur, K64, masse volumique du mercure.
+{
+    static METRICCONSTEXPR double value(double __celsius)
+    {
+        return 13595.1 / (1 + 1.818e-4 * __celsius);
+    }
+};
+
+} // namespace fluid
+
+
+template <class _Fluid, int _Min, unsigned _Steps, class _Sequence> struct __density_samples;
+
+template <class _Fluid, int _Min, unsigned _Steps, std::size_t... _Ip>
+struct __density_samples<_Fluid, _Min, _Steps, __index_sequence<_Ip...> >
+{
+    static constexpr double values[sizeof...(_Ip)] = {_Fluid::value(_Min + static_cast<double>(_Ip) / _Steps)...};
+};
+
+template <class _Fluid, int _Min, unsigned _Steps, std::size_t... _Ip>
+constexpr double __density_samples<_Fluid, _Min, _Steps, __index_sequence<_Ip...> >::values[sizeof...(_Ip)];
+
+
+// Volumes and masses computed in double: integral counts are rounded to nearest, ties to even.
+template <class _Metric, bool = treat_as_floating_point<typename _Metric::rep>::value>
+struct __density_out
+{
+    static inline _Metric __apply(double __v) {return _Metric(static_cast<typename _Metric::rep>(__v));}
+};
+
+template <class _Metric>
+struct __density_out<_Metric, false>
+{
+    static inline _Metric __apply(double __v) {return _Metric(static_cast<typename _Metric::rep>(std::nearbyint(__v)));}
+};
+
+
+// Density of _Fluid sampled at compile time every 1 / _Steps °C from _Min to _Max °C.  At run
+// time a density is a lookup and a linear interpolation between two samples; temperatures out
+// of the range are clamped to it.
+template <class _Fluid, int _Min, int _Max, unsigned _Steps = 4>
+class density_table
+{
+    static_assert(_Min < _Max, "density_table needs a temperature range");
+    static_assert(_Steps > 0, "density_table needs at least one sample per degree");
+
+public:
+    typedef density<double> value_type;
+    static const std::size_t size = static_cast<std::size_t>(_Max - _Min) * _Steps + 1;
+
+private:
+    typedef __density_samples<_Fluid, _Min, _Steps, typename __make_index_sequence<size>::type> __samples;
+
+    static inline double __lerp(double __celsius)
+    {
+        double __x = (__celsius - _Min) * _Steps;
+        __x = __x > 0 ? __x : 0;
+        __x = __x < size - 1 ? __x : size - 1;
+        std::size_t __i = static_cast<std::size_t>(__x);
+        __i = __i < size - 2 ? __i : size - 2;
+        const double __f = __x - static_cast<double>(__i);
+        return __samples::values[__i] + (__samples::values[__i + 1] - __samples::values[__i]) * __f;
+    }
+
+public:
+    // The __i-th sample, at _Min + __i / _Steps °C.
+    static inline METRICCONSTEXPR value_type sample(std::size_t __i) {return value_type(__samples::values[__i]);}
+
+    // The density given by the formula, for constant expressions.
+    static inline METRICCONSTEXPR value_type exact(double __celsius) {return value_type(_Fluid::value(__celsius));}
+
+    static inline value_type at(double __celsius) {return value_type(__lerp(__celsius));}
+
+    // Volume of a mass of fluid, and mass of a volume, at the given temperature.
+    template <class _ToVolume, class _Rep, class _Period>
+    static inline _ToVolume volume_of(const mass<_Rep, _Period>& __m, double __celsius)
+    {
+        typedef typename std::ratio_divide<_Period, typename _ToVolume::period>::type _Scale;
+        return __density_out<_ToVolume>::__apply(static_cast<double>(__m.count()) * _Scale::num / _Scale::den / __lerp(__celsius));
+    }
+
+    template <class _ToMass, class _Rep, class _Period>
+    static inline _ToMass mass_of(const volume<_Rep, _Period>& __v, double __celsius)
+    {
+        typedef typename std::ratio_divide<_Period, typename _ToMass::period>::type _Scale;
+        return __density_out<_ToMass>::__apply(static_cast<double>(__v.count()) * _Scale::num / _Scale::den * __lerp(__celsius));
+    }
+
+    // Batch kernels: element-wise volume_of / mass_of of a range of metrics and a range of
+    // temperatures in °C.
+    template <class _ToVolume, class _InputIterator, class _TemperatureIterator, class _OutputIterator>
+    static _OutputIterator volumes(_InputIterator __first, _InputIterator __last, _TemperatureIterator __celsius, _OutputIterator __out)
+    {
+        for (; __first != __last; ++__first, (void) ++__celsius, (void) ++__out)
+            *__out = volume_of<_ToVolume>(*__first, *__celsius);
+        return __out;
+    }
+
+    template <class _ToMass, class _InputIterator, class _TemperatureIterator, class _OutputIterator>
+    static _OutputIterator masses(_InputIterator __first, _InputIterator __last, _TemperatureIterator __celsius, _OutputIterator __out)
+    {
+        for (; __first != __last; ++__first, (void) ++__celsius, (void) ++__out)
+            *__out = mass_of<_ToMass>(*__first, *__celsius);
+        return __out;
+    }
+};
+
+template <class _Fluid, int _Min, int _Max, unsigned _Steps>
+const std::size_t density_table<_Fluid, _Min, _Max, _Steps>::size;
+
+typedef density_table<fluid::water,     0,  40, 8> water_density;
+typedef density_table<fluid::mercury, -20, 100, 4> mercury_density;
+
+} // namespace metric
+
+#endif // METRICS_DENSITY_HPP
@@ -30,6 +30,42 @@ struct __operator_mixunit_result
 };
 
 
+// The scale of each (lhs period, rhs period, result period) triple is folded into a single
+// compile time ratio: the operands are used as is, no intermediate conversion to _Cd.
+
+// count(_Cd) = lhs * rhs * (P1 * P2 / Pcd)
+template <class _Cd, class _Period1, class _Period2>
+struct __mixunit_product
+{
+    typedef typename std::ratio_divide<typename std::ratio_multiply<_Period1, _Period2>::type,
+                                       typename _Cd::period>::type _Scale;
+    typedef typename _Cd::rep _Ct;
+
+    template <class _Rep1, class _Rep2>
+    inline METRICCONSTEXPR
+    _Cd operator()(const _Rep1& __lhs, const _Rep2& __rhs) const noexcept
+    {
+        return _Cd(static_cast<_Ct>(__lhs) * static_cast<_Ct>(__rhs) * _Scale::num / _Scale::den);
+    }
+};
+
+// count(_Cd) = lhs * (P1 / (P2 * Pcd)) / rhs
+template <class _Cd, class _Period1, class _Period2>
+struct __mixunit_quotient
+{
+    typedef typename std::ratio_divide<_Period1,
+                                       typename std::ratio_multiply<_Period2, typename _Cd::period>::type>::type _Scale;
+    typedef typename _Cd::rep _Ct;
+
+    template <class _Rep1, class _Rep2>
+    inline METRICCONSTEXPR
+    _Cd operator()(const _Rep1& __lhs, const _Rep2& __rhs) const noexcept
+    {
+        return _Cd((static_cast<_Ct>(__lhs) * _Scale::num) / (static_cast<_Ct>(__rhs) * _Scale::den));
+    }
+};
+
+
 // U = R * I
 template <typename ResistanceRep, typename ResistancePeriod, typename CurrentRep, typename CurrentPeriod>
 inline
@@ -37,12 +73,10 @@ METRICCONSTEXPR
 typename __operator_mixunit_result<voltage, ResistanceRep, ResistancePeriod, CurrentRep, CurrentPeriod>::type
 operator*(
 	const electricresistance<ResistanceRep, ResistancePeriod>& r,
-	const electriccurrent<CurrentRep, CurrentPeriod>& i)
+	const electriccurrent<CurrentRep, CurrentPeriod>& i) noexcept
 {
     typedef typename __operator_mixunit_result<voltage, ResistanceRep, ResistancePeriod, CurrentRep, CurrentPeriod>::type _Cd;
-    typedef electricresistance<typename _Cd::rep, typename _Cd::period> _R;
-    typedef electriccurrent<typename _Cd::rep, typename _Cd::period> _I;
-	return _Cd(_R(r).count() * _I(i).count() * _Cd::period::num / _Cd::period::den);
+    return __mixunit_product<_Cd, ResistancePeriod, CurrentPeriod>()(r.count(), i.count());
 }
 
 template <typename ResistanceRep, typename ResistancePeriod, typename CurrentRep, typename CurrentPeriod>
@@ -51,12 +85,10 @@ METRICCONSTEXPR
 typename __operator_mixunit_result<voltage, ResistanceRep, ResistancePeriod, CurrentRep, CurrentPeriod>::type
 operator*(
 	const electriccurrent<CurrentRep, CurrentPeriod>& i,
-	const electricresistance<ResistanceRep, ResistancePeriod>& r)
+	const electricresistance<ResistanceRep, ResistancePeriod>& r) noexcept
 {
     typedef typename __operator_mixunit_result<voltage, ResistanceRep, ResistancePeriod, CurrentRep, CurrentPeriod>::type _Cd;
-    typedef electricresistance<typename _Cd::rep, typename _Cd::period> _R;
-    typedef electriccurrent<typename _Cd::rep, typename _Cd::period> _I;
-	return _Cd(_R(r).count() * _I(i).count() * _Cd::period::num / _Cd::period::den);
+    return __mixunit_product<_Cd, ResistancePeriod, CurrentPeriod>()(r.count(), i.count());
 }
 
 
@@ -67,12 +99,10 @@ METRICCONSTEXPR
 typename __operator_mixunit_result<electricresistance, VoltageRep, VoltagePeriod, CurrentRep, CurrentPeriod>::type
 operator/(
 	const voltage<VoltageRep, VoltagePeriod>& v,
-	const electriccurrent<CurrentRep, CurrentPeriod>& i)
+	const electriccurrent<CurrentRep, CurrentPeriod>& i) noexcept
 {
     typedef typename __operator_mixunit_result<electricresistance, VoltageRep, VoltagePeriod, CurrentRep, CurrentPeriod>::type _Cd;
-    typedef voltage<typename _Cd::rep, typename _Cd::period> _V;
-    typedef electriccurrent<typename _Cd::rep, typename _Cd::period> _I;
-    return _Cd((_V(v).count() * _Cd::period::den) / (_I(i).count() * _Cd::period::num));
+    return __mixunit_quotient<_Cd, VoltagePeriod, CurrentPeriod>()(v.count(), i.count());
 }
 
 
@@ -83,12 +113,10 @@ METRICCONSTEXPR
 typename __operator_mixunit_result<electriccurrent, VoltageRep, VoltagePeriod, ResistanceRep, ResistancePeriod>::type
 operator/(
 	const voltage<VoltageRep, VoltagePeriod>& v,
-	const electricresistance<ResistanceRep, ResistancePeriod>& r)
+	const electricresistance<ResistanceRep, ResistancePeriod>& r) noexcept
 {
     typedef typename __operator_mixunit_result<electriccurrent, VoltageRep, VoltagePeriod, ResistanceRep, ResistancePeriod>::type _Cd;
-    typedef voltage<typename _Cd::rep, typename _Cd::period> _V;
-    typedef electricresistance<typename _Cd::rep, typename _Cd::period> _R;
-    return _Cd((_V(v).count() * _Cd::period::den) / (_R(r).count() * _Cd::period::num));
+    return __mixunit_quotient<_Cd, VoltagePeriod, ResistancePeriod>()(v.count(), r.count());
 }
 
 
@@ -99,12 +127,10 @@ METRICCONSTEXPR
 typename __operator_mixunit_result<power, VoltageRep, VoltagePeriod, CurrentRep, CurrentPeriod>::type
 operator*(
 	const voltage<VoltageRep, VoltagePeriod>& u,
-	const electriccurrent<CurrentRep, CurrentPeriod>& i)
+	const electriccurrent<CurrentRep, CurrentPeriod>& i) noexcept
 {
     typedef typename __operator_mixunit_result<power, VoltageRep, VoltagePeriod, CurrentRep, CurrentPeriod>::type _Cd;
-    typedef voltage<typename _Cd::rep, typename _Cd::period> _U;
-    typedef electriccurrent<typename _Cd::rep, typename _Cd::period> _I;
-	return _Cd(_U(u).count() * _I(i).count() * _Cd::period::num / _Cd::period::den);
+    return __mixunit_product<_Cd, VoltagePeriod, CurrentPeriod>()(u.count(), i.count());
 }
 
 template <typename VoltageRep, typename VoltagePeriod, typename CurrentRep, typename CurrentPeriod>
@@ -113,12 +139,10 @@ METRICCONSTEXPR
 typename __operator_mixunit_result<power, VoltageRep, VoltagePeriod, CurrentRep, CurrentPeriod>::type
 operator*(
 	const electriccurrent<CurrentRep, CurrentPeriod>& i,
-	const voltage<VoltageRep, VoltagePeriod>& u)
+	const voltage<VoltageRep, VoltagePeriod>& u) noexcept
 {
     typedef typename __operator_mixunit_result<power, VoltageRep, VoltagePeriod, CurrentRep, CurrentPeriod>::type _Cd;
-    typedef voltage<typename _Cd::rep, typename _Cd::period> _U;
-    typedef electriccurrent<typename _Cd::rep, typename _Cd::period> _I;
-	return _Cd(_U(u).count() * _I(i).count() * _Cd::period::num / _Cd::period::den);
+    return __mixunit_product<_Cd, VoltagePeriod, CurrentPeriod>()(u.count(), i.count());
 }
 
 
@@ -129,12 +153,10 @@ METRICCONSTEXPR
 typename __operator_mixunit_result<electriccurrent, PowerRep, PowerPeriod, VoltageRep, VoltagePeriod>::type
 operator/(
 	const power<PowerRep, PowerPeriod>& p,
-	const voltage<VoltageRep, VoltagePeriod>& v)
+	const voltage<VoltageRep, VoltagePeriod>& v) noexcept
 {
     typedef typename __operator_mixunit_result<electriccurrent, PowerRep, PowerPeriod, VoltageRep, VoltagePeriod>::type _Cd;
-    typedef power<typename _Cd::rep, typename _Cd::period> _P;
-    typedef voltage<typename _Cd::rep, typename _Cd::period> _V;
-    return _Cd((_P(p).count() * _Cd::period::den) / (_V(v).count() * _Cd::period::num));
+    return __mixunit_quotient<_Cd, PowerPeriod, VoltagePeriod>()(p.count(), v.count());
 }
 
 // U = P / I
@@ -144,12 +166,10 @@ METRICCONSTEXPR
 typename __operator_mixunit_result<voltage, PowerRep, PowerPeriod, CurrentRep, CurrentPeriod>::type
 operator/(
 	const power<PowerRep, PowerPeriod>& p,
-	const electriccurrent<CurrentRep, CurrentPeriod>& i)
+	const electriccurrent<CurrentRep, CurrentPeriod>& i) noexcept
 {
     typedef typename __operator_mixunit_result<voltage, PowerRep, PowerPeriod, CurrentRep, CurrentPeriod>::type _Cd;
-    typedef power<typename _Cd::rep, typename _Cd::period> _P;
-    typedef electriccurrent<typename _Cd::rep, typename _Cd::period> _I;
-    return _Cd((_P(p).count() * _Cd::period::den) / (_I(i).count() * _Cd::period::num));
+    return __mixunit_quotient<_Cd, PowerPeriod, CurrentPeriod>()(p.count(), i.count());
 }
 
 
@@ -59,136 +59,6 @@ namespace std
 
 namespace metric {
 
-template <class _FromEnergy, class _ToEnergy,
-    class _PeriodPower = typename std::ratio_divide<typename _FromEnergy::power_period, typename _ToEnergy::power_period>::type,
-    class _PeriodDuration = typename std::ratio_divide<typename _FromEnergy::duration_period, typename _ToEnergy::duration_period>::type,
-    bool = _PeriodPower::num == 1,
-    bool = _PeriodPower::den == 1,
-    bool = _PeriodDuration::num == 1,
-    bool = _PeriodDuration::den == 1>
-    struct __energy_cast;
-
-template <class _FromPower, class _ToPower, class _PeriodPower, class _PeriodDuration>
-struct __energy_cast<_FromPower, _ToPower, _PeriodPower, _PeriodDuration, true, true, true, true>
-{
-    inline  _ToPower operator()(const _FromPower& __fd) const
-    {
-        return _ToPower(static_cast<typename _ToPower::power_rep>(__fd.count()));
-    }
-};
-
-template <class _FromPower, class _ToPower, class _PeriodPower, class _PeriodDuration>
-struct __energy_cast<_FromPower, _ToPower, _PeriodPower, _PeriodDuration, true, true, false, true>
-{
-    inline
-        _ToPower operator()(const _FromPower& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToPower::power_rep, typename _FromPower::power_rep, intmax_t>::type _Ct;
-
-        return _ToPower(static_cast<typename _ToPower::power_rep>(
-            static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodDuration::num)));
-    }
-};
-
-template <class _FromPower, class _ToPower, class _PeriodPower, class _PeriodDuration>
-struct __energy_cast<_FromPower, _ToPower, _PeriodPower, _PeriodDuration, true, true, true, false>
-{
-    inline
-        _ToPower operator()(const _FromPower& __fd) const
-    {
-        typedef typename std::common_type<typename _ToPower::power_rep, typename _FromPower::power_rep, intmax_t>::type _Ct;
-
-        return _ToPower(static_cast<typename _ToPower::power_rep>(
-            static_cast<_Ct>(__fd.count()) / static_cast<_Ct>(_PeriodDuration::den)));
-    }
-};
-
-
-template <class _FromPower, class _ToPower, class _PeriodPower, class _PeriodDuration>
-struct __energy_cast<_FromPower, _ToPower, _PeriodPower, _PeriodDuration, false, true, false, true>
-{
-    inline
-        _ToPower operator()(const _FromPower& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToPower::power_rep, typename _FromPower::power_rep, intmax_t>::type _Ct;
-
-        return _ToPower(static_cast<typename _ToPower::power_rep>(
-        		(static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodPower::num)) * static_cast<_Ct>(_PeriodDuration::num)));
-    }
-};
-
-template <class _FromPower, class _ToPower, class _PeriodPower, class _PeriodDuration>
-struct __energy_cast<_FromPower, _ToPower, _PeriodPower, _PeriodDuration, false, true, true, true>
-{
-    inline
-        _ToPower operator()(const _FromPower& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToPower::power_rep, typename _FromPower::power_rep, intmax_t>::type _Ct;
-
-        return _ToPower(static_cast<typename _ToPower::power_rep>(
-            static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodPower::num)));
-    }
-};
-
-/*
-template <class _FromPower, class _ToPower, class _PeriodPower, class _PeriodDuration>
-struct __energy_cast<_FromPower, _ToPower, _PeriodPower, _PeriodDuration, false, false, true, true>
-{
-    inline
-        _ToPower operator()(const _FromPower& __fd) const
-    {
-        typedef typename std::common_type<typename _ToPower::power_rep, typename _FromPower::power_rep, intmax_t>::type _Ct;
-
-        return _ToPower(static_cast<typename _ToPower::power_rep>(
-            static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodPower::num)
-										   / static_cast<_Ct>(_PeriodPower::den) ));
-    }
-};
-
-template <class _FromPower, class _ToPower, class _PeriodPower, class _PeriodDuration>
-struct __energy_cast<_FromPower, _ToPower, _PeriodPower, _PeriodDuration, false, true, true, false>
-{
-    inline
-        _ToPower operator()(const _FromPower& __fd) const
-    {
-        typedef typename std::common_type<typename _ToPower::power_rep, typename _FromPower::power_rep, intmax_t>::type _Ct;
-
-        return _ToPower(static_cast<typename _ToPower::power_rep>(
-        		(static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodPower::num)) * static_cast<_Ct>(_PeriodDuration::den)));
-    }
-};
-*/
-
-template <class _FromPower, class _ToPower, class _PeriodPower, class _PeriodDuration>
-struct __energy_cast<_FromPower, _ToPower, _PeriodPower, _PeriodDuration, true, false, false, true>
-{
-    inline
-        _ToPower operator()(const _FromPower& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToPower::power_rep, typename _FromPower::power_rep, intmax_t>::type _Ct;
-
-        return _ToPower(static_cast<typename _ToPower::power_rep>(
-        		(static_cast<_Ct>(__fd.count()) / static_cast<_Ct>(_PeriodPower::den))
-											    * static_cast<_Ct>(_PeriodDuration::num)));
-
-    }
-};
-
-
-template <class _FromPower, class _ToPower, class _PeriodPower, class _PeriodDuration>
-struct __energy_cast<_FromPower, _ToPower, _PeriodPower, _PeriodDuration, true, false, true, true>
-{
-    inline
-        _ToPower operator()(const _FromPower& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToPower::power_rep, typename _FromPower::power_rep, intmax_t>::type _Ct;
-
-        return _ToPower(static_cast<typename _ToPower::power_rep>(
-            static_cast<_Ct>(__fd.count()) / static_cast<_Ct>(_PeriodPower::den)));
-    }
-};
-
-
 template <class _ToPower, class _Vol, class _Period>
 inline
 METRICCONSTEXPR
@@ -197,9 +67,11 @@ typename std::enable_if
     __is_energy<_ToPower>::value,
     _ToPower
 >::type
-energy_cast(const energy<_Vol, _Period>& __fd)
+energy_cast(const energy<_Vol, _Period>& __fd) noexcept
 {
-    return __energy_cast<energy<_Vol, _Period>, _ToPower>()(__fd);
+    // Power and duration periods are folded in the period of a count: a single scaling, without
+    // the intermediate truncation of a cast through the power unit.
+    return __metric_cast<energy<_Vol, _Period>, _ToPower>()(__fd);
 }
 
 
@@ -220,6 +92,8 @@ public:
     typedef typename _Power::period		power_period;
     typedef typename _Time::rep			duration_rep;
     typedef typename _Time::period		duration_period;
+    typedef power_rep		rep;
+    typedef typename std::ratio_multiply<power_period, duration_period>::type period;	// One count, as power times duration.
 
 private:
     power_rep __rep_;
@@ -235,9 +109,9 @@ public:
             typename std::enable_if
             <
                std::is_convertible<_Rep2, power_rep>::value &&
-               (std::is_floating_point<power_rep>::value ||
-               !std::is_floating_point<_Rep2>::value)
-            >::type* = 0)
+               (treat_as_floating_point<power_rep>::value ||
+               !treat_as_floating_point<_Rep2>::value)
+            >::type* = 0) noexcept
                 : __rep_(__r) {}
 
     // conversions
@@ -247,15 +121,15 @@ public:
             typename std::enable_if
             <
                 __no_overflow<typename _Power2::power_period, power_period>::value && (
-                std::is_floating_point<power_rep>::value ||
+                treat_as_floating_point<power_rep>::value ||
                 (__no_overflow<typename _Power2::power_period, power_period>::type::den == 1 &&
-                 !std::is_floating_point<typename _Power2::power_rep>::value))
-            >::type* = 0*/)
+                 !treat_as_floating_point<typename _Power2::power_rep>::value))
+            >::type* = 0*/) noexcept
                 : __rep_(metric::energy_cast<energy>(__d).count()) {}
 
     // observer
 
-    inline METRICCONSTEXPR power_rep count() const {return __rep_;}
+    inline METRICCONSTEXPR power_rep count() const noexcept {return __rep_;}
 
     // arithmetic
 
@@ -319,22 +193,42 @@ template <
 	typename DurationRep,
 	typename DurationPer
 >
-inline Power operator/(
+inline METRICCONSTEXPR Power operator/(
 	const energy<Power, std::chrono::duration<DurationRep, DurationPer>>& e,
-	const std::chrono::duration<DurationRep, DurationPer>& d)
+	const std::chrono::duration<DurationRep, DurationPer>& d) noexcept
 {
 	return Power(e.count() / d.count());
 }
 
+// Power = Energy / Time, with any duration, in the power unit of the energy: the ratio of the
+// two durations is folded at compile time, the count is then e * num / (d * den).
+template <
+	typename Power,
+	typename Time,
+	typename DurationRep,
+	typename DurationPer
+>
+inline METRICCONSTEXPR power<
+	typename std::common_type<typename Power::rep, DurationRep>::type,
+	typename Power::period> operator/(
+	const energy<Power, Time>& e,
+	const std::chrono::duration<DurationRep, DurationPer>& d) noexcept
+{
+	typedef typename std::common_type<typename Power::rep, DurationRep>::type _Cr;
+	typedef typename std::ratio_divide<typename Time::period, DurationPer>::type _Scale;
+	return power<_Cr, typename Power::period>(
+		(static_cast<_Cr>(e.count()) * _Scale::num) / (static_cast<_Cr>(d.count()) * _Scale::den));
+}
+
 // Time = Energy / Power
 template <
 	typename Duration,
 	typename PowerRep,
 	typename PowerPer
 >
-inline Duration operator/(
+inline METRICCONSTEXPR Duration operator/(
 	const energy<power<PowerRep, PowerPer>, Duration>& e,
-	const power<PowerRep, PowerPer>& p)
+	const power<PowerRep, PowerPer>& p) noexcept
 {
 	return Duration(e.count() / p.count());
 }
@@ -346,9 +240,9 @@ template <
 	typename DurationRep,
 	typename DurationPer
 >
-inline energy<power<PowerRep, PowerPer>, std::chrono::duration<DurationRep, DurationPer>> operator*(
+inline METRICCONSTEXPR energy<power<PowerRep, PowerPer>, std::chrono::duration<DurationRep, DurationPer>> operator*(
 	const power<PowerRep, PowerPer>& p,
-	const std::chrono::duration<DurationRep, DurationPer>& d)
+	const std::chrono::duration<DurationRep, DurationPer>& d) noexcept
 {
 	return energy<power<PowerRep, PowerPer>, std::chrono::duration<DurationRep, DurationPer>>(p.count() * d.count());
 }
@@ -59,104 +59,6 @@ namespace std
 
 namespace metric {
 
-template <class _FromFlowrate, class _ToFlowrate,
-    class _PeriodVolume = typename std::ratio_divide<typename _FromFlowrate::volume_period, typename _ToFlowrate::volume_period>::type,
-    class _PeriodDuration = typename std::ratio_divide<typename _FromFlowrate::duration_period, typename _ToFlowrate::duration_period>::type,
-    bool = _PeriodVolume::num == 1,
-    bool = _PeriodVolume::den == 1,
-    bool = _PeriodDuration::num == 1,
-    bool = _PeriodDuration::den == 1>
-    struct __flowrate_cast;
-
-template <class _FromFlowRate, class _ToFlowRate, class _PeriodVolume, class _PeriodDuration>
-struct __flowrate_cast<_FromFlowRate, _ToFlowRate, _PeriodVolume, _PeriodDuration, true, true, true, true>
-{
-    inline  _ToFlowRate operator()(const _FromFlowRate& __fd) const
-    {
-        return _ToFlowRate(static_cast<typename _ToFlowRate::rep>(__fd.count()));
-    }
-};
-
-template <class _FromFlowRate, class _ToFlowRate, class _PeriodVolume, class _PeriodDuration>
-struct __flowrate_cast<_FromFlowRate, _ToFlowRate, _PeriodVolume, _PeriodDuration, true, true, false, true>
-{
-    inline
-        _ToFlowRate operator()(const _FromFlowRate& __fd) const
-    {
-        typedef typename std::common_type<typename _ToFlowRate::volume_rep, typename _FromFlowRate::volume_rep, intmax_t>::type _Ct;
-
-        return _ToFlowRate(static_cast<typename _ToFlowRate::volume_rep>(
-            static_cast<_Ct>(__fd.count()) / static_cast<_Ct>(_PeriodDuration::num)));
-    }
-};
-
-template <class _FromFlowRate, class _ToFlowRate, class _PeriodVolume, class _PeriodDuration>
-struct __flowrate_cast<_FromFlowRate, _ToFlowRate, _PeriodVolume, _PeriodDuration, true, true, true, false>
-{
-    inline
-        _ToFlowRate operator()(const _FromFlowRate& __fd) const
-    {
-        typedef typename std::common_type<typename _ToFlowRate::volume_rep, typename _FromFlowRate::volume_rep, intmax_t>::type _Ct;
-
-        return _ToFlowRate(static_cast<typename _ToFlowRate::volume_rep>(
-            static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodDuration::den)));
-    }
-};
-
-template <class _FromFlowRate, class _ToFlowRate, class _PeriodVolume, class _PeriodDuration>
-struct __flowrate_cast<_FromFlowRate, _ToFlowRate, _PeriodVolume, _PeriodDuration, false, true, false, true>
-{
-    inline
-        _ToFlowRate operator()(const _FromFlowRate& __fd) const
-    {
-        typedef typename std::common_type<typename _ToFlowRate::volume_rep, typename _FromFlowRate::volume_rep, intmax_t>::type _Ct;
-
-        return _ToFlowRate(static_cast<typename _ToFlowRate::volume_rep>(
-        		(static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodVolume::num)) / static_cast<_Ct>(_PeriodDuration::num)));
-    }
-};
-
-template <class _FromFlowRate, class _ToFlowRate, class _PeriodVolume, class _PeriodDuration>
-struct __flowrate_cast<_FromFlowRate, _ToFlowRate, _PeriodVolume, _PeriodDuration, false, true, true, true>
-{
-    inline
-        _ToFlowRate operator()(const _FromFlowRate& __fd) const
-    {
-        typedef typename std::common_type<typename _ToFlowRate::volume_rep, typename _FromFlowRate::volume_rep, intmax_t>::type _Ct;
-
-        return _ToFlowRate(static_cast<typename _ToFlowRate::volume_rep>(
-            static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodVolume::num)));
-    }
-};
-
-template <class _FromFlowRate, class _ToFlowRate, class _PeriodVolume, class _PeriodDuration>
-struct __flowrate_cast<_FromFlowRate, _ToFlowRate, _PeriodVolume, _PeriodDuration, false, false, true, true>
-{
-    inline
-	_ToFlowRate operator()(const _FromFlowRate& __fd) const
-    {
-        typedef typename std::common_type<typename _ToFlowRate::volume_rep, typename _FromFlowRate::volume_rep, intmax_t>::type _Ct;
-
-        return _ToFlowRate(static_cast<typename _ToFlowRate::volume_rep>(
-            static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodVolume::num)
-										   / static_cast<_Ct>(_PeriodVolume::den) ));
-    }
-};
-
-template <class _FromFlowrate, class _ToFlowrate, class _PeriodFlowrate, class _PeriodDuration>
-struct __flowrate_cast<_FromFlowrate, _ToFlowrate, _PeriodFlowrate, _PeriodDuration, false, true, true, false>
-{
-    inline
-        _ToFlowrate operator()(const _FromFlowrate& __fd) const
-    {
-        typedef typename std::common_type<typename _ToFlowrate::flowrate_rep, typename _FromFlowrate::flowrate_rep, intmax_t>::type _Ct;
-
-        return _ToFlowrate(static_cast<typename _ToFlowrate::flowrate_rep>(
-        		(static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodFlowrate::num)) * static_cast<_Ct>(_PeriodDuration::den)));
-    }
-};
-
-
 template <class _ToFlowRate, class _Vol, class _Period>
 inline
 METRICCONSTEXPR
@@ -165,9 +67,9 @@ typename std::enable_if
     __is_flowrate<_ToFlowRate>::value,
     _ToFlowRate
 >::type
-flowrate_cast(const flowrate<_Vol, _Period>& __fd)
+flowrate_cast(const flowrate<_Vol, _Period>& __fd) noexcept
 {
-    return __flowrate_cast<flowrate<_Vol, _Period>, _ToFlowRate>()(__fd);
+    return __metric_cast<flowrate<_Vol, _Period>, _ToFlowRate>()(__fd);
 }
 
 
@@ -188,6 +90,8 @@ public:
     typedef typename _Volume::period	volume_period;
     typedef typename _Time::rep			duration_rep;
     typedef typename _Time::period		duration_period;
+    typedef volume_rep		rep;
+    typedef typename std::ratio_divide<volume_period, duration_period>::type period;	// One count, as volume per duration.
 
 private:
     volume_rep __rep_;
@@ -203,9 +107,9 @@ public:
             typename std::enable_if
             <
                std::is_convertible<_Rep2, volume_rep>::value &&
-               (std::is_floating_point<volume_rep>::value ||
-               !std::is_floating_point<_Rep2>::value)
-            >::type* = 0)
+               (treat_as_floating_point<volume_rep>::value ||
+               !treat_as_floating_point<_Rep2>::value)
+            >::type* = 0) noexcept
                 : __rep_(__r) {}
 
     // conversions
@@ -215,15 +119,15 @@ public:
             typename std::enable_if
             <
                 __no_overflow<typename _Volume2::volume_period, volume_period>::value && (
-                std::is_floating_point<volume_rep>::value ||
+                treat_as_floating_point<volume_rep>::value ||
                 (__no_overflow<typename _Volume2::volume_period, volume_period>::type::den == 1 &&
-                 !std::is_floating_point<typename _Volume2::volume_rep>::value))
-            >::type* = 0*/)
+                 !treat_as_floating_point<typename _Volume2::volume_rep>::value))
+            >::type* = 0*/) noexcept
                 : __rep_(metric::flowrate_cast<flowrate>(__d).count()) {}
 
     // observer
 
-    inline METRICCONSTEXPR volume_rep count() const {return __rep_;}
+    inline METRICCONSTEXPR volume_rep count() const noexcept {return __rep_;}
 
     // arithmetic
 
@@ -285,22 +189,41 @@ template <
 	typename DurationRep,
 	typename DurationPer
 >
-inline Volume operator*(
+inline METRICCONSTEXPR Volume operator*(
 	const flowrate<Volume, std::chrono::duration<DurationRep, DurationPer>>& s,
-	const std::chrono::duration<DurationRep, DurationPer>& d)
+	const std::chrono::duration<DurationRep, DurationPer>& d) noexcept
 {
 	return Volume(s.count() * d.count());
 }
 
+// Volume = Flowrate * Time, with any duration: the plain product, in the volume unit of
+// flowrate period * duration period.
+template <
+	typename Volume,
+	typename Time,
+	typename DurationRep,
+	typename DurationPer
+>
+inline METRICCONSTEXPR volume<
+	typename std::common_type<typename Volume::rep, DurationRep>::type,
+	typename std::ratio_multiply<typename flowrate<Volume, Time>::period, DurationPer>::type> operator*(
+	const flowrate<Volume, Time>& s,
+	const std::chrono::duration<DurationRep, DurationPer>& d) noexcept
+{
+	typedef typename std::common_type<typename Volume::rep, DurationRep>::type _Cr;
+	return volume<_Cr, typename std::ratio_multiply<typename flowrate<Volume, Time>::period, DurationPer>::type>(
+		static_cast<_Cr>(s.count()) * static_cast<_Cr>(d.count()));
+}
+
 // Time = Volume / Flowrate
 template <
 	typename Duration,
 	typename VolumeRep,
 	typename VolumePer
 >
-inline Duration operator/(
+inline METRICCONSTEXPR Duration operator/(
 	const volume<VolumeRep, VolumePer>& v,
-	const flowrate<volume<VolumeRep, VolumePer>, Duration>& f)
+	const flowrate<volume<VolumeRep, VolumePer>, Duration>& f) noexcept
 {
 	return Duration(v.count() / f.count());
 }
@@ -312,9 +235,9 @@ template <
 	typename DurationRep,
 	typename DurationPer
 >
-inline flowrate<volume<VolumeRep, VolumePer>, std::chrono::duration<DurationRep, DurationPer>> operator/(
+inline METRICCONSTEXPR flowrate<volume<VolumeRep, VolumePer>, std::chrono::duration<DurationRep, DurationPer>> operator/(
 	const volume<VolumeRep, VolumePer>& v,
-	const std::chrono::duration<DurationRep, DurationPer>& d)
+	const std::chrono::duration<DurationRep, DurationPer>& d) noexcept
 {
 	return flowrate<volume<VolumeRep, VolumePer>, std::chrono::duration<DurationRep, DurationPer>>(v.count() / d.count());
 }
@@ -60,9 +60,9 @@ public:
             typename std::enable_if
             <
                std::is_convertible<_Rep2, rep>::value &&
-               (std::is_floating_point<rep>::value ||
-               !std::is_floating_point<_Rep2>::value)
-            >::type* = 0)
+               (treat_as_floating_point<rep>::value ||
+               !treat_as_floating_point<_Rep2>::value)
+            >::type* = 0) noexcept
                 : __rep_(__r) {}
 
     // conversions
@@ -72,15 +72,15 @@ public:
             typename std::enable_if
             <
                 __no_overflow<_Period2, period>::value && (
-                std::is_floating_point<rep>::value ||
+                treat_as_floating_point<rep>::value ||
                 (__no_overflow<_Period2, period>::type::den == 1 &&
-                 !std::is_floating_point<_Rep2>::value))
-            >::type* = 0)
+                 !treat_as_floating_point<_Rep2>::value))
+            >::type* = 0) noexcept
                 : __rep_(metric::force_cast<force>(__d).count()) {}
 
     // observer
 
-    inline METRICCONSTEXPR rep count() const {return __rep_;}
+    inline METRICCONSTEXPR rep count() const noexcept {return __rep_;}
 
     // arithmetic
 
@@ -0,0 +1,411 @@
+// -*- C++ -*-
+//
+//===---------------------------- algorithm -------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_ALGORITHM_HPP
+#define METRICS_ALGORITHM_HPP
+
+#include "metric_config.hpp"
+#include "metric_wideint.hpp"
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace metric {
+
+// Same metric, other representation.
+template <class _Metric, class _Rep2>
+struct __rebind_rep;
+
+template <template <class, class> class _Master, class _Rep, class _Period, class _Rep2>
+struct __rebind_rep<_Master<_Rep, _Period>, _Rep2>
+{
+    typedef _Master<_Rep2, _Period> type;
+};
+
+// Compound metrics (speed, energy, flowrate): the representation is the one of the first component.
+template <template <class, class> class _Compound, template <class, class> class _Master,
+          class _Rep, class _Period, class _Second, class _Rep2>
+struct __rebind_rep<_Compound<_Master<_Rep, _Period>, _Second>, _Rep2>
+{
+    typedef _Compound<_Master<_Rep2, _Period>, _Second> type;
+};
+
+
+// Accumulator of a sum: 64-bit integers are summed exactly in a wider integer,
+// narrower integers in long long, float in double.
+template <class _Rep,
+          bool = std::is_integral<_Rep>::value,
+          bool = treat_as_floating_point<_Rep>::value>
+struct __sum_rep
+{
+    typedef _Rep type;
+};
+
+template <class _Rep>
+struct __sum_rep<_Rep, true, false>
+{
+#ifdef METRIC_HAS_INT128
+    typedef typename std::conditional<(sizeof(_Rep) < sizeof(long long)), long long, int128>::type type;
+#else
+    typedef typename std::conditional<(sizeof(_Rep) < sizeof(long long)), long long, int256>::type type;
+#endif
+};
+
+template <class _Rep>
+struct __sum_rep<_Rep, false, true>
+{
+    typedef typename std::common_type<_Rep, double>::type type;
+};
+
+template <class _Rep>
+struct __mean_rep
+{
+    typedef typename std::common_type<typename __sum_rep<_Rep>::type, double>::type type;
+};
+
+
+// Iterators over contiguous storage: pointers, std::vector iterators, and any
+// std::contiguous_iterator when the library has concepts.
+template <class _InputIterator,
+          class _Tp = typename std::iterator_traits<_InputIterator>::value_type>
+struct __contiguous_iterator
+    : std::integral_constant<bool,
+        std::is_pointer<_InputIterator>::value ||
+        std::is_same<_InputIterator, typename std::vector<_Tp>::iterator>::value ||
+        std::is_same<_InputIterator, typename std::vector<_Tp>::const_iterator>::value
+#if defined(__cpp_lib_concepts)
+        || std::contiguous_iterator<_InputIterator>
+#endif
+        > {};
+
+// A metric is laid out as its representation: contiguous ranges are read as arrays of counts.
+template <class _InputIterator,
+          class _Metric = typename std::iterator_traits<_InputIterator>::value_type>
+struct __contiguous_counts
+    : std::integral_constant<bool,
+        __contiguous_iterator<_InputIterator>::value &&
+        std::is_standard_layout<_Metric>::value &&
+        sizeof(_Metric) == sizeof(typename _Metric::rep) &&
+        std::is_arithmetic<typename _Metric::rep>::value> {};
+
+template <class _Metric>
+inline const typename _Metric::rep* __counts(const _Metric* __p)
+{
+    return reinterpret_cast<const typename _Metric::rep*>(__p);
+}
+
+// Counts under a contiguous iterator; the iterator must be dereferenceable.
+template <class _InputIterator>
+inline const typename std::iterator_traits<_InputIterator>::value_type::rep* __counts(_InputIterator __i)
+{
+    return reinterpret_cast<const typename std::iterator_traits<_InputIterator>::value_type::rep*>(
+        std::addressof(*__i));
+}
+
+
+// Sum kernels over counts.
+
+template <class _Rep, class _Acc,
+          bool = std::is_integral<_Rep>::value && sizeof(_Rep) == sizeof(long long)>
+struct __sum_counts
+{
+    static _Acc __apply(const _Rep* __p, std::size_t __n)
+    {
+        // Independent partial sums: the loop is vectorized for integers, and pipelined for floating point.
+        _Acc __s0 = _Acc(0), __s1 = _Acc(0), __s2 = _Acc(0), __s3 = _Acc(0);
+        std::size_t __i = 0;
+        for (; __i + 4 <= __n; __i += 4)
+        {
+            __s0 += static_cast<_Acc>(__p[__i]);
+            __s1 += static_cast<_Acc>(__p[__i + 1]);
+            __s2 += static_cast<_Acc>(__p[__i + 2]);
+            __s3 += static_cast<_Acc>(__p[__i + 3]);
+        }
+        for (; __i < __n; ++__i)
+            __s0 += static_cast<_Acc>(__p[__i]);
+        return (__s0 + __s1) + (__s2 + __s3);
+    }
+};
+
+// 64-bit counts: each value is split into its low and high 32 bits, both summed in 64 bits
+// without overflow for up to 2^31 values, and negative values are counted. The exact sum is
+// lo + hi * 2^32 - negatives * 2^64 (the last term only for signed counts).
+template <class _Rep, class _Acc>
+struct __sum_counts<_Rep, _Acc, true>
+{
+    static const std::size_t __block = std::size_t(1) << 31;
+
+    static _Acc __apply(const _Rep* __p, std::size_t __n)
+    {
+        _Acc __total = _Acc(0);
+        while (__n != 0)
+        {
+            const std::size_t __m = __n < __block ? __n : __block;
+            unsigned long long __lo = 0, __hi = 0, __neg = 0;
+            std::size_t __i = 0;
+#if defined(__AVX512F__)
+            const __m512i __mask = _mm512_set1_epi64(0xffffffffLL);
+            __m512i __vlo = _mm512_setzero_si512(), __vhi = _mm512_setzero_si512();
+            for (; __i + 8 <= __m; __i += 8)
+            {
+                const __m512i __v = _mm512_loadu_si512(reinterpret_cast<const void*>(__p + __i));
+                __vlo = _mm512_add_epi64(__vlo, _mm512_and_si512(__v, __mask));
+                __vhi = _mm512_add_epi64(__vhi, _mm512_srli_epi64(__v, 32));
+                if (std::is_signed<_Rep>::value)
+                    __neg += static_cast<unsigned>(__builtin_popcount(_mm512_cmplt_epi64_mask(__v, _mm512_setzero_si512())));
+            }
+            __lo += static_cast<unsigned long long>(_mm512_reduce_add_epi64(__vlo));
+            __hi += static_cast<unsigned long long>(_mm512_reduce_add_epi64(__vhi));
+#elif defined(__AVX2__)
+            const __m256i __mask = _mm256_set1_epi64x(0xffffffffLL);
+            __m256i __vlo = _mm256_setzero_si256(), __vhi = _mm256_setzero_si256(), __vneg = _mm256_setzero_si256();
+            for (; __i + 4 <= __m; __i += 4)
+            {
+                const __m256i __v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(__p + __i));
+                __vlo = _mm256_add_epi64(__vlo, _mm256_and_si256(__v, __mask));
+                __vhi = _mm256_add_epi64(__vhi, _mm256_srli_epi64(__v, 32));
+                if (std::is_signed<_Rep>::value)
+                    __vneg = _mm256_sub_epi64(__vneg, _mm256_cmpgt_epi64(_mm256_setzero_si256(), __v));
+            }
+            alignas(32) unsigned long long __l[4], __h[4], __g[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(__l), __vlo);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(__h), __vhi);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(__g), __vneg);
+            __lo += (__l[0] + __l[1]) + (__l[2] + __l[3]);
+            __hi += (__h[0] + __h[1]) + (__h[2] + __h[3]);
+            __neg += (__g[0] + __g[1]) + (__g[2] + __g[3]);
+#endif
+            for (; __i < __m; ++__i)
+            {
+                const unsigned long long __v = static_cast<unsigned long long>(__p[__i]);
+                __lo += __v & 0xffffffffULL;
+                __hi += __v >> 32;
+                __neg += std::is_signed<_Rep>::value && static_cast<long long>(__v) < 0;
+            }
+            __total += _Acc(__lo) + (_Acc(__hi) << 32) - (_Acc(__neg) << 64);
+            __p += __m;
+            __n -= __m;
+        }
+        return __total;
+    }
+};
+
+template <class _Rep, class _Acc>
+const std::size_t __sum_counts<_Rep, _Acc, true>::__block;
+
+
+template <class _InputIterator, bool = __contiguous_counts<_InputIterator>::value>
+struct __sum_range
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _Metric;
+    typedef typename __sum_rep<typename _Metric::rep>::type _Acc;
+
+    static _Acc __apply(_InputIterator __first, _InputIterator __last)
+    {
+        _Acc __s = _Acc(0);
+        for (; __first != __last; ++__first)
+            __s += static_cast<_Acc>(__first->count());
+        return __s;
+    }
+};
+
+template <class _InputIterator>
+struct __sum_range<_InputIterator, true>
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _Metric;
+    typedef typename __sum_rep<typename _Metric::rep>::type _Acc;
+
+    static _Acc __apply(_InputIterator __first, _InputIterator __last)
+    {
+        if (__first == __last)
+            return _Acc(0);
+        return __sum_counts<typename _Metric::rep, _Acc>::__apply(__counts(__first), static_cast<std::size_t>(__last - __first));
+    }
+};
+
+
+// Extremes kernels over counts: index of the first smallest (or largest) count.
+
+template <bool _Greater, class _Rep>
+inline bool __better(const _Rep& __a, const _Rep& __b)
+{
+    return _Greater ? __b < __a : __a < __b;
+}
+
+template <bool _Greater, class _Rep,
+          bool = std::is_integral<_Rep>::value && sizeof(_Rep) == sizeof(long long)>
+struct __extreme_counts
+{
+    static std::size_t __apply(const _Rep* __p, std::size_t __n)
+    {
+        std::size_t __best = 0;
+        for (std::size_t __i = 1; __i < __n; ++__i)
+            if (__better<_Greater>(__p[__i], __p[__best]))
+                __best = __i;
+        return __best;
+    }
+};
+
+// 64-bit counts: the extreme value is found with vector min / max, then its first position.
+template <bool _Greater, class _Rep>
+struct __extreme_counts<_Greater, _Rep, true>
+{
+    static std::size_t __apply(const _Rep* __p, std::size_t __n)
+    {
+        _Rep __e = __p[0];
+        std::size_t __i = 0;
+#if defined(__AVX512F__)
+        if (__n >= 8)
+        {
+            __m512i __v = _mm512_loadu_si512(reinterpret_cast<const void*>(__p));
+            for (__i = 8; __i + 8 <= __n; __i += 8)
+            {
+                const __m512i __w = _mm512_loadu_si512(reinterpret_cast<const void*>(__p + __i));
+                __v = std::is_signed<_Rep>::value
+                    ? (_Greater ? _mm512_max_epi64(__v, __w) : _mm512_min_epi64(__v, __w))
+                    : (_Greater ? _mm512_max_epu64(__v, __w) : _mm512_min_epu64(__v, __w));
+            }
+            __e = static_cast<_Rep>(std::is_signed<_Rep>::value
+                ? (_Greater ? _mm512_reduce_max_epi64(__v) : _mm512_reduce_min_epi64(__v))
+                : (_Greater ? static_cast<long long>(_mm512_reduce_max_epu64(__v))
+                            : static_cast<long long>(_mm512_reduce_min_epu64(__v))));
+        }
+#elif defined(__AVX2__)
+        if (std::is_signed<_Rep>::value && __n >= 4)
+        {
+            __m256i __v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(__p));
+            for (__i = 4; __i + 4 <= __n; __i += 4)
+            {
+                const __m256i __w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(__p + __i));
+                const __m256i __gt = _mm256_cmpgt_epi64(__v, __w);
+                __v = _Greater ? _mm256_blendv_epi8(__w, __v, __gt) : _mm256_blendv_epi8(__v, __w, __gt);
+            }
+            alignas(32) long long __l[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(__l), __v);
+            __e = static_cast<_Rep>(__l[0]);
+            for (int __k = 1; __k < 4; ++__k)
+                if (__better<_Greater>(static_cast<_Rep>(__l[__k]), __e))
+                    __e = static_cast<_Rep>(__l[__k]);
+        }
+#endif
+        for (; __i < __n; ++__i)
+            if (__better<_Greater>(__p[__i], __e))
+                __e = __p[__i];
+        std::size_t __pos = 0;
+        while (__p[__pos] != __e)
+            ++__pos;
+        return __pos;
+    }
+};
+
+
+template <bool _Greater, class _InputIterator, bool = __contiguous_counts<_InputIterator>::value>
+struct __extreme_range
+{
+    static _InputIterator __apply(_InputIterator __first, _InputIterator __last)
+    {
+        _InputIterator __best = __first;
+        if (__first != __last)
+            while (++__first != __last)
+                if (__better<_Greater>(__first->count(), __best->count()))
+                    __best = __first;
+        return __best;
+    }
+};
+
+template <bool _Greater, class _InputIterator>
+struct __extreme_range<_Greater, _InputIterator, true>
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _Metric;
+
+    static _InputIterator __apply(_InputIterator __first, _InputIterator __last)
+    {
+        if (__first == __last)
+            return __last;
+        return __first + __extreme_counts<_Greater, typename _Metric::rep>::__apply(
+                             __counts(__first), static_cast<std::size_t>(__last - __first));
+    }
+};
+
+
+// Sum of a range, in the metric of the elements with a wide representation:
+// 64-bit integer counts are summed exactly in 128 bits.
+template <class _InputIterator>
+inline
+typename __rebind_rep<typename std::iterator_traits<_InputIterator>::value_type,
+                      typename __sum_rep<typename std::iterator_traits<_InputIterator>::value_type::rep>::type>::type
+sum(_InputIterator __first, _InputIterator __last)
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _Metric;
+    typedef typename __rebind_rep<_Metric, typename __sum_rep<typename _Metric::rep>::type>::type _Rt;
+    return _Rt(__sum_range<_InputIterator>::__apply(__first, __last));
+}
+
+// Arithmetic mean of a non empty range, with a floating point representation.
+template <class _InputIterator>
+inline
+typename __rebind_rep<typename std::iterator_traits<_InputIterator>::value_type,
+                      typename __mean_rep<typename std::iterator_traits<_InputIterator>::value_type::rep>::type>::type
+mean(_InputIterator __first, _InputIterator __last)
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _Metric;
+    typedef typename __mean_rep<typename _Metric::rep>::type _Mr;
+    typedef typename __rebind_rep<_Metric, _Mr>::type _Rt;
+    return _Rt(static_cast<_Mr>(__sum_range<_InputIterator>::__apply(__first, __last))
+               / static_cast<_Mr>(std::distance(__first, __last)));
+}
+
+// Position of the first smallest element, __last for an empty range.
+template <class _InputIterator>
+inline
+_InputIterator
+argmin(_InputIterator __first, _InputIterator __last)
+{
+    return __extreme_range<false, _InputIterator>::__apply(__first, __last);
+}
+
+// Position of the first largest element, __last for an empty range.
+template <class _InputIterator>
+inline
+_InputIterator
+argmax(_InputIterator __first, _InputIterator __last)
+{
+    return __extreme_range<true, _InputIterator>::__apply(__first, __last);
+}
+
+// Smallest element of a non empty range.
+template <class _InputIterator>
+inline
+typename std::iterator_traits<_InputIterator>::value_type
+minimum(_InputIterator __first, _InputIterator __last)
+{
+    return *metric::argmin(__first, __last);
+}
+
+// Largest element of a non empty range.
+template <class _InputIterator>
+inline
+typename std::iterator_traits<_InputIterator>::value_type
+maximum(_InputIterator __first, _InputIterator __last)
+{
+    return *metric::argmax(__first, __last);
+}
+
+} // namespace metric
+
+#endif // METRICS_ALGORITHM_HPP
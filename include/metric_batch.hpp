@@ -0,0 +1,229 @@
+// -*- C++ -*-
+//
+//===---------------------------- batch -----------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_BATCH_HPP
+#define METRICS_BATCH_HPP
+
+#include "metric_config.hpp"
+#include "metric_rounding.hpp"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace metric {
+
+// Batch kernels work on iterator ranges.  The conversion ratio is a compile time constant,
+// so on contiguous ranges the loops are plain multiply / divide and get vectorized.
+
+template <class _ToMetric, class _InputIterator, class _OutputIterator>
+inline
+_OutputIterator
+batch_cast(_InputIterator __first, _InputIterator __last, _OutputIterator __out)
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _FromMetric;
+    const __metric_cast<_FromMetric, _ToMetric> __cast = __metric_cast<_FromMetric, _ToMetric>();
+    for (; __first != __last; ++__first, (void) ++__out)
+        *__out = __cast(*__first);
+    return __out;
+}
+
+template <class _ToMetric, __rounding _Mode, class _InputIterator, class _OutputIterator>
+inline
+_OutputIterator
+__batch_round(_InputIterator __first, _InputIterator __last, _OutputIterator __out)
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _FromMetric;
+    const __metric_round<_FromMetric, _ToMetric, _Mode> __round = __metric_round<_FromMetric, _ToMetric, _Mode>();
+    for (; __first != __last; ++__first, (void) ++__out)
+        *__out = __round(*__first);
+    return __out;
+}
+
+template <class _ToMetric, class _InputIterator, class _OutputIterator>
+inline
+_OutputIterator
+batch_floor_cast(_InputIterator __first, _InputIterator __last, _OutputIterator __out)
+{
+    return __batch_round<_ToMetric, __round_floor>(__first, __last, __out);
+}
+
+template <class _ToMetric, class _InputIterator, class _OutputIterator>
+inline
+_OutputIterator
+batch_ceil_cast(_InputIterator __first, _InputIterator __last, _OutputIterator __out)
+{
+    return __batch_round<_ToMetric, __round_ceil>(__first, __last, __out);
+}
+
+template <class _ToMetric, class _InputIterator, class _OutputIterator>
+inline
+_OutputIterator
+batch_round_cast(_InputIterator __first, _InputIterator __last, _OutputIterator __out)
+{
+    return __batch_round<_ToMetric, __round_half_even>(__first, __last, __out);
+}
+
+// Element-wise products and quotients of two ranges (U = R * I, I = U / R, P = U * I, ...).
+// The operators fold the scale of the periods into a single compile time constant, the result
+// is then cast to _ToMetric.
+
+template <class _ToMetric, class _InputIterator1, class _InputIterator2, class _OutputIterator>
+inline
+_OutputIterator
+batch_multiply(_InputIterator1 __first1, _InputIterator1 __last1, _InputIterator2 __first2, _OutputIterator __out)
+{
+    typedef decltype(*__first1 * *__first2) _Product;
+    const __metric_cast<_Product, _ToMetric> __cast = __metric_cast<_Product, _ToMetric>();
+    for (; __first1 != __last1; ++__first1, (void) ++__first2, (void) ++__out)
+        *__out = __cast(*__first1 * *__first2);
+    return __out;
+}
+
+template <class _ToMetric, class _InputIterator1, class _InputIterator2, class _OutputIterator>
+inline
+_OutputIterator
+batch_divide(_InputIterator1 __first1, _InputIterator1 __last1, _InputIterator2 __first2, _OutputIterator __out)
+{
+    typedef decltype(*__first1 / *__first2) _Quotient;
+    const __metric_cast<_Quotient, _ToMetric> __cast = __metric_cast<_Quotient, _ToMetric>();
+    for (; __first1 != __last1; ++__first1, (void) ++__first2, (void) ++__out)
+        *__out = __cast(*__first1 / *__first2);
+    return __out;
+}
+
+// One metric combined with every element of a range, e.g. the volume delivered by a flow rate
+// over each interval of a range of durations.
+
+template <class _ToMetric, class _Metric, class _InputIterator, class _OutputIterator>
+inline
+_OutputIterator
+batch_multiply_each(const _Metric& __m, _InputIterator __first, _InputIterator __last, _OutputIterator __out)
+{
+    typedef decltype(__m * *__first) _Product;
+    const __metric_cast<_Product, _ToMetric> __cast = __metric_cast<_Product, _ToMetric>();
+    for (; __first != __last; ++__first, (void) ++__out)
+        *__out = __cast(__m * *__first);
+    return __out;
+}
+
+template <class _ToMetric, class _InputIterator, class _Metric, class _OutputIterator>
+inline
+_OutputIterator
+batch_divide_each(_InputIterator __first, _InputIterator __last, const _Metric& __m, _OutputIterator __out)
+{
+    typedef decltype(*__first / __m) _Quotient;
+    const __metric_cast<_Quotient, _ToMetric> __cast = __metric_cast<_Quotient, _ToMetric>();
+    for (; __first != __last; ++__first, (void) ++__out)
+        *__out = __cast(*__first / __m);
+    return __out;
+}
+
+// Element-wise comparisons of a range against a threshold, written as a bool mask.
+// For integer counts the threshold is converted once into the exact bound on the element
+// count (floor / ceil of threshold * P2 / P1), the loop then only compares raw counts.
+
+enum __comparison
+{
+    __compare_less,
+    __compare_less_equal,
+    __compare_greater,
+    __compare_greater_equal
+};
+
+template <__comparison _Compare, class _Metric, class _Threshold,
+          bool = __cross_multipliable<typename _Metric::rep>::value &&
+                 __cross_multipliable<typename _Threshold::rep>::value>
+struct __batch_compare
+{
+    template <class _InputIterator, class _OutputIterator>
+    _OutputIterator operator()(_InputIterator __first, _InputIterator __last, const _Threshold& __t, _OutputIterator __out) const
+    {
+        for (; __first != __last; ++__first, (void) ++__out)
+            *__out = _Compare == __compare_less          ? *__first <  __t
+                   : _Compare == __compare_less_equal    ? *__first <= __t
+                   : _Compare == __compare_greater       ? *__first >  __t
+                   :                                       *__first >= __t;
+        return __out;
+    }
+};
+
+#if defined(__SIZEOF_INT128__)
+template <__comparison _Compare, class _Metric, class _Threshold>
+struct __batch_compare<_Compare, _Metric, _Threshold, true>
+{
+    typedef typename _Metric::rep _Rep;
+    typedef typename std::ratio_divide<typename _Threshold::period, typename _Metric::period>::type _Period;
+
+    template <class _InputIterator, class _OutputIterator>
+    _OutputIterator operator()(_InputIterator __first, _InputIterator __last, const _Threshold& __t, _OutputIterator __out) const
+    {
+        // x < q  <=>  !(x > ceil(q) - 1),  x <= q  <=>  !(x > floor(q)),
+        // x > q  <=>  x > floor(q),        x >= q  <=>  x > ceil(q) - 1.
+        const __cross_product_type __n = static_cast<__cross_product_type>(__t.count()) * _Period::num;
+        const __cross_product_type __q = __n / _Period::den;
+        const __cross_product_type __r = __n % _Period::den;
+        const bool __floor = _Compare == __compare_less_equal || _Compare == __compare_greater;
+        const bool __greater = _Compare == __compare_greater || _Compare == __compare_greater_equal;
+        const __cross_product_type __bound = __floor ? (__r < 0 ? __q - 1 : __q)
+                                                     : (__r > 0 ? __q : __q - 1);
+
+        if (__bound < static_cast<__cross_product_type>(std::numeric_limits<_Rep>::min()))
+            return std::fill_n(__out, std::distance(__first, __last), __greater);
+        if (__bound >= static_cast<__cross_product_type>(std::numeric_limits<_Rep>::max()))
+            return std::fill_n(__out, std::distance(__first, __last), !__greater);
+
+        const _Rep __b = static_cast<_Rep>(__bound);
+        for (; __first != __last; ++__first, (void) ++__out)
+            *__out = (__first->count() > __b) == __greater;
+        return __out;
+    }
+};
+#endif
+
+template <class _InputIterator, class _Threshold, class _OutputIterator>
+inline
+_OutputIterator
+batch_less(_InputIterator __first, _InputIterator __last, const _Threshold& __t, _OutputIterator __out)
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _Metric;
+    return __batch_compare<__compare_less, _Metric, _Threshold>()(__first, __last, __t, __out);
+}
+
+template <class _InputIterator, class _Threshold, class _OutputIterator>
+inline
+_OutputIterator
+batch_less_equal(_InputIterator __first, _InputIterator __last, const _Threshold& __t, _OutputIterator __out)
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _Metric;
+    return __batch_compare<__compare_less_equal, _Metric, _Threshold>()(__first, __last, __t, __out);
+}
+
+template <class _InputIterator, class _Threshold, class _OutputIterator>
+inline
+_OutputIterator
+batch_greater(_InputIterator __first, _InputIterator __last, const _Threshold& __t, _OutputIterator __out)
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _Metric;
+    return __batch_compare<__compare_greater, _Metric, _Threshold>()(__first, __last, __t, __out);
+}
+
+template <class _InputIterator, class _Threshold, class _OutputIterator>
+inline
+_OutputIterator
+batch_greater_equal(_InputIterator __first, _InputIterator __last, const _Threshold& __t, _OutputIterator __out)
+{
+    typedef typename std::iterator_traits<_InputIterator>::value_type _Metric;
+    return __batch_compare<__compare_greater_equal, _Metric, _Threshold>()(__first, __last, __t, __out);
+}
+
+} // namespace metric
+
+#endif // METRICS_BATCH_HPP
@@ -0,0 +1,322 @@
+// -*- C++ -*-
+//
+//===---------------------------- compact ---------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_COMPACT_HPP
+#define METRICS_COMPACT_HPP
+
+#include "metric_config.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace metric {
+
+inline unsigned __bit_width(unsigned long long __x)
+{
+    unsigned __w = 0;
+    for (; __x != 0; __x >>= 1)
+        ++__w;
+    return __w;
+}
+
+inline unsigned long long __lane_mask(unsigned __width)
+{
+    return __width >= 64 ? ~0ULL : (1ULL << __width) - 1;
+}
+
+// Block decoding: lane k of a block holds bits [k * width, (k + 1) * width) of its words,
+// and decodes to base + (lane << shift), modulo 2^64.
+inline unsigned long long __read_lane(const unsigned long long* __w, unsigned __width, std::size_t __k)
+{
+    if (__width == 0)
+        return 0;
+    const std::size_t __pos = __k * __width;
+    const unsigned __sh = static_cast<unsigned>(__pos & 63);
+    unsigned long long __v = __w[__pos >> 6] >> __sh;
+    if (__sh + __width > 64)
+        __v |= __w[(__pos >> 6) + 1] << (64 - __sh);
+    return __v & __lane_mask(__width);
+}
+
+template <class _Rep>
+inline void __unpack_lanes(const unsigned long long* __w, unsigned long long __base, unsigned __width,
+                           unsigned __shift, std::size_t __k, std::size_t __n, _Rep* __out)
+{
+    for (; __k < __n; ++__k)
+        __out[__k] = static_cast<_Rep>(__base + (__read_lane(__w, __width, __k) << __shift));
+}
+
+template <class _Rep, bool = std::is_integral<_Rep>::value && sizeof(_Rep) == sizeof(long long)>
+struct __unpack_block
+{
+    static void __apply(const unsigned long long* __w, unsigned long long __base, unsigned __width,
+                        unsigned __shift, std::size_t __n, _Rep* __out)
+    {
+        __unpack_lanes(__w, __base, __width, __shift, 0, __n, __out);
+    }
+};
+
+#if defined(__AVX2__)
+// 64-bit counts: four lanes at a time, each gathered from the two words it may straddle.
+// The word following a block of lanes is readable: the next block or the spare word.  A
+// constant block owns no word at all and is decoded without reading any.
+template <class _Rep>
+struct __unpack_block<_Rep, true>
+{
+    static void __apply(const unsigned long long* __w, unsigned long long __base, unsigned __width,
+                        unsigned __shift, std::size_t __n, _Rep* __out)
+    {
+        if (__width == 0)
+        {
+            __unpack_lanes(__w, __base, __width, __shift, 0, __n, __out);
+            return;
+        }
+        const long long* __words = reinterpret_cast<const long long*>(__w);
+        const __m256i __mask = _mm256_set1_epi64x(static_cast<long long>(__lane_mask(__width)));
+        const __m256i __b = _mm256_set1_epi64x(static_cast<long long>(__base));
+        const __m256i __step = _mm256_set1_epi64x(4 * static_cast<long long>(__width));
+        const __m256i __sixtyfour = _mm256_set1_epi64x(64);
+        const __m128i __exp = _mm_cvtsi32_si128(static_cast<int>(__shift));
+        __m256i __pos = _mm256_set_epi64x(3 * __width, 2 * __width, __width, 0);
+        std::size_t __k = 0;
+        for (; __k + 4 <= __n; __k += 4)
+        {
+            const __m256i __idx = _mm256_srli_epi64(__pos, 6);
+            const __m256i __sh = _mm256_and_si256(__pos, _mm256_set1_epi64x(63));
+            const __m256i __lo = _mm256_i64gather_epi64(__words, __idx, 8);
+            const __m256i __hi = _mm256_i64gather_epi64(__words + 1, __idx, 8);
+            // A shift by 64 gives 0: the high word only counts when the lane straddles.
+            __m256i __v = _mm256_or_si256(_mm256_srlv_epi64(__lo, __sh),
+                                          _mm256_sllv_epi64(__hi, _mm256_sub_epi64(__sixtyfour, __sh)));
+            __v = _mm256_add_epi64(_mm256_sll_epi64(_mm256_and_si256(__v, __mask), __exp), __b);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(__out + __k), __v);
+            __pos = _mm256_add_epi64(__pos, __step);
+        }
+        __unpack_lanes(__w, __base, __width, __shift, __k, __n, __out);
+    }
+};
+#endif
+
+// Minimum and maximum of the values of a block.
+template <class _Rep, bool = std::is_integral<_Rep>::value && sizeof(_Rep) == sizeof(long long)>
+struct __block_range
+{
+    static void __apply(const _Rep* __v, std::size_t __n, _Rep& __min, _Rep& __max)
+    {
+        __min = __max = __v[0];
+        for (std::size_t __i = 1; __i < __n; ++__i)
+        {
+            __min = __v[__i] < __min ? __v[__i] : __min;
+            __max = __v[__i] > __max ? __v[__i] : __max;
+        }
+    }
+};
+
+#if defined(__AVX2__)
+// 64-bit counts: four lanes at a time with compare and blend, AVX2 having no 64-bit min or
+// max.  Unsigned counts are compared with their top bit flipped.
+template <class _Rep>
+struct __block_range<_Rep, true>
+{
+    static void __apply(const _Rep* __v, std::size_t __n, _Rep& __min, _Rep& __max)
+    {
+        if (__n < 4)
+        {
+            __block_range<_Rep, false>::__apply(__v, __n, __min, __max);
+            return;
+        }
+        const __m256i __bias = _mm256_set1_epi64x(std::is_signed<_Rep>::value ? 0 : static_cast<long long>(1ULL << 63));
+        __m256i __lo = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(__v)), __bias);
+        __m256i __hi = __lo;
+        std::size_t __i = 4;
+        for (; __i + 4 <= __n; __i += 4)
+        {
+            const __m256i __x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(__v + __i)), __bias);
+            __lo = _mm256_blendv_epi8(__lo, __x, _mm256_cmpgt_epi64(__lo, __x));
+            __hi = _mm256_blendv_epi8(__hi, __x, _mm256_cmpgt_epi64(__x, __hi));
+        }
+        _Rep __l[4], __h[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(__l), _mm256_xor_si256(__lo, __bias));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(__h), _mm256_xor_si256(__hi, __bias));
+        __min = __l[0];
+        __max = __h[0];
+        for (std::size_t __k = 1; __k < 4; ++__k)
+        {
+            __min = __l[__k] < __min ? __l[__k] : __min;
+            __max = __h[__k] > __max ? __h[__k] : __max;
+        }
+        for (; __i < __n; ++__i)
+        {
+            __min = __v[__i] < __min ? __v[__i] : __min;
+            __max = __v[__i] > __max ? __v[__i] : __max;
+        }
+    }
+};
+#endif
+
+
+// Array of metrics with an integral representation, stored in blocks of 64 values.  Each
+// block keeps its minimum as a base and the offsets to it in lanes of just enough bits for
+// the block's range.  Ranges wider than _Bits bits share an exponent (block floating point):
+// offsets are rounded to the nearest multiple of 2^shift, and only these blocks are lossy.
+// Values are appended to an unpacked tail, packed once 64 of them are there.
+template <class _Metric, unsigned _Bits = 16>
+class compact_array
+{
+    static_assert(std::is_integral<typename _Metric::rep>::value && sizeof(typename _Metric::rep) <= sizeof(long long),
+                  "compact_array needs an integral representation");
+    static_assert(_Bits >= 1 && _Bits <= 64, "lanes are 1 to 64 bits wide");
+
+public:
+    typedef _Metric metric_type;
+    typedef _Metric value_type;
+    typedef typename _Metric::rep rep;
+    static const std::size_t block_size = 64;
+
+private:
+    struct __header
+    {
+        unsigned long long __base_;
+        unsigned int       __word_;
+        unsigned char      __width_;
+        unsigned char      __shift_;
+    };
+
+    // A block of 64 lanes of w bits takes exactly w words.  One spare word ends the storage.
+    std::vector<unsigned long long> __words_;
+    std::vector<__header>           __blocks_;
+    std::vector<rep>                __tail_;
+
+    static inline unsigned long long __bits(rep __r) {return static_cast<unsigned long long>(static_cast<long long>(__r));}
+
+    void __pack()
+    {
+        rep __min, __max;
+        __block_range<rep>::__apply(__tail_.data(), block_size, __min, __max);
+        const unsigned long long __lo = __bits(__min);
+        const unsigned long long __range = __bits(__max) - __lo;
+        const unsigned __total = __bit_width(__range);
+        __header __h;
+        __h.__base_ = __lo;
+        __h.__word_ = static_cast<unsigned int>(__words_.size() - 1);
+        __h.__width_ = static_cast<unsigned char>(__total < _Bits ? __total : _Bits);
+        __h.__shift_ = static_cast<unsigned char>(__total - __h.__width_);
+
+        __words_.resize(__words_.size() + __h.__width_, 0);
+        unsigned long long* __w = &__words_[__h.__word_];
+        const unsigned long long __mask = __lane_mask(__h.__width_);
+        const unsigned long long __half = __h.__shift_ ? 1ULL << (__h.__shift_ - 1) : 0;
+        // Lanes are written one at a time: they straddle words at offsets that depend on the
+        // width, and AVX2 has no scatter to write them four by four.
+        for (std::size_t __k = 0; __h.__width_ != 0 && __k < block_size; ++__k)
+        {
+            const unsigned long long __d = __bits(__tail_[__k]) - __lo;
+            unsigned long long __lane = __d > ~0ULL - __half ? __mask : (__d + __half) >> __h.__shift_;
+            __lane = __lane > __mask ? __mask : __lane;
+            const std::size_t __pos = __k * __h.__width_;
+            const unsigned __sh = static_cast<unsigned>(__pos & 63);
+            __w[__pos >> 6] |= __lane << __sh;
+            if (__sh + __h.__width_ > 64)
+                __w[(__pos >> 6) + 1] |= __lane >> (64 - __sh);
+        }
+        __blocks_.push_back(__h);
+        __tail_.clear();
+    }
+
+    inline std::size_t __packed() const {return __blocks_.size() * block_size;}
+
+public:
+    compact_array() : __words_(1, 0) {__tail_.reserve(block_size);}
+
+    template <class _InputIterator>
+    compact_array(_InputIterator __first, _InputIterator __last) : __words_(1, 0)
+    {
+        __tail_.reserve(block_size);
+        for (; __first != __last; ++__first)
+            push_back(*__first);
+    }
+
+    inline void push_back(const _Metric& __m)
+    {
+        __tail_.push_back(__m.count());
+        if (__tail_.size() == block_size)
+            __pack();
+    }
+
+    inline std::size_t size() const {return __packed() + __tail_.size();}
+    inline bool empty() const {return size() == 0;}
+
+    void clear()
+    {
+        __words_.assign(1, 0);
+        __blocks_.clear();
+        __tail_.clear();
+    }
+
+    _Metric operator[](std::size_t __i) const
+    {
+        if (__i >= __packed())
+            return _Metric(__tail_[__i - __packed()]);
+        const __header& __h = __blocks_[__i / block_size];
+        const unsigned long long __lane = __read_lane(&__words_[__h.__word_], __h.__width_, __i % block_size);
+        return _Metric(static_cast<rep>(__h.__base_ + (__lane << __h.__shift_)));
+    }
+
+    // Unpacks __n values from __pos into __out, an array of metrics.  Returns the end of the output.
+    _Metric* unpack(std::size_t __pos, std::size_t __n, _Metric* __out) const
+    {
+        rep __buf[block_size];
+        while (__n != 0 && __pos < __packed())
+        {
+            const __header& __h = __blocks_[__pos / block_size];
+            const std::size_t __k = __pos % block_size;
+            const std::size_t __m = __n < block_size - __k ? __n : block_size - __k;
+            __unpack_block<rep>::__apply(&__words_[__h.__word_], __h.__base_, __h.__width_, __h.__shift_, __k + __m, __buf);
+            for (std::size_t __j = 0; __j < __m; ++__j)
+                __out[__j] = _Metric(__buf[__k + __j]);
+            __out += __m;
+            __pos += __m;
+            __n -= __m;
+        }
+        for (; __n != 0; --__n, ++__pos)
+            *__out++ = _Metric(__tail_[__pos - __packed()]);
+        return __out;
+    }
+
+    inline _Metric* unpack(_Metric* __out) const {return unpack(0, size(), __out);}
+
+    // True when every value reads back exactly.
+    bool lossless() const
+    {
+        for (std::size_t __b = 0; __b < __blocks_.size(); ++__b)
+            if (__blocks_[__b].__shift_ != 0)
+                return false;
+        return true;
+    }
+
+    // Bytes used by the values, without the spare capacity of the containers.
+    inline std::size_t memory() const
+    {
+        return __words_.size() * sizeof(unsigned long long) + __blocks_.size() * sizeof(__header) +
+               __tail_.size() * sizeof(rep);
+    }
+};
+
+template <class _Metric, unsigned _Bits>
+const std::size_t compact_array<_Metric, _Bits>::block_size;
+
+} // namespace metric
+
+#endif // METRICS_COMPACT_HPP
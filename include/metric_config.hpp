@@ -12,6 +12,7 @@
 #ifndef METRICS_CONFIG_HPP
 #define METRICS_CONFIG_HPP
 
+#include <cstddef>
 #include <ratio>
 #include <limits>
 
@@ -73,6 +74,42 @@ template<template <typename...> class _Template,
     : std::true_type
 {};
 
+// std::index_sequence, for C++11.  Built from its two halves, so the depth of instantiation is
+// logarithmic in its length.
+template <std::size_t... _Ip> struct __index_sequence {};
+
+template <class _Lhs, class _Rhs> struct __concat_index_sequence;
+
+template <std::size_t... _Ip, std::size_t... _Jp>
+struct __concat_index_sequence<__index_sequence<_Ip...>, __index_sequence<_Jp...> >
+{
+    typedef __index_sequence<_Ip..., (sizeof...(_Ip) + _Jp)...> type;
+};
+
+template <std::size_t _Np>
+struct __make_index_sequence
+    : __concat_index_sequence<typename __make_index_sequence<_Np / 2>::type,
+                              typename __make_index_sequence<_Np - _Np / 2>::type> {};
+
+template <>
+struct __make_index_sequence<0>
+{
+    typedef __index_sequence<> type;
+};
+
+template <>
+struct __make_index_sequence<1>
+{
+    typedef __index_sequence<0> type;
+};
+
+// Representations handled as integers, and as scalars in arithmetic with metrics.
+template <class _Rep> struct __is_integer_rep : std::is_integral<_Rep> {};
+template <class _Rep> struct __is_scalar_rep  : std::is_arithmetic<_Rep> {};
+
+// Representations with floating point semantics: conversions to them are implicit, even lossy.
+template <class _Rep> struct treat_as_floating_point : std::is_floating_point<_Rep> {};
+
 template <class _Rep>
 struct limits_values
 {
@@ -101,6 +138,29 @@ struct common_type< _Master<_Rep1, _Period1>,
 namespace metric
 {
 
+// Metrics are the class templates with a std::ratio period.  The generic comparison and
+// + and - operators are only defined for them, other templates reached by ADL (containers of
+// metrics and their iterators, ...) are left alone.
+template <class _Tp>
+struct __has_ratio_period
+{
+private:
+    template <class _Up> static std::__is_ratio<typename _Up::period> __test(int);
+    template <class _Up> static std::false_type __test(...);
+public:
+    static const bool value = decltype(__test<_Tp>(0))::value;
+};
+
+template <class _LhsMetric, class _RhsMetric>
+struct __metric_pair
+    : std::integral_constant<bool, __has_ratio_period<_LhsMetric>::value && __has_ratio_period<_RhsMetric>::value> {};
+
+template <class _LhsMetric, class _RhsMetric, bool = __metric_pair<_LhsMetric, _RhsMetric>::value>
+struct __metric_common_type {};
+
+template <class _LhsMetric, class _RhsMetric>
+struct __metric_common_type<_LhsMetric, _RhsMetric, true> : std::common_type<_LhsMetric, _RhsMetric> {};
+
 template <class _R1, class _R2>
 struct __no_overflow
 {
@@ -142,7 +202,7 @@ template <class _FromMetric, class _ToMetric, class _Period>
 struct __metric_cast<_FromMetric, _ToMetric, _Period, true, true>
 {
     inline METRICCONSTEXPR
-    _ToMetric operator()(const _FromMetric& __fd) const
+    _ToMetric operator()(const _FromMetric& __fd) const noexcept
     {
         return _ToMetric(static_cast<typename _ToMetric::rep>(__fd.count()));
     }
@@ -152,7 +212,7 @@ template <class _FromMetric, class _ToMetric, class _Period>
 struct __metric_cast<_FromMetric, _ToMetric, _Period, true, false>
 {
     inline METRICCONSTEXPR
-    _ToMetric operator()(const _FromMetric& __fd) const
+    _ToMetric operator()(const _FromMetric& __fd) const noexcept
     {
         typedef typename std::common_type<typename _ToMetric::rep, typename _FromMetric::rep, intmax_t>::type _Ct;
         return _ToMetric(static_cast<typename _ToMetric::rep>(
@@ -164,7 +224,7 @@ template <class _FromMetric, class _ToMetric, class _Period>
 struct __metric_cast<_FromMetric, _ToMetric, _Period, false, true>
 {
     inline METRICCONSTEXPR
-    _ToMetric operator()(const _FromMetric& __fd) const
+    _ToMetric operator()(const _FromMetric& __fd) const noexcept
     {
         typedef typename std::common_type<typename _ToMetric::rep, typename _FromMetric::rep, intmax_t>::type _Ct;
         return _ToMetric(static_cast<typename _ToMetric::rep>(
@@ -176,7 +236,7 @@ template <class _FromMetric, class _ToMetric, class _Period>
 struct __metric_cast<_FromMetric, _ToMetric, _Period, false, false>
 {
     inline METRICCONSTEXPR
-    _ToMetric operator()(const _FromMetric& __fd) const
+    _ToMetric operator()(const _FromMetric& __fd) const noexcept
     {
         typedef typename std::common_type<typename _ToMetric::rep, typename _FromMetric::rep, intmax_t>::type _Ct;
         return _ToMetric(static_cast<typename _ToMetric::rep>(
@@ -185,8 +245,33 @@ struct __metric_cast<_FromMetric, _ToMetric, _Period, false, false>
     }
 };
 
-// Metric ==
+// Mixed-unit comparisons: lhs * P1 ? rhs * P2  <=>  lhs * n ? rhs * d, with n / d = P1 / P2 reduced.
+// Signed counts up to 64 bits, and unsigned ones narrower than 64 bits, are cross-multiplied in
+// 128 bits, which is exact whatever the periods: no conversion to the common_type, whose GCD / LCM
+// period easily overflows.  An unsigned 64 bit count times a factor near 2^63 would not fit.
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef __int128 __cross_product_type;
+#endif
+
+template <class _Rep>
+struct __cross_multipliable
+    : std::integral_constant<bool,
+#if defined(__SIZEOF_INT128__)
+        std::is_integral<_Rep>::value &&
+        (std::is_signed<_Rep>::value ? sizeof(_Rep) <= sizeof(long long) : sizeof(_Rep) < sizeof(long long))
+#else
+        false
+#endif
+    > {};
+
 template <class _LhsMetric, class _RhsMetric>
+struct __metric_cross_multipliable
+    : std::integral_constant<bool, __cross_multipliable<typename _LhsMetric::rep>::value &&
+                                   __cross_multipliable<typename _RhsMetric::rep>::value &&
+                                   !std::is_same<_LhsMetric, _RhsMetric>::value> {};
+
+// Metric ==
+template <class _LhsMetric, class _RhsMetric, bool = __metric_cross_multipliable<_LhsMetric, _RhsMetric>::value>
 struct __metric_eq
 {
     inline METRICCONSTEXPR
@@ -197,8 +282,23 @@ struct __metric_eq
         }
 };
 
+#if defined(__SIZEOF_INT128__)
+template <class _LhsMetric, class _RhsMetric>
+struct __metric_eq<_LhsMetric, _RhsMetric, true>
+{
+    typedef typename std::ratio_divide<typename _LhsMetric::period, typename _RhsMetric::period>::type _Period;
+
+    inline METRICCONSTEXPR
+    bool operator()(const _LhsMetric& __lhs, const _RhsMetric& __rhs) const
+        {
+            return static_cast<__cross_product_type>(__lhs.count()) * _Period::num ==
+                   static_cast<__cross_product_type>(__rhs.count()) * _Period::den;
+        }
+};
+#endif
+
 template <class _LhsMetric>
-struct __metric_eq<_LhsMetric, _LhsMetric>
+struct __metric_eq<_LhsMetric, _LhsMetric, false>
 {
     inline METRICCONSTEXPR
     bool operator()(const _LhsMetric& __lhs, const _LhsMetric& __rhs) const
@@ -208,7 +308,7 @@ struct __metric_eq<_LhsMetric, _LhsMetric>
 template <template <typename...> class _Master, class _Rep1, class _Period1, class _Rep2, class _Period2>
 inline
 METRICCONSTEXPR
-bool
+typename std::enable_if<__metric_pair<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::value, bool>::type
 operator==(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>& __rhs)
 {
     return __metric_eq<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >()(__lhs, __rhs);
@@ -218,7 +318,7 @@ operator==(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>
 template <template <typename...> class _Master, class _Rep1, class _Period1, class _Rep2, class _Period2>
 inline
 METRICCONSTEXPR
-bool
+typename std::enable_if<__metric_pair<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::value, bool>::type
 operator!=(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>& __rhs)
 {
     return !(__lhs == __rhs);
@@ -226,7 +326,7 @@ operator!=(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>
 
 
 // Metric <
-template <class _LhsMetric, class _RhsMetric>
+template <class _LhsMetric, class _RhsMetric, bool = __metric_cross_multipliable<_LhsMetric, _RhsMetric>::value>
 struct __metric_lt
 {
     inline METRICCONSTEXPR
@@ -237,19 +337,33 @@ struct __metric_lt
         }
 };
 
+#if defined(__SIZEOF_INT128__)
+template <class _LhsMetric, class _RhsMetric>
+struct __metric_lt<_LhsMetric, _RhsMetric, true>
+{
+    typedef typename std::ratio_divide<typename _LhsMetric::period, typename _RhsMetric::period>::type _Period;
+
+    inline METRICCONSTEXPR
+    bool operator()(const _LhsMetric& __lhs, const _RhsMetric& __rhs) const
+        {
+            return static_cast<__cross_product_type>(__lhs.count()) * _Period::num <
+                   static_cast<__cross_product_type>(__rhs.count()) * _Period::den;
+        }
+};
+#endif
+
 template <class _LhsMetric>
-struct __metric_lt<_LhsMetric, _LhsMetric>
+struct __metric_lt<_LhsMetric, _LhsMetric, false>
 {
     inline METRICCONSTEXPR
     bool operator()(const _LhsMetric& __lhs, const _LhsMetric& __rhs) const
         {return __lhs.count() < __rhs.count();}
 };
 
-
 template <template <typename...> class _Master, class _Rep1, class _Period1, class _Rep2, class _Period2>
 inline
 METRICCONSTEXPR
-bool
+typename std::enable_if<__metric_pair<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::value, bool>::type
 operator< (const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>& __rhs)
 {
     return __metric_lt<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >()(__lhs, __rhs);
@@ -259,7 +373,7 @@ operator< (const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>
 template <template <typename...> class _Master, class _Rep1, class _Period1, class _Rep2, class _Period2>
 inline
 METRICCONSTEXPR
-bool
+typename std::enable_if<__metric_pair<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::value, bool>::type
 operator> (const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>& __rhs)
 {
     return __rhs < __lhs;
@@ -269,7 +383,7 @@ operator> (const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>
 template <template <typename...> class _Master, class _Rep1, class _Period1, class _Rep2, class _Period2>
 inline
 METRICCONSTEXPR
-bool
+typename std::enable_if<__metric_pair<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::value, bool>::type
 operator<=(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>& __rhs)
 {
     return !(__rhs < __lhs);
@@ -279,7 +393,7 @@ operator<=(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>
 template <template <typename...> class _Master, class _Rep1, class _Period1, class _Rep2, class _Period2>
 inline
 METRICCONSTEXPR
-bool
+typename std::enable_if<__metric_pair<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::value, bool>::type
 operator>=(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>& __rhs)
 {
     return !(__lhs < __rhs);
@@ -289,7 +403,7 @@ operator>=(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>
 template <template <typename...> class _Master, class _Rep1, class _Period1, class _Rep2, class _Period2>
 inline
 METRICCONSTEXPR
-typename std::common_type<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::type
+typename __metric_common_type<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::type
 operator+(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>& __rhs)
 {
     typedef typename std::common_type<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::type _Cd;
@@ -300,7 +414,7 @@ operator+(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>&
 template <template <typename...> class _Master, class _Rep1, class _Period1, class _Rep2, class _Period2>
 inline
 METRICCONSTEXPR
-typename std::common_type<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::type
+typename __metric_common_type<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::type
 operator-(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>& __rhs)
 {
     typedef typename std::common_type<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> >::type _Cd;
@@ -371,7 +485,7 @@ operator/(const _Master<_Rep1, _Period1>& __lhs, const _Master<_Rep2, _Period2>&
     return _Ct(__lhs).count() / _Ct(__rhs).count();
 }
 
-template <template <typename...> class _Master, class _Rep1, class _Period, class _Rep2, typename std::enable_if<std::is_arithmetic<_Rep2>::value, int>::type = 0>
+template <template <typename...> class _Master, class _Rep1, class _Period, class _Rep2, typename std::enable_if<__is_scalar_rep<_Rep2>::value, int>::type = 0>
 inline
 METRICCONSTEXPR
 typename __metric_divide_result<_Master, _Master<_Rep1, _Period>, _Rep2>::type
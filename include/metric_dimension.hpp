@@ -0,0 +1,572 @@
+// -*- C++ -*-
+//
+//===---------------------------- dimension -------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_DIMENSION_HPP
+#define METRICS_DIMENSION_HPP
+
+#include "metric_config.hpp"
+#include "metric_rounding.hpp"
+#include "angularspeed.hpp"
+#include "density.hpp"
+#include "distance.hpp"
+#include "electriccurrent.hpp"
+#include "electricresistance.hpp"
+#include "energy.hpp"
+#include "flowrate.hpp"
+#include "force.hpp"
+#include "frequency.hpp"
+#include "mass.hpp"
+#include "power.hpp"
+#include "pressure.hpp"
+#include "sipressure.hpp"
+#include "speed.hpp"
+#include "voltage.hpp"
+#include "volume.hpp"
+#include <chrono>
+
+namespace metric {
+
+// Exponents of the base dimensions: length, mass, time, electric current and angle (in turns).
+template <int _Length, int _Mass, int _Time, int _Current, int _Angle>
+struct dimension
+{
+    static const int length  = _Length;
+    static const int mass    = _Mass;
+    static const int time    = _Time;
+    static const int current = _Current;
+    static const int angle   = _Angle;
+};
+
+typedef dimension<0, 0, 0, 0, 0> dimensionless;
+
+template <class _D1, class _D2>
+struct dimension_multiply
+{
+    typedef dimension<_D1::length  + _D2::length,
+                      _D1::mass    + _D2::mass,
+                      _D1::time    + _D2::time,
+                      _D1::current + _D2::current,
+                      _D1::angle   + _D2::angle> type;
+};
+
+template <class _D1, class _D2>
+struct dimension_divide
+{
+    typedef dimension<_D1::length  - _D2::length,
+                      _D1::mass    - _D2::mass,
+                      _D1::time    - _D2::time,
+                      _D1::current - _D2::current,
+                      _D1::angle   - _D2::angle> type;
+};
+
+
+template <class _Dimension, class _Rep, class _Period> class derived_quantity;
+
+template <class A> struct __is_derived_quantity : std::false_type {};
+template <class _Dimension, class _Rep, class _Period>
+struct __is_derived_quantity<derived_quantity<_Dimension, _Rep, _Period> > : std::true_type {};
+
+template <class _Dimension, class _Rep1, class _Period1, class _Rep2, class _Period2>
+struct __same_metric<derived_quantity<_Dimension, _Rep1, _Period1>, derived_quantity<_Dimension, _Rep2, _Period2> >
+    : std::true_type {};
+
+}
+
+namespace std
+{
+    // CLASS TEMPLATE common_type SPECIALIZATIONS
+    template <class _Dimension, class _Rep1, class _Period1, class _Rep2, class _Period2>
+    struct common_type<
+        metric::derived_quantity<_Dimension, _Rep1, _Period1>,
+        metric::derived_quantity<_Dimension, _Rep2, _Period2>
+        >
+    {
+        typedef metric::derived_quantity<_Dimension, typename common_type<_Rep1, _Rep2>::type,
+            ratio< GCD<_Period1::num, _Period2::num>::value,
+                   LCM<_Period1::den, _Period2::den>::value> > type;
+    };
+}
+
+namespace metric {
+
+template <class _ToQuantity, class _Dimension, class _Rep, class _Period>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __is_derived_quantity<_ToQuantity>::value,
+    _ToQuantity
+>::type
+derived_quantity_cast(const derived_quantity<_Dimension, _Rep, _Period>& __fd)
+{
+    return __metric_cast<derived_quantity<_Dimension, _Rep, _Period>, _ToQuantity>()(__fd);
+}
+
+
+// Quantity of any dimension without a dedicated metric class (acceleration, area, ...).
+// The period is expressed in coherent SI units.
+template <class _Dimension, class _Rep, class _Period>
+class derived_quantity
+{
+    static_assert(!__is_derived_quantity<_Rep>::value, "A derived_quantity representation can not be a derived_quantity");
+    static_assert(std::__is_ratio<_Period>::value, "Third template parameter of derived_quantity must be a std::ratio");
+    static_assert(_Period::num > 0, "derived_quantity period must be positive");
+
+public:
+    typedef _Dimension dimension_type;
+    typedef _Rep rep;
+    typedef _Period period;
+private:
+    rep __rep_;
+public:
+
+    inline METRICCONSTEXPR
+    derived_quantity() = default;
+
+    template <class _Rep2>
+        inline METRICCONSTEXPR
+        explicit derived_quantity(const _Rep2& __r,
+            typename std::enable_if
+            <
+               std::is_convertible<_Rep2, rep>::value &&
+               (treat_as_floating_point<rep>::value ||
+               !treat_as_floating_point<_Rep2>::value)
+            >::type* = 0) noexcept
+                : __rep_(__r) {}
+
+    // conversions
+    template <class _Rep2, class _Period2>
+        inline METRICCONSTEXPR
+        derived_quantity(const derived_quantity<_Dimension, _Rep2, _Period2>& __d,
+            typename std::enable_if
+            <
+                __no_overflow<_Period2, period>::value && (
+                treat_as_floating_point<rep>::value ||
+                (__no_overflow<_Period2, period>::type::den == 1 &&
+                 !treat_as_floating_point<_Rep2>::value))
+            >::type* = 0) noexcept
+                : __rep_(metric::derived_quantity_cast<derived_quantity>(__d).count()) {}
+
+    // observer
+
+    inline METRICCONSTEXPR rep count() const noexcept {return __rep_;}
+
+    // arithmetic
+
+    inline METRICCONSTEXPR derived_quantity  operator+() const {return *this;}
+    inline METRICCONSTEXPR derived_quantity  operator-() const {return derived_quantity(-__rep_);}
+    inline const derived_quantity& operator++()      {++__rep_; return *this;}
+    inline const derived_quantity  operator++(int)   {return derived_quantity(__rep_++);}
+    inline const derived_quantity& operator--()      {--__rep_; return *this;}
+    inline const derived_quantity  operator--(int)   {return derived_quantity(__rep_--);}
+
+    inline const derived_quantity& operator+=(const derived_quantity& __d) {__rep_ += __d.count(); return *this;}
+    inline const derived_quantity& operator-=(const derived_quantity& __d) {__rep_ -= __d.count(); return *this;}
+
+    inline const derived_quantity& operator*=(const rep& rhs) {__rep_ *= rhs; return *this;}
+    inline const derived_quantity& operator/=(const rep& rhs) {__rep_ /= rhs; return *this;}
+    inline const derived_quantity& operator%=(const rep& rhs) {__rep_ %= rhs; return *this;}
+    inline const derived_quantity& operator%=(const derived_quantity& rhs) {__rep_ %= rhs.count(); return *this;}
+
+    // special values
+
+    inline static METRICCONSTEXPR derived_quantity zero() {return derived_quantity(limits_values<rep>::zero());}
+    inline static METRICCONSTEXPR derived_quantity min()  {return derived_quantity(limits_values<rep>::min());}
+    inline static METRICCONSTEXPR derived_quantity max()  {return derived_quantity(limits_values<rep>::max());}
+};
+
+// derived_quantity ==, !=, <, >, <=, >=
+template <class _Dimension, class _Rep1, class _Period1, class _Rep2, class _Period2>
+inline
+METRICCONSTEXPR
+bool
+operator==(const derived_quantity<_Dimension, _Rep1, _Period1>& __lhs, const derived_quantity<_Dimension, _Rep2, _Period2>& __rhs)
+{
+    return __metric_eq<derived_quantity<_Dimension, _Rep1, _Period1>, derived_quantity<_Dimension, _Rep2, _Period2> >()(__lhs, __rhs);
+}
+
+template <class _Dimension, class _Rep1, class _Period1, class _Rep2, class _Period2>
+inline
+METRICCONSTEXPR
+bool
+operator!=(const derived_quantity<_Dimension, _Rep1, _Period1>& __lhs, const derived_quantity<_Dimension, _Rep2, _Period2>& __rhs)
+{
+    return !(__lhs == __rhs);
+}
+
+template <class _Dimension, class _Rep1, class _Period1, class _Rep2, class _Period2>
+inline
+METRICCONSTEXPR
+bool
+operator< (const derived_quantity<_Dimension, _Rep1, _Period1>& __lhs, const derived_quantity<_Dimension, _Rep2, _Period2>& __rhs)
+{
+    return __metric_lt<derived_quantity<_Dimension, _Rep1, _Period1>, derived_quantity<_Dimension, _Rep2, _Period2> >()(__lhs, __rhs);
+}
+
+template <class _Dimension, class _Rep1, class _Period1, class _Rep2, class _Period2>
+inline
+METRICCONSTEXPR
+bool
+operator> (const derived_quantity<_Dimension, _Rep1, _Period1>& __lhs, const derived_quantity<_Dimension, _Rep2, _Period2>& __rhs)
+{
+    return __rhs < __lhs;
+}
+
+template <class _Dimension, class _Rep1, class _Period1, class _Rep2, class _Period2>
+inline
+METRICCONSTEXPR
+bool
+operator<=(const derived_quantity<_Dimension, _Rep1, _Period1>& __lhs, const derived_quantity<_Dimension, _Rep2, _Period2>& __rhs)
+{
+    return !(__rhs < __lhs);
+}
+
+template <class _Dimension, class _Rep1, class _Period1, class _Rep2, class _Period2>
+inline
+METRICCONSTEXPR
+bool
+operator>=(const derived_quantity<_Dimension, _Rep1, _Period1>& __lhs, const derived_quantity<_Dimension, _Rep2, _Period2>& __rhs)
+{
+    return !(__lhs < __rhs);
+}
+
+// derived_quantity +, -
+template <class _Dimension, class _Rep1, class _Period1, class _Rep2, class _Period2>
+inline
+METRICCONSTEXPR
+typename std::common_type<derived_quantity<_Dimension, _Rep1, _Period1>, derived_quantity<_Dimension, _Rep2, _Period2> >::type
+operator+(const derived_quantity<_Dimension, _Rep1, _Period1>& __lhs, const derived_quantity<_Dimension, _Rep2, _Period2>& __rhs)
+{
+    typedef typename std::common_type<derived_quantity<_Dimension, _Rep1, _Period1>, derived_quantity<_Dimension, _Rep2, _Period2> >::type _Cd;
+    return _Cd(_Cd(__lhs).count() + _Cd(__rhs).count());
+}
+
+template <class _Dimension, class _Rep1, class _Period1, class _Rep2, class _Period2>
+inline
+METRICCONSTEXPR
+typename std::common_type<derived_quantity<_Dimension, _Rep1, _Period1>, derived_quantity<_Dimension, _Rep2, _Period2> >::type
+operator-(const derived_quantity<_Dimension, _Rep1, _Period1>& __lhs, const derived_quantity<_Dimension, _Rep2, _Period2>& __rhs)
+{
+    typedef typename std::common_type<derived_quantity<_Dimension, _Rep1, _Period1>, derived_quantity<_Dimension, _Rep2, _Period2> >::type _Cd;
+    return _Cd(_Cd(__lhs).count() - _Cd(__rhs).count());
+}
+
+// derived_quantity *, / scalar
+template <class _Dimension, class _Rep1, class _Period, class _Rep2>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __is_scalar_rep<_Rep2>::value &&
+    std::is_convertible<_Rep2, typename std::common_type<_Rep1, _Rep2>::type>::value,
+    derived_quantity<_Dimension, typename std::common_type<_Rep1, _Rep2>::type, _Period>
+>::type
+operator*(const derived_quantity<_Dimension, _Rep1, _Period>& __d, const _Rep2& __s)
+{
+    typedef typename std::common_type<_Rep1, _Rep2>::type _Cr;
+    typedef derived_quantity<_Dimension, _Cr, _Period> _Cd;
+    return _Cd(_Cd(__d).count() * static_cast<_Cr>(__s));
+}
+
+template <class _Dimension, class _Rep1, class _Rep2, class _Period>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __is_scalar_rep<_Rep1>::value &&
+    std::is_convertible<_Rep1, typename std::common_type<_Rep1, _Rep2>::type>::value,
+    derived_quantity<_Dimension, typename std::common_type<_Rep1, _Rep2>::type, _Period>
+>::type
+operator*(const _Rep1& __s, const derived_quantity<_Dimension, _Rep2, _Period>& __d)
+{
+    return __d * __s;
+}
+
+template <class _Dimension, class _Rep1, class _Period, class _Rep2>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __is_scalar_rep<_Rep2>::value &&
+    std::is_convertible<_Rep2, typename std::common_type<_Rep1, _Rep2>::type>::value,
+    derived_quantity<_Dimension, typename std::common_type<_Rep1, _Rep2>::type, _Period>
+>::type
+operator/(const derived_quantity<_Dimension, _Rep1, _Period>& __d, const _Rep2& __s)
+{
+    typedef typename std::common_type<_Rep1, _Rep2>::type _Cr;
+    typedef derived_quantity<_Dimension, _Cr, _Period> _Cd;
+    return _Cd(_Cd(__d).count() / static_cast<_Cr>(__s));
+}
+
+
+typedef derived_quantity<dimension<2, 0,  0, 0, 0>, long long, std::ratio<1> > square_metre;
+typedef derived_quantity<dimension<1, 0, -2, 0, 0>, long long, std::ratio<1> > metre_second_squared;
+typedef derived_quantity<dimension<1, 0, -2, 0, 0>, long long, std::milli    > millimetre_second_squared;
+
+
+// Dimension of each metric, and the value of one count in coherent SI units (metre, kilogram, second, ampere, turn).
+template <class _Quantity>
+struct quantity_dimension
+{
+    static const bool value = false;
+};
+
+template <class _Dimension, class _Rep, class _Scale>
+struct __quantity_dimension_base
+{
+    static const bool value = true;
+    typedef _Dimension type;
+    typedef _Rep rep;
+    typedef _Scale scale;
+};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<distance<_Rep, _Period> >
+    : __quantity_dimension_base<dimension<1, 0, 0, 0, 0>, _Rep, _Period> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<mass<_Rep, _Period> >     // Gram based.
+    : __quantity_dimension_base<dimension<0, 1, 0, 0, 0>, _Rep, typename std::ratio_multiply<_Period, std::milli>::type> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<std::chrono::duration<_Rep, _Period> >
+    : __quantity_dimension_base<dimension<0, 0, 1, 0, 0>, _Rep, _Period> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<electriccurrent<_Rep, _Period> >
+    : __quantity_dimension_base<dimension<0, 0, 0, 1, 0>, _Rep, _Period> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<volume<_Rep, _Period> >   // Litre based.
+    : __quantity_dimension_base<dimension<3, 0, 0, 0, 0>, _Rep, typename std::ratio_multiply<_Period, std::milli>::type> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<density<_Rep, _Period> >  // Gram per litre based, the coherent kilogram per cubic metre.
+    : __quantity_dimension_base<dimension<-3, 1, 0, 0, 0>, _Rep, _Period> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<frequency<_Rep, _Period> >
+    : __quantity_dimension_base<dimension<0, 0, -1, 0, 0>, _Rep, _Period> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<angularspeed<_Rep, _Period> > // Turn per hour based.
+    : __quantity_dimension_base<dimension<0, 0, -1, 0, 1>, _Rep, typename std::ratio_multiply<_Period, std::ratio<1, 3600> >::type> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<force<_Rep, _Period> >
+    : __quantity_dimension_base<dimension<1, 1, -2, 0, 0>, _Rep, _Period> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<pressure<_Rep, _Period> > // Atmosphere based.
+    : __quantity_dimension_base<dimension<-1, 1, -2, 0, 0>, _Rep, typename std::ratio_multiply<_Period, std::ratio<101325> >::type> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<si_pressure<_Rep, _Period> >  // Pascal based.
+    : __quantity_dimension_base<dimension<-1, 1, -2, 0, 0>, _Rep, _Period> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<power<_Rep, _Period> >
+    : __quantity_dimension_base<dimension<2, 1, -3, 0, 0>, _Rep, _Period> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<voltage<_Rep, _Period> >
+    : __quantity_dimension_base<dimension<2, 1, -3, -1, 0>, _Rep, _Period> {};
+
+template <class _Rep, class _Period>
+struct quantity_dimension<electricresistance<_Rep, _Period> >
+    : __quantity_dimension_base<dimension<2, 1, -3, -2, 0>, _Rep, _Period> {};
+
+template <class _Distance, class _Time>
+struct quantity_dimension<speed<_Distance, _Time> >
+    : __quantity_dimension_base<dimension<1, 0, -1, 0, 0>, typename speed<_Distance, _Time>::rep,
+                                typename speed<_Distance, _Time>::period> {};
+
+template <class _Power, class _Time>
+struct quantity_dimension<energy<_Power, _Time> >
+    : __quantity_dimension_base<dimension<2, 1, -2, 0, 0>, typename energy<_Power, _Time>::rep,
+                                typename energy<_Power, _Time>::period> {};
+
+template <class _Volume, class _Time>
+struct quantity_dimension<flowrate<_Volume, _Time> >
+    : __quantity_dimension_base<dimension<3, 0, -1, 0, 0>, typename flowrate<_Volume, _Time>::rep,
+                                typename std::ratio_multiply<typename flowrate<_Volume, _Time>::period, std::milli>::type> {};
+
+template <class _Dimension, class _Rep, class _Period>
+struct quantity_dimension<derived_quantity<_Dimension, _Rep, _Period> >
+    : __quantity_dimension_base<_Dimension, _Rep, _Period> {};
+
+
+// Metric holding a value of a dimension, whose count is expressed with the given SI scale.
+// Dimensions without a dedicated metric give a derived_quantity; dimensionless results are not metrics.
+template <class _Dimension, class _Rep, class _Scale>
+struct dimension_quantity
+{
+    typedef derived_quantity<_Dimension, _Rep, _Scale> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimensionless, _Rep, _Scale>
+{
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<1, 0, 0, 0, 0>, _Rep, _Scale>
+{
+    typedef distance<_Rep, _Scale> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<0, 1, 0, 0, 0>, _Rep, _Scale>
+{
+    typedef mass<_Rep, typename std::ratio_divide<_Scale, std::milli>::type> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<0, 0, 1, 0, 0>, _Rep, _Scale>
+{
+    typedef std::chrono::duration<_Rep, _Scale> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<0, 0, 0, 1, 0>, _Rep, _Scale>
+{
+    typedef electriccurrent<_Rep, _Scale> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<3, 0, 0, 0, 0>, _Rep, _Scale>
+{
+    typedef volume<_Rep, typename std::ratio_divide<_Scale, std::milli>::type> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<-3, 1, 0, 0, 0>, _Rep, _Scale>
+{
+    typedef density<_Rep, _Scale> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<0, 0, -1, 0, 0>, _Rep, _Scale>
+{
+    typedef frequency<_Rep, _Scale> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<0, 0, -1, 0, 1>, _Rep, _Scale>
+{
+    typedef angularspeed<_Rep, typename std::ratio_divide<_Scale, std::ratio<1, 3600> >::type> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<1, 1, -2, 0, 0>, _Rep, _Scale>
+{
+    typedef force<_Rep, _Scale> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<-1, 1, -2, 0, 0>, _Rep, _Scale>
+{
+    typedef pressure<_Rep, typename std::ratio_divide<_Scale, std::ratio<101325> >::type> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<2, 1, -3, 0, 0>, _Rep, _Scale>
+{
+    typedef power<_Rep, _Scale> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<2, 1, -3, -1, 0>, _Rep, _Scale>
+{
+    typedef voltage<_Rep, _Scale> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<2, 1, -3, -2, 0>, _Rep, _Scale>
+{
+    typedef electricresistance<_Rep, _Scale> type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<1, 0, -1, 0, 0>, _Rep, _Scale>
+{
+    typedef speed<distance<_Rep, _Scale>, std::chrono::duration<_Rep> > type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<2, 1, -2, 0, 0>, _Rep, _Scale>
+{
+    typedef energy<power<_Rep, _Scale>, std::chrono::duration<_Rep> > type;
+};
+
+template <class _Rep, class _Scale>
+struct dimension_quantity<dimension<3, 0, -1, 0, 0>, _Rep, _Scale>
+{
+    typedef flowrate<volume<_Rep, typename std::ratio_divide<_Scale, std::milli>::type>, std::chrono::duration<_Rep> > type;
+};
+
+
+// Result of a product or a quotient of two metrics.  The SI scales of both operands are folded at
+// compile time into the period of the result, so the result count is the product (or quotient) of the counts.
+template <class _Lhs, class _Rhs, bool = quantity_dimension<_Lhs>::value && quantity_dimension<_Rhs>::value>
+struct __dimension_product
+{
+};
+
+template <class _Lhs, class _Rhs>
+struct __dimension_product<_Lhs, _Rhs, true>
+    : dimension_quantity<
+        typename dimension_multiply<typename quantity_dimension<_Lhs>::type, typename quantity_dimension<_Rhs>::type>::type,
+        typename std::common_type<typename quantity_dimension<_Lhs>::rep, typename quantity_dimension<_Rhs>::rep>::type,
+        typename std::ratio_multiply<typename quantity_dimension<_Lhs>::scale, typename quantity_dimension<_Rhs>::scale>::type>
+{
+};
+
+template <class _Lhs, class _Rhs, bool = quantity_dimension<_Lhs>::value && quantity_dimension<_Rhs>::value>
+struct __dimension_quotient
+{
+};
+
+template <class _Lhs, class _Rhs>
+struct __dimension_quotient<_Lhs, _Rhs, true>
+    : dimension_quantity<
+        typename dimension_divide<typename quantity_dimension<_Lhs>::type, typename quantity_dimension<_Rhs>::type>::type,
+        typename std::common_type<typename quantity_dimension<_Lhs>::rep, typename quantity_dimension<_Rhs>::rep>::type,
+        typename std::ratio_divide<typename quantity_dimension<_Lhs>::scale, typename quantity_dimension<_Rhs>::scale>::type>
+{
+};
+
+// Any metric * any metric.  Dedicated operators (Ohm's law, Energy = Power * Time, ...) are more
+// specialized and keep precedence.
+template <class _Lhs, class _Rhs>
+inline
+METRICCONSTEXPR
+typename __dimension_product<_Lhs, _Rhs>::type
+operator*(const _Lhs& __lhs, const _Rhs& __rhs) noexcept
+{
+    typedef typename __dimension_product<_Lhs, _Rhs>::type _Rt;
+    return _Rt(static_cast<typename _Rt::rep>(__lhs.count()) * static_cast<typename _Rt::rep>(__rhs.count()));
+}
+
+// Any metric / any metric, of different dimensions.
+template <class _Lhs, class _Rhs>
+inline
+METRICCONSTEXPR
+typename __dimension_quotient<_Lhs, _Rhs>::type
+operator/(const _Lhs& __lhs, const _Rhs& __rhs) noexcept
+{
+    typedef typename __dimension_quotient<_Lhs, _Rhs>::type _Rt;
+    return _Rt(static_cast<typename _Rt::rep>(__lhs.count()) / static_cast<typename _Rt::rep>(__rhs.count()));
+}
+
+} // namespace metric
+
+#endif // METRICS_DIMENSION_HPP
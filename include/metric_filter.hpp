@@ -0,0 +1,344 @@
+// -*- C++ -*-
+//
+//===---------------------------- filter ----------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_FILTER_HPP
+#define METRICS_FILTER_HPP
+
+#include "metric_config.hpp"
+#include "frequency.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace metric {
+
+// Filters compute in double and give back the metric they are fed with: integral counts are
+// rounded to nearest, ties to even, as round_cast.  A filter starts in the steady state of its
+// first sample, as if the signal had always been at that value, so slow quantities far from
+// zero (an atmospheric pressure in pascal) do not ring at start up.
+
+static const double __filter_pi = 3.14159265358979323846;
+
+template <class _Rep, class _Period>
+inline double __hertz(const frequency<_Rep, _Period>& __f)
+{
+    return frequency_cast<frequency<double> >(__f).count();
+}
+
+// Normalized frequency of a cutoff, in cycles per sample, checked below the Nyquist frequency.
+template <class _Rep1, class _Period1, class _Rep2, class _Period2>
+inline double __filter_cutoff(const frequency<_Rep1, _Period1>& __cutoff, const frequency<_Rep2, _Period2>& __rate)
+{
+    const double __fs = __hertz(__rate);
+    const double __fc = __hertz(__cutoff);
+    if (!(__fs > 0) || !(__fc > 0) || !(2 * __fc < __fs))
+        throw std::invalid_argument("metric filter: the cutoff must be between zero and half the sample rate");
+    return __fc / __fs;
+}
+
+template <class _Metric, bool = treat_as_floating_point<typename _Metric::rep>::value>
+struct __filter_out
+{
+    static inline _Metric __apply(double __v) {return _Metric(static_cast<typename _Metric::rep>(__v));}
+};
+
+template <class _Metric>
+struct __filter_out<_Metric, false>
+{
+    static inline _Metric __apply(double __v) {return _Metric(static_cast<typename _Metric::rep>(std::nearbyint(__v)));}
+};
+
+
+// Exponential moving average, the first order low pass of an RC circuit sampled at the given
+// rate: y += a (x - y), with a = 1 - exp(-2 pi cutoff / rate).
+template <class _Metric>
+class ema
+{
+    double __alpha_;
+    double __y_;
+    bool   __primed_;
+
+public:
+    typedef _Metric metric_type;
+
+    template <class _Rep1, class _Period1, class _Rep2, class _Period2>
+    inline ema(const frequency<_Rep1, _Period1>& __cutoff, const frequency<_Rep2, _Period2>& __rate)
+        : __alpha_(1 - std::exp(-2 * __filter_pi * __filter_cutoff(__cutoff, __rate))), __y_(0), __primed_(false) {}
+
+    inline double smoothing() const {return __alpha_;}
+
+    inline void reset() {__primed_ = false;}
+    inline void reset(const _Metric& __m) {__y_ = static_cast<double>(__m.count()); __primed_ = true;}
+
+    inline _Metric operator()(const _Metric& __m)
+    {
+        const double __x = static_cast<double>(__m.count());
+        __y_ = __primed_ ? __y_ + __alpha_ * (__x - __y_) : __x;
+        __primed_ = true;
+        return __filter_out<_Metric>::__apply(__y_);
+    }
+
+    template <class _InputIterator, class _OutputIterator>
+    _OutputIterator process(_InputIterator __first, _InputIterator __last, _OutputIterator __out)
+    {
+        for (; __first != __last; ++__first, (void) ++__out)
+            *__out = (*this)(*__first);
+        return __out;
+    }
+};
+
+
+// Second order section, coefficients of the audio EQ cookbook (R. Bristow-Johnson), run in
+// transposed direct form II.  A recursion: each output needs the previous one, so blocks are
+// processed a sample at a time, with the state kept in registers.
+template <class _Metric>
+class biquad
+{
+    double __b0_, __b1_, __b2_, __a1_, __a2_;
+    double __s1_, __s2_;
+    bool   __primed_;
+
+    struct __design
+    {
+        double __cos_;
+        double __alpha_;
+
+        template <class _Rep1, class _Period1, class _Rep2, class _Period2>
+        __design(const frequency<_Rep1, _Period1>& __f, const frequency<_Rep2, _Period2>& __rate, double __q)
+        {
+            if (!(__q > 0))
+                throw std::invalid_argument("metric filter: the quality factor must be positive");
+            const double __w = 2 * __filter_pi * __filter_cutoff(__f, __rate);
+            __cos_ = std::cos(__w);
+            __alpha_ = std::sin(__w) / (2 * __q);
+        }
+    };
+
+    inline biquad(double __b0, double __b1, double __b2, double __a0, double __a1, double __a2)
+        : __b0_(__b0 / __a0), __b1_(__b1 / __a0), __b2_(__b2 / __a0), __a1_(__a1 / __a0), __a2_(__a2 / __a0),
+          __s1_(0), __s2_(0), __primed_(false) {}
+
+    // One step of the transposed direct form II, shared by the sample and the batch paths.
+    inline double __step(double __x, double& __s1, double& __s2) const
+    {
+        const double __y = __b0_ * __x + __s1;
+        __s1 = __b1_ * __x - __a1_ * __y + __s2;
+        __s2 = __b2_ * __x - __a2_ * __y;
+        return __y;
+    }
+
+public:
+    typedef _Metric metric_type;
+
+    // Butterworth response when __q is 1 / sqrt(2).
+    template <class _Rep1, class _Period1, class _Rep2, class _Period2>
+    static biquad lowpass(const frequency<_Rep1, _Period1>& __cutoff, const frequency<_Rep2, _Period2>& __rate,
+                          double __q = 0.70710678118654752440)
+    {
+        const __design __d(__cutoff, __rate, __q);
+        return biquad((1 - __d.__cos_) / 2, 1 - __d.__cos_, (1 - __d.__cos_) / 2,
+                      1 + __d.__alpha_, -2 * __d.__cos_, 1 - __d.__alpha_);
+    }
+
+    template <class _Rep1, class _Period1, class _Rep2, class _Period2>
+    static biquad highpass(const frequency<_Rep1, _Period1>& __cutoff, const frequency<_Rep2, _Period2>& __rate,
+                           double __q = 0.70710678118654752440)
+    {
+        const __design __d(__cutoff, __rate, __q);
+        return biquad((1 + __d.__cos_) / 2, -(1 + __d.__cos_), (1 + __d.__cos_) / 2,
+                      1 + __d.__alpha_, -2 * __d.__cos_, 1 - __d.__alpha_);
+    }
+
+    // Unity gain at the centre frequency.
+    template <class _Rep1, class _Period1, class _Rep2, class _Period2>
+    static biquad bandpass(const frequency<_Rep1, _Period1>& __centre, const frequency<_Rep2, _Period2>& __rate, double __q)
+    {
+        const __design __d(__centre, __rate, __q);
+        return biquad(__d.__alpha_, 0, -__d.__alpha_, 1 + __d.__alpha_, -2 * __d.__cos_, 1 - __d.__alpha_);
+    }
+
+    // Rejects the centre frequency, mains hum for instance.
+    template <class _Rep1, class _Period1, class _Rep2, class _Period2>
+    static biquad notch(const frequency<_Rep1, _Period1>& __centre, const frequency<_Rep2, _Period2>& __rate, double __q)
+    {
+        const __design __d(__centre, __rate, __q);
+        return biquad(1, -2 * __d.__cos_, 1, 1 + __d.__alpha_, -2 * __d.__cos_, 1 - __d.__alpha_);
+    }
+
+    inline void reset() {__primed_ = false;}
+
+    inline void reset(const _Metric& __m)
+    {
+        const double __x = static_cast<double>(__m.count());
+        const double __y = __x * (__b0_ + __b1_ + __b2_) / (1 + __a1_ + __a2_);
+        __s2_ = __b2_ * __x - __a2_ * __y;
+        __s1_ = __b1_ * __x - __a1_ * __y + __s2_;
+        __primed_ = true;
+    }
+
+    inline _Metric operator()(const _Metric& __m)
+    {
+        if (!__primed_)
+            reset(__m);
+        return __filter_out<_Metric>::__apply(__step(static_cast<double>(__m.count()), __s1_, __s2_));
+    }
+
+    template <class _InputIterator, class _OutputIterator>
+    _OutputIterator process(_InputIterator __first, _InputIterator __last, _OutputIterator __out)
+    {
+        if (__first == __last)
+            return __out;
+        if (!__primed_)
+            reset(*__first);
+        double __s1 = __s1_, __s2 = __s2_;
+        for (; __first != __last; ++__first, (void) ++__out)
+            *__out = __filter_out<_Metric>::__apply(__step(static_cast<double>((*__first).count()), __s1, __s2));
+        __s1_ = __s1;
+        __s2_ = __s2;
+        return __out;
+    }
+};
+
+
+// Dot product of two arrays of doubles, on four lanes of AVX when available.
+inline double __filter_dot(const double* __x, const double* __h, std::size_t __n)
+{
+    std::size_t __i = 0;
+    double __s = 0;
+#if defined(__AVX__)
+    __m256d __v0 = _mm256_setzero_pd(), __v1 = _mm256_setzero_pd();
+    for (; __i + 8 <= __n; __i += 8)
+    {
+        __v0 = _mm256_add_pd(__v0, _mm256_mul_pd(_mm256_loadu_pd(__x + __i),     _mm256_loadu_pd(__h + __i)));
+        __v1 = _mm256_add_pd(__v1, _mm256_mul_pd(_mm256_loadu_pd(__x + __i + 4), _mm256_loadu_pd(__h + __i + 4)));
+    }
+    alignas(32) double __l[4];
+    _mm256_store_pd(__l, _mm256_add_pd(__v0, __v1));
+    __s = (__l[0] + __l[1]) + (__l[2] + __l[3]);
+#else
+    // Independent partial sums, so the loop gets vectorized.
+    double __p[4] = {0, 0, 0, 0};
+    for (; __i + 4 <= __n; __i += 4)
+        for (int __l = 0; __l < 4; ++__l)
+            __p[__l] += __x[__i + __l] * __h[__i + __l];
+    __s = (__p[0] + __p[1]) + (__p[2] + __p[3]);
+#endif
+    for (; __i < __n; ++__i)
+        __s += __x[__i] * __h[__i];
+    return __s;
+}
+
+
+// Windowed sinc (Blackman) low pass followed by decimation: one output every __factor inputs,
+// and only those outputs are computed.  The input is kept in a linear buffer of doubles so each
+// output is a single contiguous dot product with the reversed taps.  For a clean decimation the
+// cutoff should be below rate / (2 __factor).
+template <class _Metric>
+class fir_decimator
+{
+    static const std::size_t __block = 1024;
+
+    std::vector<double> __taps_;      // Reversed: the oldest sample is multiplied by the first.
+    std::vector<double> __buf_;
+    std::size_t         __size_;      // Samples in __buf_.
+    std::size_t         __factor_;
+    std::size_t         __phase_;
+    bool                __primed_;
+
+    inline void __append(double __x)
+    {
+        if (__size_ == __buf_.size())
+        {
+            const std::size_t __keep = __taps_.size() - 1;
+            std::memmove(__buf_.data(), __buf_.data() + __size_ - __keep, __keep * sizeof(double));
+            __size_ = __keep;
+        }
+        __buf_[__size_++] = __x;
+    }
+
+public:
+    typedef _Metric metric_type;
+
+    template <class _Rep1, class _Period1, class _Rep2, class _Period2>
+    fir_decimator(const frequency<_Rep1, _Period1>& __cutoff, const frequency<_Rep2, _Period2>& __rate,
+                  std::size_t __factor, std::size_t __taps = 31)
+        : __taps_(__taps), __buf_(__taps + __block), __size_(0), __factor_(__factor), __phase_(0), __primed_(false)
+    {
+        if (__factor == 0 || __taps == 0)
+            throw std::invalid_argument("metric filter: the decimation factor and the number of taps must be positive");
+        const double __fc = __filter_cutoff(__cutoff, __rate);
+        const double __m = static_cast<double>(__taps - 1);
+        double __sum = 0;
+        for (std::size_t __k = 0; __k < __taps; ++__k)
+        {
+            const double __t = static_cast<double>(__k) - __m / 2;
+            const double __sinc = __t == 0 ? 2 * __fc : std::sin(2 * __filter_pi * __fc * __t) / (__filter_pi * __t);
+            const double __w = __taps == 1 ? 1 : 0.42 - 0.5 * std::cos(2 * __filter_pi * __k / __m) + 0.08 * std::cos(4 * __filter_pi * __k / __m);
+            __taps_[__taps - 1 - __k] = __sinc * __w;
+            __sum += __sinc * __w;
+        }
+        for (std::size_t __k = 0; __k < __taps; ++__k)
+            __taps_[__k] /= __sum;     // Unity gain for a constant signal.
+    }
+
+    inline std::size_t factor() const {return __factor_;}
+    inline const std::vector<double>& taps() const {return __taps_;}
+
+    inline void reset() {__primed_ = false; __phase_ = 0;}
+
+    inline void reset(const _Metric& __m)
+    {
+        __size_ = 0;
+        for (std::size_t __k = 1; __k < __taps_.size(); ++__k)
+            __buf_[__size_++] = static_cast<double>(__m.count());
+        __phase_ = 0;
+        __primed_ = true;
+    }
+
+    // Feeds a sample; every __factor samples, writes the filtered one to __out and returns true.
+    inline bool push(const _Metric& __m, _Metric& __out)
+    {
+        if (!__primed_)
+            reset(__m);
+        __append(static_cast<double>(__m.count()));
+        if (++__phase_ != __factor_)
+            return false;
+        __phase_ = 0;
+        __out = __filter_out<_Metric>::__apply(__filter_dot(__buf_.data() + __size_ - __taps_.size(), __taps_.data(), __taps_.size()));
+        return true;
+    }
+
+    // Writes one output for every __factor inputs, counting from the samples fed before.
+    template <class _InputIterator, class _OutputIterator>
+    _OutputIterator process(_InputIterator __first, _InputIterator __last, _OutputIterator __out)
+    {
+        _Metric __y;
+        for (; __first != __last; ++__first)
+            if (push(*__first, __y))
+            {
+                *__out = __y;
+                ++__out;
+            }
+        return __out;
+    }
+};
+
+template <class _Metric>
+const std::size_t fir_decimator<_Metric>::__block;
+
+} // namespace metric
+
+#endif // METRICS_FILTER_HPP
@@ -0,0 +1,253 @@
+// -*- C++ -*-
+//
+//===---------------------------- groupby ---------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_GROUPBY_HPP
+#define METRICS_GROUPBY_HPP
+
+#include "metric_config.hpp"
+#include "metric_algorithm.hpp"
+#include "metric_hash.hpp"
+#include "metric_parallel.hpp"
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace metric {
+
+// Aggregates of one metric column over the rows of a group.  The sum has the wide
+// representation of metric::sum, the mean the one of metric::mean.
+template <class _Metric>
+class column_aggregate
+{
+public:
+    typedef _Metric metric_type;
+    typedef typename __rebind_rep<_Metric, typename __sum_rep<typename _Metric::rep>::type>::type sum_type;
+    typedef typename __rebind_rep<_Metric, typename __mean_rep<typename _Metric::rep>::type>::type mean_type;
+
+private:
+    typename sum_type::rep __sum_;
+    typename _Metric::rep  __min_;
+    typename _Metric::rep  __max_;
+
+public:
+    inline explicit column_aggregate(const _Metric& __m)
+        : __sum_(__m.count()), __min_(__m.count()), __max_(__m.count()) {}
+
+    inline void __add(const _Metric& __m)
+    {
+        __sum_ += __m.count();
+        __min_ = __m.count() < __min_ ? __m.count() : __min_;
+        __max_ = __m.count() > __max_ ? __m.count() : __max_;
+    }
+
+    inline sum_type sum() const {return sum_type(__sum_);}
+    inline _Metric minimum() const {return _Metric(__min_);}
+    inline _Metric maximum() const {return _Metric(__max_);}
+
+    inline mean_type mean(std::size_t __count) const
+    {
+        typedef typename mean_type::rep _Rp;
+        return mean_type(static_cast<_Rp>(__sum_) / static_cast<_Rp>(__count));
+    }
+};
+
+// A key, its number of rows, and the aggregates of each metric column.
+template <class _Key, class... _Metrics>
+struct group
+{
+    typedef _Key key_type;
+    typedef std::tuple<column_aggregate<_Metrics>...> columns_type;
+
+    _Key         key;
+    std::size_t  count;
+    columns_type columns;
+
+    template <std::size_t _Ip>
+    inline const typename std::tuple_element<_Ip, columns_type>::type& column() const {return std::get<_Ip>(columns);}
+
+    template <std::size_t _Ip>
+    inline typename std::tuple_element<_Ip, columns_type>::type::sum_type sum() const {return column<_Ip>().sum();}
+
+    template <std::size_t _Ip>
+    inline typename std::tuple_element<_Ip, columns_type>::type::metric_type minimum() const {return column<_Ip>().minimum();}
+
+    template <std::size_t _Ip>
+    inline typename std::tuple_element<_Ip, columns_type>::type::metric_type maximum() const {return column<_Ip>().maximum();}
+
+    template <std::size_t _Ip>
+    inline typename std::tuple_element<_Ip, columns_type>::type::mean_type mean() const {return column<_Ip>().mean(count);}
+};
+
+template <class _KeyIterator, class... _ColumnIterators>
+struct __group_by_result
+{
+    typedef std::vector<group<typename std::iterator_traits<_KeyIterator>::value_type,
+                              typename std::iterator_traits<_ColumnIterators>::value_type...> > type;
+};
+
+// std::hash of the key.  Pass an other hasher as first template argument of group_by for keys
+// without std::hash.
+struct default_key_hash
+{
+    template <class _Key>
+    inline std::size_t operator()(const _Key& __k) const {return std::hash<_Key>()(__k);}
+};
+
+// Key hashes are mixed: the top bits pick the partition, the low bits the slot.
+template <class _KeyHash>
+struct __group_hash
+{
+    template <class _Key>
+    inline std::size_t operator()(const _Key& __k) const {return __hash_mix(_KeyHash()(__k));}
+};
+
+static const unsigned    __groupby_radix_bits = 8;
+static const std::size_t __groupby_partitions = std::size_t(1) << __groupby_radix_bits;
+
+inline std::size_t __groupby_partition(std::size_t __h)
+{
+    return __h >> (std::numeric_limits<std::size_t>::digits - __groupby_radix_bits);
+}
+
+struct __groupby_row
+{
+    std::size_t __row_;
+    std::size_t __hash_;
+};
+
+template <class _Group, class _KeyIterator, class _Columns, std::size_t... _Ip>
+inline _Group __group_first(_KeyIterator __keys, const _Columns& __cols, std::size_t __row, __index_sequence<_Ip...>)
+{
+    _Group __g = {*(__keys + __row), 1, typename _Group::columns_type(
+        typename std::tuple_element<_Ip, typename _Group::columns_type>::type(*(std::get<_Ip>(__cols) + __row))...)};
+    return __g;
+}
+
+template <class _Group, class _Columns, std::size_t... _Ip>
+inline void __group_add(_Group& __g, const _Columns& __cols, std::size_t __row, __index_sequence<_Ip...>)
+{
+    ++__g.count;
+    int __expand[] = {0, (std::get<_Ip>(__g.columns).__add(*(std::get<_Ip>(__cols) + __row)), 0)...};
+    (void) __expand; (void) __cols; (void) __row;   // Without metric columns.
+}
+
+
+// Radix partitioned hash aggregation.  The rows are cut in chunks, the chunks are scattered by
+// the top bits of the key hashes into 256 partitions, each aggregated on its own in a flat hash
+// table small enough to stay in cache.  Chunks and partitions are spread over the executor.
+// Each group is aggregated in row order, so the results never depend on the number of threads;
+// groups come partition by partition, in order of first appearance within a partition.
+template <class _KeyHash = default_key_hash, class _KeyIterator, class... _ColumnIterators>
+typename __group_by_result<_KeyIterator, _ColumnIterators...>::type
+parallel_group_by(executor& __exec, _KeyIterator __first, _KeyIterator __last, _ColumnIterators... __columns)
+{
+    typedef typename __group_by_result<_KeyIterator, _ColumnIterators...>::type _Result;
+    typedef typename _Result::value_type _Group;
+    typedef typename std::iterator_traits<_KeyIterator>::value_type _Key;
+    typedef __group_hash<_KeyHash> _Hash;
+    typedef typename __make_index_sequence<sizeof...(_ColumnIterators)>::type _Columns;
+
+    const std::tuple<_ColumnIterators...> __cols(__columns...);
+    const std::size_t __n = static_cast<std::size_t>(__last - __first);
+    const std::size_t __chunks = __chunk_count(__n);
+    const std::size_t __parts = __groupby_partitions;
+
+    // Rows of each chunk in each partition, then where they go.
+    std::vector<std::size_t> __offsets(__chunks * __parts, 0);
+    __exec.bulk(__chunks, [&](std::size_t __c)
+    {
+        const std::size_t __b = __c * __parallel_grain;
+        const std::size_t __e = __n - __b < __parallel_grain ? __n : __b + __parallel_grain;
+        std::size_t* __hist = &__offsets[__c * __parts];
+        for (std::size_t __i = __b; __i != __e; ++__i)
+            ++__hist[__groupby_partition(_Hash()(*(__first + __i)))];
+    });
+    std::vector<std::size_t> __part_begin(__parts + 1, __n);
+    std::size_t __total = 0;
+    for (std::size_t __p = 0; __p < __parts; ++__p)
+    {
+        __part_begin[__p] = __total;
+        for (std::size_t __c = 0; __c < __chunks; ++__c)
+        {
+            const std::size_t __k = __offsets[__c * __parts + __p];
+            __offsets[__c * __parts + __p] = __total;
+            __total += __k;
+        }
+    }
+
+    std::vector<__groupby_row> __rows(__n);
+    __exec.bulk(__chunks, [&](std::size_t __c)
+    {
+        const std::size_t __b = __c * __parallel_grain;
+        const std::size_t __e = __n - __b < __parallel_grain ? __n : __b + __parallel_grain;
+        std::size_t* __next = &__offsets[__c * __parts];
+        for (std::size_t __i = __b; __i != __e; ++__i)
+        {
+            const __groupby_row __r = {__i, _Hash()(*(__first + __i))};
+            __rows[__next[__groupby_partition(__r.__hash_)]++] = __r;
+        }
+    });
+
+    std::vector<_Result> __results(__parts);
+    __exec.bulk(__parts, [&](std::size_t __p)
+    {
+        flat_hash_map<_Key, std::size_t, _Hash, std::equal_to<_Key> > __index;
+        _Result& __out = __results[__p];
+        for (std::size_t __r = __part_begin[__p]; __r != __part_begin[__p + 1]; ++__r)
+        {
+            const std::size_t __row = __rows[__r].__row_;
+            const _Key& __k = *(__first + __row);
+            const std::pair<typename flat_hash_map<_Key, std::size_t, _Hash, std::equal_to<_Key> >::iterator, bool>
+                __ins = __index.__emplace_hashed(__rows[__r].__hash_, __k, __k, __out.size());
+            if (__ins.second)
+                __out.push_back(__group_first<_Group>(__first, __cols, __row, _Columns()));
+            else
+                __group_add(__out[__ins.first->second], __cols, __row, _Columns());
+        }
+    });
+
+    _Result __groups;
+    std::size_t __count = 0;
+    for (std::size_t __p = 0; __p < __parts; ++__p)
+        __count += __results[__p].size();
+    __groups.reserve(__count);
+    for (std::size_t __p = 0; __p < __parts; ++__p)
+        for (std::size_t __i = 0; __i < __results[__p].size(); ++__i)
+            __groups.push_back(std::move(__results[__p][__i]));
+    return __groups;
+}
+
+template <class _KeyHash = default_key_hash, class _KeyIterator, class... _ColumnIterators>
+inline
+typename __group_by_result<_KeyIterator, _ColumnIterators...>::type
+parallel_group_by(_KeyIterator __first, _KeyIterator __last, _ColumnIterators... __columns)
+{
+    return metric::parallel_group_by<_KeyHash>(default_executor(), __first, __last, __columns...);
+}
+
+// Same groups, computed on the calling thread.
+template <class _KeyHash = default_key_hash, class _KeyIterator, class... _ColumnIterators>
+inline
+typename __group_by_result<_KeyIterator, _ColumnIterators...>::type
+group_by(_KeyIterator __first, _KeyIterator __last, _ColumnIterators... __columns)
+{
+    sequential_executor __seq;
+    return metric::parallel_group_by<_KeyHash>(__seq, __first, __last, __columns...);
+}
+
+} // namespace metric
+
+#endif // METRICS_GROUPBY_HPP
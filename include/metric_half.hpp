@@ -0,0 +1,301 @@
+// -*- C++ -*-
+//
+//===---------------------------- half ------------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_HALF_HPP
+#define METRICS_HALF_HPP
+
+#include "metric_config.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__F16C__) || defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace metric {
+
+inline unsigned int __float_bits(float __f)
+{
+    unsigned int __x;
+    std::memcpy(&__x, &__f, sizeof(__x));
+    return __x;
+}
+
+inline float __bits_float(unsigned int __x)
+{
+    float __f;
+    std::memcpy(&__f, &__x, sizeof(__f));
+    return __f;
+}
+
+// IEEE 754 binary16: 5 exponent bits, 10 mantissa bits.  Conversions round to nearest even.
+struct __binary16_format
+{
+    static const unsigned short __max_bits    = 0x7bff;    // 65504
+    static const unsigned short __lowest_bits = 0xfbff;
+
+    static unsigned short __narrow(float __f)
+    {
+#if defined(__F16C__)
+        return static_cast<unsigned short>(_cvtss_sh(__f, _MM_FROUND_TO_NEAREST_INT));
+#else
+        const unsigned int __x = __float_bits(__f);
+        const unsigned int __sign = (__x >> 16) & 0x8000;
+        const unsigned int __ax = __x & 0x7fffffff;
+        if (__ax >= 0x7f800000)                                // Infinity, NaN (kept quiet).
+            return static_cast<unsigned short>(__sign | (__ax > 0x7f800000 ? 0x7e00 : 0x7c00));
+        if (__ax >= 0x477ff000)                                // Rounds beyond 65504.
+            return static_cast<unsigned short>(__sign | 0x7c00);
+        if (__ax < 0x38800000)                                 // Subnormal, or zero.
+        {
+            if (__ax <= 0x33000000)
+                return static_cast<unsigned short>(__sign);
+            const unsigned int __m = (__ax & 0x7fffff) | 0x800000;
+            const unsigned int __shift = 126 - (__ax >> 23);
+            const unsigned int __rem = __m & ((1u << __shift) - 1);
+            const unsigned int __half = 1u << (__shift - 1);
+            unsigned int __r = __m >> __shift;
+            if (__rem > __half || (__rem == __half && (__r & 1)))
+                ++__r;
+            return static_cast<unsigned short>(__sign | __r);
+        }
+        unsigned int __r = (__ax - 0x38000000) >> 13;
+        const unsigned int __rem = __ax & 0x1fff;
+        if (__rem > 0x1000 || (__rem == 0x1000 && (__r & 1)))
+            ++__r;
+        return static_cast<unsigned short>(__sign | __r);
+#endif
+    }
+
+    static float __widen(unsigned short __h)
+    {
+#if defined(__F16C__)
+        return _cvtsh_ss(__h);
+#else
+        const unsigned int __sign = static_cast<unsigned int>(__h & 0x8000) << 16;
+        const unsigned int __e = (__h >> 10) & 0x1f;
+        const unsigned int __m = __h & 0x3ff;
+        if (__e == 0)
+        {
+            const float __f = std::ldexp(static_cast<float>(__m), -24);
+            return __sign ? -__f : __f;
+        }
+        if (__e == 31)
+            return __bits_float(__sign | 0x7f800000 | (__m << 13));
+        return __bits_float(__sign | ((__e + 112) << 23) | (__m << 13));
+#endif
+    }
+};
+
+// bfloat16: the upper half of a float, 8 exponent bits and 7 mantissa bits.
+struct __bfloat16_format
+{
+    static const unsigned short __max_bits    = 0x7f7f;    // ~3.39e38
+    static const unsigned short __lowest_bits = 0xff7f;
+
+    static unsigned short __narrow(float __f)
+    {
+        const unsigned int __x = __float_bits(__f);
+        if ((__x & 0x7fffffff) > 0x7f800000)
+            return static_cast<unsigned short>((__x >> 16) | 0x40);
+        return static_cast<unsigned short>((__x + 0x7fff + ((__x >> 16) & 1)) >> 16);
+    }
+
+    static float __widen(unsigned short __h) {return __bits_float(static_cast<unsigned int>(__h) << 16);}
+};
+
+
+// 16-bit floating point storage.  Values convert implicitly to float, where all the arithmetic
+// is done, and from any arithmetic type, rounding to nearest even.
+template <class _Format>
+class __half_float
+{
+    unsigned short __bits_;
+
+public:
+    __half_float() = default;
+
+    template <class _Tp, typename std::enable_if<std::is_arithmetic<_Tp>::value, int>::type = 0>
+    inline __half_float(const _Tp& __v) : __bits_(_Format::__narrow(static_cast<float>(__v))) {}
+
+    inline operator float() const {return _Format::__widen(__bits_);}
+
+    inline static __half_float from_bits(unsigned short __b) {__half_float __h; __h.__bits_ = __b; return __h;}
+    inline unsigned short bits() const {return __bits_;}
+
+    inline __half_float& operator+=(float __v) {return *this = float(*this) + __v;}
+    inline __half_float& operator-=(float __v) {return *this = float(*this) - __v;}
+    inline __half_float& operator*=(float __v) {return *this = float(*this) * __v;}
+    inline __half_float& operator/=(float __v) {return *this = float(*this) / __v;}
+    inline __half_float& operator++() {return *this += 1.0f;}
+    inline __half_float  operator++(int) {__half_float __t(*this); *this += 1.0f; return __t;}
+    inline __half_float& operator--() {return *this -= 1.0f;}
+    inline __half_float  operator--(int) {__half_float __t(*this); *this -= 1.0f; return __t;}
+};
+
+typedef __half_float<__binary16_format> float16;
+typedef __half_float<__bfloat16_format> bfloat16;
+
+template <class _Format> struct treat_as_floating_point<__half_float<_Format> > : std::true_type {};
+template <class _Format> struct __is_scalar_rep<__half_float<_Format> > : std::true_type {};
+
+template <class _Format>
+struct limits_values<__half_float<_Format> >
+{
+public:
+    inline static __half_float<_Format> zero() {return __half_float<_Format>::from_bits(0);}
+    inline static __half_float<_Format> max()  {return __half_float<_Format>::from_bits(_Format::__max_bits);}
+    inline static __half_float<_Format> min()  {return __half_float<_Format>::from_bits(_Format::__lowest_bits);}
+};
+
+template <class _Tp, bool = std::is_arithmetic<_Tp>::value>
+struct __half_common
+{
+};
+
+// Mixed with an other type, the arithmetic is done in float or wider.
+template <class _Tp>
+struct __half_common<_Tp, true>
+{
+    typedef typename std::common_type<float, _Tp>::type type;
+};
+
+
+// Conversion kernels.
+
+inline void __narrow_counts(const float* __p, std::size_t __n, float16* __out)
+{
+    std::size_t __i = 0;
+#if defined(__AVX512F__)
+    for (; __i + 16 <= __n; __i += 16)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(__out + __i),
+                            _mm512_cvtps_ph(_mm512_loadu_ps(__p + __i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+#endif
+#if defined(__F16C__)
+    for (; __i + 8 <= __n; __i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(__out + __i),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(__p + __i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+    for (; __i < __n; ++__i)
+        __out[__i] = float16(__p[__i]);
+}
+
+inline void __widen_counts(const float16* __p, std::size_t __n, float* __out)
+{
+    std::size_t __i = 0;
+#if defined(__AVX512F__)
+    for (; __i + 16 <= __n; __i += 16)
+        _mm512_storeu_ps(__out + __i, _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(__p + __i))));
+#endif
+#if defined(__F16C__)
+    for (; __i + 8 <= __n; __i += 8)
+        _mm256_storeu_ps(__out + __i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(__p + __i))));
+#endif
+    for (; __i < __n; ++__i)
+        __out[__i] = float(__p[__i]);
+}
+
+inline void __narrow_counts(const float* __p, std::size_t __n, bfloat16* __out)
+{
+    std::size_t __i = 0;
+#if defined(__AVX2__)
+    const __m256i __bias = _mm256_set1_epi32(0x7fff);
+    const __m256i __one = _mm256_set1_epi32(1);
+    const __m256i __quiet = _mm256_set1_epi32(0x40);
+    for (; __i + 8 <= __n; __i += 8)
+    {
+        const __m256 __f = _mm256_loadu_ps(__p + __i);
+        const __m256i __x = _mm256_castps_si256(__f);
+        const __m256i __lsb = _mm256_and_si256(_mm256_srli_epi32(__x, 16), __one);
+        __m256i __r = _mm256_srli_epi32(_mm256_add_epi32(__x, _mm256_add_epi32(__bias, __lsb)), 16);
+        const __m256i __nan = _mm256_castps_si256(_mm256_cmp_ps(__f, __f, _CMP_UNORD_Q));
+        __r = _mm256_blendv_epi8(__r, _mm256_or_si256(_mm256_srli_epi32(__x, 16), __quiet), __nan);
+        // Eight 16-bit values from the two 128-bit lanes, in order.
+        __r = _mm256_permute4x64_epi64(_mm256_packus_epi32(__r, __r), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(__out + __i), _mm256_castsi256_si128(__r));
+    }
+#endif
+    for (; __i < __n; ++__i)
+        __out[__i] = bfloat16(__p[__i]);
+}
+
+inline void __widen_counts(const bfloat16* __p, std::size_t __n, float* __out)
+{
+    std::size_t __i = 0;
+#if defined(__AVX2__)
+    for (; __i + 8 <= __n; __i += 8)
+    {
+        const __m256i __h = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(__p + __i)));
+        _mm256_storeu_ps(__out + __i, _mm256_castsi256_ps(_mm256_slli_epi32(__h, 16)));
+    }
+#endif
+    for (; __i < __n; ++__i)
+        __out[__i] = float(__p[__i]);
+}
+
+template <class _FromMetric, class _ToMetric>
+struct __same_layout_metrics
+    : std::integral_constant<bool,
+        std::is_same<typename _FromMetric::period, typename _ToMetric::period>::value &&
+        sizeof(_FromMetric) == sizeof(typename _FromMetric::rep) &&
+        sizeof(_ToMetric) == sizeof(typename _ToMetric::rep)> {};
+
+// Float metrics to the same metric stored on 16 bits.
+template <class _ToMetric, class _FromMetric>
+inline
+_ToMetric*
+batch_narrow(const _FromMetric* __first, const _FromMetric* __last, _ToMetric* __out)
+{
+    static_assert(__same_layout_metrics<_FromMetric, _ToMetric>::value, "batch_narrow keeps the period");
+    static_assert(std::is_same<typename _FromMetric::rep, float>::value, "batch_narrow converts from float");
+    const std::size_t __n = static_cast<std::size_t>(__last - __first);
+    __narrow_counts(reinterpret_cast<const float*>(__first), __n, reinterpret_cast<typename _ToMetric::rep*>(__out));
+    return __out + __n;
+}
+
+// 16-bit metrics to the same metric in float.
+template <class _ToMetric, class _FromMetric>
+inline
+_ToMetric*
+batch_widen(const _FromMetric* __first, const _FromMetric* __last, _ToMetric* __out)
+{
+    static_assert(__same_layout_metrics<_FromMetric, _ToMetric>::value, "batch_widen keeps the period");
+    static_assert(std::is_same<typename _ToMetric::rep, float>::value, "batch_widen converts to float");
+    const std::size_t __n = static_cast<std::size_t>(__last - __first);
+    __widen_counts(reinterpret_cast<const typename _FromMetric::rep*>(__first), __n, reinterpret_cast<float*>(__out));
+    return __out + __n;
+}
+
+} // namespace metric
+
+namespace std
+{
+    // CLASS TEMPLATE common_type SPECIALIZATIONS
+    template <class _Format1, class _Format2>
+    struct common_type<metric::__half_float<_Format1>, metric::__half_float<_Format2> >
+    {
+        typedef typename conditional<is_same<_Format1, _Format2>::value, metric::__half_float<_Format1>, float>::type type;
+    };
+
+    template <class _Format, class _Tp>
+    struct common_type<metric::__half_float<_Format>, _Tp> : metric::__half_common<_Tp>
+    {
+    };
+
+    template <class _Tp, class _Format>
+    struct common_type<_Tp, metric::__half_float<_Format> > : metric::__half_common<_Tp>
+    {
+    };
+}
+
+#endif // METRICS_HALF_HPP
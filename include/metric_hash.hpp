@@ -0,0 +1,581 @@
+// -*- C++ -*-
+//
+//===---------------------------- hash ------------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_HASH_HPP
+#define METRICS_HASH_HPP
+
+#include "metric_config.hpp"
+#include "metric_dimension.hpp"
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace metric {
+
+// Hashes are computed on the value in the unit of period 1, so metrics comparing equal in
+// different units (1_kW, 1000_W) hash equally.  Integer counts are first reduced to the exact
+// fraction count * num / den in lowest terms, which is the same for all equal values whatever
+// the periods.  Floating counts hash equally when their conversion to the unit is exact.
+
+inline std::size_t __hash_mix(unsigned long long __x)
+{
+    __x ^= __x >> 30;
+    __x *= 0xbf58476d1ce4e5b9ULL;
+    __x ^= __x >> 27;
+    __x *= 0x94d049bb133111ebULL;
+    __x ^= __x >> 31;
+    return static_cast<std::size_t>(__x);
+}
+
+inline std::size_t __hash_double(double __v)
+{
+    __v = __v == 0 ? 0.0 : __v;     // -0.0 == 0.0
+    unsigned long long __bits;
+    std::memcpy(&__bits, &__v, sizeof(__bits));
+    return __hash_mix(__bits);
+}
+
+inline unsigned long long __hash_gcd(unsigned long long __a, unsigned long long __b)
+{
+    while (__b != 0)
+    {
+        const unsigned long long __t = __a % __b;
+        __a = __b;
+        __b = __t;
+    }
+    return __a;
+}
+
+template <class _Metric,
+          bool = __cross_multipliable<typename _Metric::rep>::value>
+struct __quantity_hash_impl
+{
+    inline std::size_t operator()(const _Metric& __m) const noexcept
+    {
+        typedef typename _Metric::period _Period;
+        return __hash_double(static_cast<double>(__m.count()) * _Period::num / _Period::den);
+    }
+};
+
+#if defined(__SIZEOF_INT128__)
+template <class _Metric>
+struct __quantity_hash_impl<_Metric, true>
+{
+    inline std::size_t operator()(const _Metric& __m) const noexcept
+    {
+        typedef typename _Metric::period _Period;
+        const __cross_product_type __c = static_cast<__cross_product_type>(__m.count());
+        if (_Period::den == 1)
+            return __hash_double(static_cast<double>(__c * _Period::num));
+        const unsigned long long __g = __hash_gcd(static_cast<unsigned long long>(__c < 0 ? -__c : __c), _Period::den);
+        return __hash_double(static_cast<double>(__c / __g * _Period::num) / static_cast<double>(_Period::den / __g));
+    }
+};
+#endif
+
+// Transparent hash and equality: any metric of a kind can be looked up in a container keyed
+// by another unit of that kind.
+struct quantity_hash
+{
+    template <class _Metric>
+    inline std::size_t operator()(const _Metric& __m) const noexcept {return __quantity_hash_impl<_Metric>()(__m);}
+};
+
+struct quantity_equal
+{
+    template <class _Lhs, class _Rhs>
+    inline METRICCONSTEXPR bool operator()(const _Lhs& __lhs, const _Rhs& __rhs) const {return __lhs == __rhs;}
+};
+
+template <class _Metric>
+struct __metric_hash
+{
+    typedef _Metric argument_type;
+    typedef std::size_t result_type;
+
+    inline std::size_t operator()(const _Metric& __m) const noexcept {return __quantity_hash_impl<_Metric>()(__m);}
+};
+
+} // namespace metric
+
+namespace std
+{
+    template <class _Rep, class _Period> struct hash<metric::angularspeed<_Rep, _Period> >       : metric::__metric_hash<metric::angularspeed<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::density<_Rep, _Period> >            : metric::__metric_hash<metric::density<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::distance<_Rep, _Period> >           : metric::__metric_hash<metric::distance<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::electriccurrent<_Rep, _Period> >    : metric::__metric_hash<metric::electriccurrent<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::electricresistance<_Rep, _Period> > : metric::__metric_hash<metric::electricresistance<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::force<_Rep, _Period> >              : metric::__metric_hash<metric::force<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::frequency<_Rep, _Period> >          : metric::__metric_hash<metric::frequency<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::mass<_Rep, _Period> >               : metric::__metric_hash<metric::mass<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::power<_Rep, _Period> >              : metric::__metric_hash<metric::power<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::pressure<_Rep, _Period> >           : metric::__metric_hash<metric::pressure<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::si_pressure<_Rep, _Period> >        : metric::__metric_hash<metric::si_pressure<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::voltage<_Rep, _Period> >            : metric::__metric_hash<metric::voltage<_Rep, _Period> > {};
+    template <class _Rep, class _Period> struct hash<metric::volume<_Rep, _Period> >             : metric::__metric_hash<metric::volume<_Rep, _Period> > {};
+    template <class _Distance, class _Time> struct hash<metric::speed<_Distance, _Time> >        : metric::__metric_hash<metric::speed<_Distance, _Time> > {};
+    template <class _Power, class _Time> struct hash<metric::energy<_Power, _Time> >             : metric::__metric_hash<metric::energy<_Power, _Time> > {};
+    template <class _Volume, class _Time> struct hash<metric::flowrate<_Volume, _Time> >         : metric::__metric_hash<metric::flowrate<_Volume, _Time> > {};
+    template <class _Dimension, class _Rep, class _Period>
+    struct hash<metric::derived_quantity<_Dimension, _Rep, _Period> > : metric::__metric_hash<metric::derived_quantity<_Dimension, _Rep, _Period> > {};
+}
+
+namespace metric {
+
+// Control bytes of the flat tables: a full slot holds the low 7 bits of its hash, the other
+// states have the sign bit set.  Slots are probed a group of 16 control bytes at a time.
+static const signed char __ctrl_empty   = -128;
+static const signed char __ctrl_deleted = -2;
+static const std::size_t __group_width  = 16;
+
+struct alignas(16) __ctrl_block
+{
+    signed char __c_[16];
+};
+
+class __ctrl_group
+{
+#if defined(__SSE2__)
+    __m128i __c_;
+
+public:
+    explicit inline __ctrl_group(const __ctrl_block& __b) : __c_(_mm_load_si128(reinterpret_cast<const __m128i*>(__b.__c_))) {}
+
+    inline unsigned match(signed char __h2) const {return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(__h2), __c_)));}
+    inline unsigned match_empty() const {return match(__ctrl_empty);}
+    inline unsigned match_free() const {return static_cast<unsigned>(_mm_movemask_epi8(__c_));}
+#else
+    const signed char* __c_;
+
+public:
+    explicit inline __ctrl_group(const __ctrl_block& __b) : __c_(__b.__c_) {}
+
+    inline unsigned match(signed char __h2) const
+    {
+        unsigned __m = 0;
+        for (unsigned __i = 0; __i < __group_width; ++__i)
+            __m |= static_cast<unsigned>(__c_[__i] == __h2) << __i;
+        return __m;
+    }
+    inline unsigned match_empty() const {return match(__ctrl_empty);}
+    inline unsigned match_free() const
+    {
+        unsigned __m = 0;
+        for (unsigned __i = 0; __i < __group_width; ++__i)
+            __m |= static_cast<unsigned>(__c_[__i] < 0) << __i;
+        return __m;
+    }
+#endif
+};
+
+inline unsigned __lowest_bit(unsigned __m)
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned>(__builtin_ctz(__m));
+#else
+    unsigned __i = 0;
+    for (; (__m & 1) == 0; __m >>= 1)
+        ++__i;
+    return __i;
+#endif
+}
+
+struct __key_identity
+{
+    template <class _Value>
+    inline const _Value& operator()(const _Value& __v) const {return __v;}
+};
+
+struct __key_first
+{
+    template <class _Pair>
+    inline const typename _Pair::first_type& operator()(const _Pair& __p) const {return __p.first;}
+};
+
+
+// Open addressing table shared by flat_hash_map and flat_hash_set.  Groups are probed in
+// triangular order, which visits every group of a power of two table.  The table grows when
+// 7/8 of the slots are used; erased slots of a group that still has an empty slot become
+// empty again, the others are tombstones, cleaned up when the table grows.
+template <class _Key, class _Value, class _KeyOf, class _Hash, class _Eq>
+class __flat_table
+{
+public:
+    typedef _Key key_type;
+    typedef _Value value_type;
+    typedef std::size_t size_type;
+    typedef _Hash hasher;
+    typedef _Eq key_equal;
+
+    template <bool _Const>
+    class __iterator
+    {
+        friend class __flat_table;
+
+        typedef typename std::conditional<_Const, const __flat_table*, __flat_table*>::type __table_pointer;
+
+        __table_pointer __t_;
+        std::size_t     __i_;
+
+        inline __iterator(__table_pointer __t, std::size_t __i) : __t_(__t), __i_(__i) {__skip();}
+
+        inline void __skip()
+        {
+            while (__i_ < __t_->__capacity_ && __t_->__ctrl(__i_) < 0)
+                ++__i_;
+        }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef _Value value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<_Const, const _Value*, _Value*>::type pointer;
+        typedef typename std::conditional<_Const, const _Value&, _Value&>::type reference;
+
+        inline __iterator() : __t_(nullptr), __i_(0) {}
+        template <bool _C2, class = typename std::enable_if<_Const && !_C2>::type>
+        inline __iterator(const __iterator<_C2>& __o) : __t_(__o.__t_), __i_(__o.__i_) {}
+
+        inline reference operator*() const {return __t_->__slots_[__i_];}
+        inline pointer operator->() const {return __t_->__slots_ + __i_;}
+        inline __iterator& operator++() {++__i_; __skip(); return *this;}
+        inline __iterator operator++(int) {__iterator __r(*this); ++*this; return __r;}
+
+        inline bool operator==(const __iterator& __o) const {return __i_ == __o.__i_;}
+        inline bool operator!=(const __iterator& __o) const {return __i_ != __o.__i_;}
+
+        template <bool> friend class __iterator;
+    };
+
+    typedef __iterator<false> iterator;
+    typedef __iterator<true>  const_iterator;
+
+private:
+    std::vector<__ctrl_block> __ctrl_;
+    _Value*                   __slots_;
+    std::size_t               __capacity_;
+    std::size_t               __size_;
+    std::size_t               __growth_left_;
+    std::allocator<_Value>    __alloc_;
+
+    static const std::size_t __npos = static_cast<std::size_t>(-1);
+
+    inline signed char& __ctrl(std::size_t __i) {return __ctrl_[__i / __group_width].__c_[__i % __group_width];}
+    inline signed char __ctrl(std::size_t __i) const {return __ctrl_[__i / __group_width].__c_[__i % __group_width];}
+
+    static inline std::size_t __h1(std::size_t __h) {return __h >> 7;}
+    static inline signed char __h2(std::size_t __h) {return static_cast<signed char>(__h & 0x7f);}
+    static inline std::size_t __max_load(std::size_t __capacity) {return __capacity - __capacity / 8;}
+
+    template <class _K2>
+    std::size_t __find(const _K2& __k, std::size_t __h) const
+    {
+        if (__capacity_ == 0)
+            return __npos;
+        const std::size_t __mask = __capacity_ / __group_width - 1;
+        std::size_t __g = __h1(__h) & __mask;
+        for (std::size_t __step = 1; ; __g = (__g + __step++) & __mask)
+        {
+            const __ctrl_group __grp(__ctrl_[__g]);
+            for (unsigned __m = __grp.match(__h2(__h)); __m != 0; __m &= __m - 1)
+            {
+                const std::size_t __i = __g * __group_width + __lowest_bit(__m);
+                if (_Eq()(_KeyOf()(__slots_[__i]), __k))
+                    return __i;
+            }
+            if (__grp.match_empty() != 0)
+                return __npos;
+        }
+    }
+
+    // First free slot on the probe sequence of __h.  The table has one.
+    std::size_t __find_free(std::size_t __h) const
+    {
+        const std::size_t __mask = __capacity_ / __group_width - 1;
+        std::size_t __g = __h1(__h) & __mask;
+        for (std::size_t __step = 1; ; __g = (__g + __step++) & __mask)
+        {
+            const unsigned __m = __ctrl_group(__ctrl_[__g]).match_free();
+            if (__m != 0)
+                return __g * __group_width + __lowest_bit(__m);
+        }
+    }
+
+    void __allocate(std::size_t __capacity)
+    {
+        __ctrl_block __empty;
+        std::memset(__empty.__c_, static_cast<unsigned char>(__ctrl_empty), sizeof(__empty.__c_));
+        __ctrl_.assign(__capacity / __group_width, __empty);
+        __slots_ = __capacity ? __alloc_.allocate(__capacity) : nullptr;
+        __capacity_ = __capacity;
+        __size_ = 0;
+        __growth_left_ = __max_load(__capacity);
+    }
+
+    void __release()
+    {
+        for (std::size_t __i = 0; __i < __capacity_; ++__i)
+            if (__ctrl(__i) >= 0)
+                __slots_[__i].~_Value();
+        if (__slots_)
+            __alloc_.deallocate(__slots_, __capacity_);
+        __slots_ = nullptr;
+        __ctrl_.clear();
+        __capacity_ = __size_ = __growth_left_ = 0;
+    }
+
+    void __rehash(std::size_t __capacity)
+    {
+        std::vector<__ctrl_block> __old_ctrl;
+        __old_ctrl.swap(__ctrl_);
+        _Value* const __old_slots = __slots_;
+        const std::size_t __old_capacity = __capacity_;
+        __allocate(__capacity);
+        for (std::size_t __i = 0; __i < __old_capacity; ++__i)
+            if (__old_ctrl[__i / __group_width].__c_[__i % __group_width] >= 0)
+            {
+                __place(_Hash()(_KeyOf()(__old_slots[__i])), std::move(__old_slots[__i]));
+                __old_slots[__i].~_Value();
+            }
+        if (__old_slots)
+            __alloc_.deallocate(__old_slots, __old_capacity);
+    }
+
+    template <class... _Args>
+    std::size_t __place(std::size_t __h, _Args&&... __args)
+    {
+        const std::size_t __i = __find_free(__h);
+        if (__ctrl(__i) == __ctrl_empty)
+            --__growth_left_;
+        ::new (static_cast<void*>(__slots_ + __i)) _Value(std::forward<_Args>(__args)...);
+        __ctrl(__i) = __h2(__h);
+        ++__size_;
+        return __i;
+    }
+
+    inline void __grow()
+    {
+        // Many tombstones: rehash in place, otherwise double.
+        __rehash(__capacity_ == 0 ? __group_width : __size_ * 2 < __max_load(__capacity_) ? __capacity_ : __capacity_ * 2);
+    }
+
+public:
+    inline __flat_table() : __slots_(nullptr), __capacity_(0), __size_(0), __growth_left_(0) {}
+
+    __flat_table(const __flat_table& __o) : __slots_(nullptr), __capacity_(0), __size_(0), __growth_left_(0)
+    {
+        reserve(__o.__size_);
+        for (const_iterator __i = __o.begin(); __i != __o.end(); ++__i)
+            __place(_Hash()(_KeyOf()(*__i)), *__i);
+    }
+
+    inline __flat_table(__flat_table&& __o) noexcept
+        : __ctrl_(std::move(__o.__ctrl_)), __slots_(__o.__slots_), __capacity_(__o.__capacity_),
+          __size_(__o.__size_), __growth_left_(__o.__growth_left_)
+    {
+        __o.__ctrl_.clear();
+        __o.__slots_ = nullptr;
+        __o.__capacity_ = __o.__size_ = __o.__growth_left_ = 0;
+    }
+
+    inline __flat_table& operator=(__flat_table __o) noexcept {swap(__o); return *this;}
+
+    inline ~__flat_table() {__release();}
+
+    inline void swap(__flat_table& __o) noexcept
+    {
+        __ctrl_.swap(__o.__ctrl_);
+        std::swap(__slots_, __o.__slots_);
+        std::swap(__capacity_, __o.__capacity_);
+        std::swap(__size_, __o.__size_);
+        std::swap(__growth_left_, __o.__growth_left_);
+    }
+
+    inline iterator begin() {return iterator(this, 0);}
+    inline iterator end() {return iterator(this, __capacity_);}
+    inline const_iterator begin() const {return const_iterator(this, 0);}
+    inline const_iterator end() const {return const_iterator(this, __capacity_);}
+
+    inline std::size_t size() const {return __size_;}
+    inline bool empty() const {return __size_ == 0;}
+    inline std::size_t capacity() const {return __capacity_;}
+
+    inline void clear() {__release();}
+
+    // Makes room for __n elements without growing.
+    void reserve(std::size_t __n)
+    {
+        std::size_t __c = __group_width;
+        while (__max_load(__c) < __n)
+            __c *= 2;
+        if (__c > __capacity_)
+            __rehash(__c);
+    }
+
+    template <class _K2>
+    inline iterator find(const _K2& __k)
+    {
+        const std::size_t __i = __find(__k, _Hash()(__k));
+        return iterator(this, __i == __npos ? __capacity_ : __i);
+    }
+
+    template <class _K2>
+    inline const_iterator find(const _K2& __k) const
+    {
+        const std::size_t __i = __find(__k, _Hash()(__k));
+        return const_iterator(this, __i == __npos ? __capacity_ : __i);
+    }
+
+    template <class _K2>
+    inline bool contains(const _K2& __k) const {return __find(__k, _Hash()(__k)) != __npos;}
+
+    template <class _K2>
+    inline std::size_t count(const _K2& __k) const {return contains(__k) ? 1 : 0;}
+
+    // Inserts the value built from __args unless __k is there.  __h is _Hash()(__k).
+    template <class _K2, class... _Args>
+    std::pair<iterator, bool> __emplace_hashed(std::size_t __h, const _K2& __k, _Args&&... __args)
+    {
+        std::size_t __i = __find(__k, __h);
+        if (__i != __npos)
+            return std::pair<iterator, bool>(iterator(this, __i), false);
+        if (__growth_left_ == 0)
+            __grow();
+        __i = __place(__h, std::forward<_Args>(__args)...);
+        return std::pair<iterator, bool>(iterator(this, __i), true);
+    }
+
+    template <class _K2, class... _Args>
+    inline std::pair<iterator, bool> __emplace_key(const _K2& __k, _Args&&... __args)
+    {
+        return __emplace_hashed(_Hash()(__k), __k, std::forward<_Args>(__args)...);
+    }
+
+    inline std::pair<iterator, bool> insert(const _Value& __v) {return __emplace_key(_KeyOf()(__v), __v);}
+
+    template <class _InputIterator>
+    void insert(_InputIterator __first, _InputIterator __last)
+    {
+        for (; __first != __last; ++__first)
+            insert(*__first);
+    }
+
+    void erase(iterator __pos)
+    {
+        const std::size_t __g = __pos.__i_ / __group_width;
+        __slots_[__pos.__i_].~_Value();
+        if (__ctrl_group(__ctrl_[__g]).match_empty() != 0)
+        {
+            __ctrl(__pos.__i_) = __ctrl_empty;
+            ++__growth_left_;
+        }
+        else
+            __ctrl(__pos.__i_) = __ctrl_deleted;
+        --__size_;
+    }
+
+    template <class _K2>
+    std::size_t erase(const _K2& __k)
+    {
+        const std::size_t __i = __find(__k, _Hash()(__k));
+        if (__i == __npos)
+            return 0;
+        erase(iterator(this, __i));
+        return 1;
+    }
+};
+
+
+// Open addressing hash map for metric keys.  Lookups take any metric of the key's kind:
+// a map keyed by metric::watt finds 1_kW.
+template <class _Key, class _Tp, class _Hash = quantity_hash, class _Eq = quantity_equal>
+class flat_hash_map : public __flat_table<_Key, std::pair<const _Key, _Tp>, __key_first, _Hash, _Eq>
+{
+    typedef __flat_table<_Key, std::pair<const _Key, _Tp>, __key_first, _Hash, _Eq> __base;
+
+public:
+    typedef _Tp mapped_type;
+    typedef typename __base::iterator iterator;
+    typedef typename __base::const_iterator const_iterator;
+    typedef typename __base::value_type value_type;
+
+    inline flat_hash_map() {}
+    inline flat_hash_map(std::initializer_list<value_type> __il) {this->reserve(__il.size()); this->insert(__il.begin(), __il.end());}
+
+    using __base::insert;
+
+    template <class... _Args>
+    inline std::pair<iterator, bool> try_emplace(const _Key& __k, _Args&&... __args)
+    {
+        return this->__emplace_key(__k, std::piecewise_construct, std::forward_as_tuple(__k),
+                                   std::forward_as_tuple(std::forward<_Args>(__args)...));
+    }
+
+    inline _Tp& operator[](const _Key& __k) {return try_emplace(__k).first->second;}
+
+    template <class _K2>
+    _Tp& at(const _K2& __k)
+    {
+        iterator __i = this->find(__k);
+        if (__i == this->end())
+            throw std::out_of_range("flat_hash_map::at");
+        return __i->second;
+    }
+
+    template <class _K2>
+    const _Tp& at(const _K2& __k) const
+    {
+        const_iterator __i = this->find(__k);
+        if (__i == this->end())
+            throw std::out_of_range("flat_hash_map::at");
+        return __i->second;
+    }
+};
+
+// Open addressing hash set of metrics.  The elements are only reached through const iterators.
+template <class _Key, class _Hash = quantity_hash, class _Eq = quantity_equal>
+class flat_hash_set : public __flat_table<_Key, _Key, __key_identity, _Hash, _Eq>
+{
+    typedef __flat_table<_Key, _Key, __key_identity, _Hash, _Eq> __base;
+
+public:
+    typedef typename __base::value_type value_type;
+    typedef typename __base::const_iterator iterator;
+    typedef typename __base::const_iterator const_iterator;
+
+    inline const_iterator begin() const {return __base::begin();}
+    inline const_iterator end() const {return __base::end();}
+
+    template <class _K2>
+    inline const_iterator find(const _K2& __k) const {return __base::find(__k);}
+
+    inline flat_hash_set() {}
+    inline flat_hash_set(std::initializer_list<_Key> __il) {this->reserve(__il.size()); this->insert(__il.begin(), __il.end());}
+
+    template <class _InputIterator>
+    inline flat_hash_set(_InputIterator __first, _InputIterator __last) {this->insert(__first, __last);}
+};
+
+} // namespace metric
+
+#endif // METRICS_HASH_HPP
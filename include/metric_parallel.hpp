@@ -0,0 +1,293 @@
+// -*- C++ -*-
+//
+//===---------------------------- parallel --------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_PARALLEL_HPP
+#define METRICS_PARALLEL_HPP
+
+#include "metric_config.hpp"
+#include "metric_algorithm.hpp"
+#include "metric_batch.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace metric {
+
+// Runs __f(0) ... __f(__n - 1), possibly concurrently, and returns once all calls are done.
+// The first exception thrown by a call is rethrown to the caller.
+// Derive from it to plug an other scheduler into the parallel algorithms.
+class executor
+{
+public:
+    virtual ~executor() {}
+    virtual void bulk(std::size_t __n, const std::function<void(std::size_t)>& __f) = 0;
+};
+
+class sequential_executor : public executor
+{
+public:
+    void bulk(std::size_t __n, const std::function<void(std::size_t)>& __f)
+    {
+        for (std::size_t __i = 0; __i < __n; ++__i)
+            __f(__i);
+    }
+};
+
+// Fixed set of workers; the calling thread takes part in the work.
+// A bulk call made from inside a task runs sequentially.
+class thread_pool : public executor
+{
+    std::vector<std::thread> __workers_;
+    std::mutex __bulk_mutex_;
+    std::mutex __mutex_;
+    std::condition_variable __wake_;
+    std::condition_variable __done_;
+
+    const std::function<void(std::size_t)>* __job_;
+    std::size_t __count_;
+    std::atomic<std::size_t> __next_;
+    std::size_t __remaining_;
+    std::size_t __active_;
+    unsigned long __generation_;
+    std::exception_ptr __error_;
+    bool __stop_;
+
+    static bool& __inside_task()
+    {
+        static thread_local bool __inside = false;
+        return __inside;
+    }
+
+    // Claims and runs indices of the current job until none is left.
+    void __work(const std::function<void(std::size_t)>& __f, std::size_t __count)
+    {
+        bool& __inside = __inside_task();
+        __inside = true;
+        std::size_t __done = 0;
+        std::exception_ptr __error;
+        for (std::size_t __i; (__i = __next_.fetch_add(1)) < __count; ++__done)
+        {
+            try
+            {
+                __f(__i);
+            }
+            catch (...)
+            {
+                if (!__error)
+                    __error = std::current_exception();
+            }
+        }
+        __inside = false;
+
+        std::lock_guard<std::mutex> __lock(__mutex_);
+        if (__error && !__error_)
+            __error_ = __error;
+        __remaining_ -= __done;
+        if (__remaining_ == 0)
+            __done_.notify_all();
+    }
+
+    void __worker()
+    {
+        unsigned long __seen = 0;
+        for (;;)
+        {
+            std::unique_lock<std::mutex> __lock(__mutex_);
+            __wake_.wait(__lock, [&] {return __stop_ || (__generation_ != __seen && __remaining_ != 0);});
+            if (__stop_)
+                return;
+            __seen = __generation_;
+            const std::function<void(std::size_t)>& __f = *__job_;
+            const std::size_t __count = __count_;
+            ++__active_;
+            __lock.unlock();
+
+            __work(__f, __count);
+
+            __lock.lock();
+            if (--__active_ == 0)
+                __done_.notify_all();
+        }
+    }
+
+public:
+    explicit thread_pool(std::size_t __threads = std::thread::hardware_concurrency())
+        : __job_(nullptr), __count_(0), __next_(0), __remaining_(0), __active_(0), __generation_(0), __stop_(false)
+    {
+        // The calling thread is one of the __threads.
+        for (std::size_t __i = 1; __i < __threads; ++__i)
+            __workers_.push_back(std::thread(&thread_pool::__worker, this));
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> __lock(__mutex_);
+            __stop_ = true;
+        }
+        __wake_.notify_all();
+        for (std::size_t __i = 0; __i < __workers_.size(); ++__i)
+            __workers_[__i].join();
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    std::size_t size() const {return __workers_.size() + 1;}
+
+    void bulk(std::size_t __n, const std::function<void(std::size_t)>& __f)
+    {
+        if (__n == 0)
+            return;
+        if (__workers_.empty() || __n == 1 || __inside_task())
+        {
+            sequential_executor().bulk(__n, __f);
+            return;
+        }
+
+        std::lock_guard<std::mutex> __serial(__bulk_mutex_);
+        {
+            std::lock_guard<std::mutex> __lock(__mutex_);
+            __job_ = &__f;
+            __count_ = __n;
+            __next_.store(0);
+            __remaining_ = __n;
+            __error_ = nullptr;
+            ++__generation_;
+        }
+        __wake_.notify_all();
+
+        __work(__f, __n);
+
+        std::unique_lock<std::mutex> __lock(__mutex_);
+        // Wait for the workers to leave the job too: the next one reuses __next_.
+        __done_.wait(__lock, [&] {return __remaining_ == 0 && __active_ == 0;});
+        __job_ = nullptr;
+        std::exception_ptr __error = __error_;
+        __error_ = nullptr;
+        __lock.unlock();
+        if (__error)
+            std::rethrow_exception(__error);
+    }
+};
+
+// Pool shared by the parallel algorithms when no executor is given, with one thread per core.
+inline executor& default_executor()
+{
+    static thread_pool __pool;
+    return __pool;
+}
+
+
+// Ranges are cut in chunks of a fixed number of elements, whatever the executor or its number
+// of threads: partial results, and the order in which they are combined, never change.
+static const std::size_t __parallel_grain = std::size_t(1) << 16;
+
+inline std::size_t __chunk_count(std::size_t __n)
+{
+    return (__n + __parallel_grain - 1) / __parallel_grain;
+}
+
+
+template <class _ToMetric, class _RandomAccessIterator, class _OutputIterator>
+inline
+_OutputIterator
+parallel_batch_cast(_RandomAccessIterator __first, _RandomAccessIterator __last, _OutputIterator __out,
+                    executor& __exec = default_executor())
+{
+    const std::size_t __n = static_cast<std::size_t>(__last - __first);
+    __exec.bulk(__chunk_count(__n), [&](std::size_t __c)
+    {
+        const std::size_t __b = __c * __parallel_grain;
+        const std::size_t __e = __n - __b < __parallel_grain ? __n : __b + __parallel_grain;
+        metric::batch_cast<_ToMetric>(__first + __b, __first + __e, __out + __b);
+    });
+    return __out + __n;
+}
+
+template <class _RandomAccessIterator, class _OutputIterator, class _UnaryOperation>
+inline
+_OutputIterator
+parallel_transform(_RandomAccessIterator __first, _RandomAccessIterator __last, _OutputIterator __out,
+                   _UnaryOperation __op, executor& __exec = default_executor())
+{
+    const std::size_t __n = static_cast<std::size_t>(__last - __first);
+    __exec.bulk(__chunk_count(__n), [&](std::size_t __c)
+    {
+        const std::size_t __b = __c * __parallel_grain;
+        const std::size_t __e = __n - __b < __parallel_grain ? __n : __b + __parallel_grain;
+        _OutputIterator __o = __out + __b;
+        for (_RandomAccessIterator __i = __first + __b; __i != __first + __e; ++__i, (void) ++__o)
+            *__o = __op(*__i);
+    });
+    return __out + __n;
+}
+
+// Reduction with an associative __op: each chunk is reduced from its first element, then the
+// partial results are folded into __init in chunk order.
+template <class _RandomAccessIterator, class _Tp, class _BinaryOperation>
+inline
+_Tp
+parallel_reduce(_RandomAccessIterator __first, _RandomAccessIterator __last, _Tp __init,
+                _BinaryOperation __op, executor& __exec = default_executor())
+{
+    const std::size_t __n = static_cast<std::size_t>(__last - __first);
+    const std::size_t __chunks = __chunk_count(__n);
+    std::vector<_Tp> __partial;
+    __partial.reserve(__chunks);
+    for (std::size_t __c = 0; __c < __chunks; ++__c)
+        __partial.push_back(__init);
+    __exec.bulk(__chunks, [&](std::size_t __c)
+    {
+        const std::size_t __b = __c * __parallel_grain;
+        const std::size_t __e = __n - __b < __parallel_grain ? __n : __b + __parallel_grain;
+        _Tp __acc = _Tp(*(__first + __b));
+        for (_RandomAccessIterator __i = __first + __b + 1; __i != __first + __e; ++__i)
+            __acc = __op(__acc, *__i);
+        __partial[__c] = __acc;
+    });
+    for (std::size_t __c = 0; __c < __chunks; ++__c)
+        __init = __op(__init, __partial[__c]);
+    return __init;
+}
+
+// Parallel metric::sum: the same wide result, identical to the sequential one for integer counts.
+template <class _RandomAccessIterator>
+inline
+decltype(metric::sum(std::declval<_RandomAccessIterator>(), std::declval<_RandomAccessIterator>()))
+parallel_sum(_RandomAccessIterator __first, _RandomAccessIterator __last, executor& __exec = default_executor())
+{
+    typedef decltype(metric::sum(__first, __last)) _Rt;
+    const std::size_t __n = static_cast<std::size_t>(__last - __first);
+    const std::size_t __chunks = __chunk_count(__n);
+    std::vector<typename _Rt::rep> __partial(__chunks, typename _Rt::rep(0));
+    __exec.bulk(__chunks, [&](std::size_t __c)
+    {
+        const std::size_t __b = __c * __parallel_grain;
+        const std::size_t __e = __n - __b < __parallel_grain ? __n : __b + __parallel_grain;
+        __partial[__c] = metric::sum(__first + __b, __first + __e).count();
+    });
+    typename _Rt::rep __total(0);
+    for (std::size_t __c = 0; __c < __chunks; ++__c)
+        __total += __partial[__c];
+    return _Rt(__total);
+}
+
+} // namespace metric
+
+#endif // METRICS_PARALLEL_HPP
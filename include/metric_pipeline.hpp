@@ -0,0 +1,408 @@
+// -*- C++ -*-
+//
+//===---------------------------- pipeline --------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_PIPELINE_HPP
+#define METRICS_PIPELINE_HPP
+
+#include "metric_config.hpp"
+#include "metric_parallel.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace metric {
+
+// A stage turns each _In item into an _Out item.  The function is either
+//     _Out f(const _In&)
+// or  bool f(const _In&, _Out&)   which drops the item when returning false.
+template <class _In, class _Out>
+class stage
+{
+public:
+    typedef _In  input_type;
+    typedef _Out output_type;
+    typedef std::function<bool(const _In&, _Out&)> function_type;
+
+private:
+    std::string   __name_;
+    function_type __fn_;
+
+    template <class _Fn>
+    static auto __adapt(_Fn __fn, int)
+        -> decltype(static_cast<bool>(__fn(std::declval<const _In&>(), std::declval<_Out&>())), function_type())
+    {
+        return __fn;
+    }
+
+    template <class _Fn>
+    static function_type __adapt(_Fn __fn, long)
+    {
+        return [__fn](const _In& __in, _Out& __out) {__out = __fn(__in); return true;};
+    }
+
+public:
+    template <class _Fn>
+    stage(const std::string& __name, _Fn __fn) : __name_(__name), __fn_(__adapt(__fn, 0)) {}
+
+    const std::string& name() const {return __name_;}
+    const function_type& function() const {return __fn_;}
+};
+
+struct stage_statistics
+{
+    std::string name;
+    unsigned long long items_in;
+    unsigned long long items_out;
+    unsigned long long batches;
+    double seconds;     // Time spent in the stage, summed over the workers.
+
+    double throughput() const {return seconds > 0 ? static_cast<double>(items_in) / seconds : 0.;}
+};
+
+struct pipeline_options
+{
+    std::size_t workers;
+    std::size_t batch_size;
+    std::size_t queue_capacity;     // Batches per worker deque; a worker runs a batch itself when its deque is full.
+
+    pipeline_options()
+        : workers(std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 1),
+          batch_size(256), queue_capacity(64) {}
+};
+
+
+struct __batch_base
+{
+    virtual ~__batch_base() {}
+    virtual std::size_t size() const = 0;
+};
+
+template <class _Tp>
+struct __batch : __batch_base
+{
+    std::vector<_Tp> __items_;
+    std::size_t size() const {return __items_.size();}
+};
+
+class __stage_node
+{
+public:
+    std::string __name_;
+    std::atomic<unsigned long long> __in_;
+    std::atomic<unsigned long long> __out_;
+    std::atomic<unsigned long long> __batches_;
+    std::atomic<unsigned long long> __nanoseconds_;
+
+    explicit __stage_node(const std::string& __name)
+        : __name_(__name), __in_(0), __out_(0), __batches_(0), __nanoseconds_(0) {}
+    virtual ~__stage_node() {}
+
+    std::unique_ptr<__batch_base> __process(__batch_base& __in)
+    {
+        const std::chrono::steady_clock::time_point __start = std::chrono::steady_clock::now();
+        std::unique_ptr<__batch_base> __out = __run(__in);
+        const std::chrono::steady_clock::duration __spent = std::chrono::steady_clock::now() - __start;
+        __in_ += __in.size();
+        __out_ += __out->size();
+        ++__batches_;
+        __nanoseconds_ += static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(__spent).count());
+        return __out;
+    }
+
+    stage_statistics __statistics() const
+    {
+        stage_statistics __s;
+        __s.name = __name_;
+        __s.items_in = __in_;
+        __s.items_out = __out_;
+        __s.batches = __batches_;
+        __s.seconds = static_cast<double>(__nanoseconds_) * 1e-9;
+        return __s;
+    }
+
+private:
+    virtual std::unique_ptr<__batch_base> __run(__batch_base& __in) = 0;
+};
+
+template <class _In, class _Out>
+class __typed_stage_node : public __stage_node
+{
+    typename stage<_In, _Out>::function_type __fn_;
+
+    std::unique_ptr<__batch_base> __run(__batch_base& __in)
+    {
+        const std::vector<_In>& __items = static_cast<__batch<_In>&>(__in).__items_;
+        std::unique_ptr<__batch<_Out> > __out(new __batch<_Out>());
+        __out->__items_.reserve(__items.size());
+        _Out __o = _Out();
+        for (std::size_t __i = 0; __i < __items.size(); ++__i)
+            if (__fn_(__items[__i], __o))
+                __out->__items_.push_back(__o);
+        return std::unique_ptr<__batch_base>(__out.release());
+    }
+
+public:
+    explicit __typed_stage_node(const stage<_In, _Out>& __s) : __stage_node(__s.name()), __fn_(__s.function()) {}
+};
+
+
+struct __pipeline_task
+{
+    std::size_t __stage_;
+    std::unique_ptr<__batch_base> __batch_;
+};
+
+// Bounded deque of batches: the owner pushes and pops at the back, thieves take from the front.
+class __work_deque
+{
+    std::mutex __mutex_;
+    std::vector<std::unique_ptr<__pipeline_task> > __ring_;
+    std::size_t __head_;
+    std::size_t __size_;
+
+public:
+    explicit __work_deque(std::size_t __capacity) : __ring_(__capacity ? __capacity : 1), __head_(0), __size_(0) {}
+
+    bool __push_back(std::unique_ptr<__pipeline_task>& __t)
+    {
+        std::lock_guard<std::mutex> __lock(__mutex_);
+        if (__size_ == __ring_.size())
+            return false;
+        __ring_[(__head_ + __size_++) % __ring_.size()] = std::move(__t);
+        return true;
+    }
+
+    std::unique_ptr<__pipeline_task> __pop_back()
+    {
+        std::lock_guard<std::mutex> __lock(__mutex_);
+        if (__size_ == 0)
+            return std::unique_ptr<__pipeline_task>();
+        return std::move(__ring_[(__head_ + --__size_) % __ring_.size()]);
+    }
+
+    std::unique_ptr<__pipeline_task> __steal_front()
+    {
+        std::lock_guard<std::mutex> __lock(__mutex_);
+        if (__size_ == 0)
+            return std::unique_ptr<__pipeline_task>();
+        std::unique_ptr<__pipeline_task> __t = std::move(__ring_[__head_]);
+        __head_ = (__head_ + 1) % __ring_.size();
+        --__size_;
+        return __t;
+    }
+};
+
+
+// State of one run: the stages, the worker deques, the input and the sink.
+class __pipeline_run
+{
+public:
+    const std::vector<std::shared_ptr<__stage_node> >& __stages_;
+    std::vector<std::unique_ptr<__work_deque> > __deques_;
+    std::function<std::unique_ptr<__batch_base>()> __next_input_;   // Called under __input_mutex_.
+    std::function<void(__batch_base&)> __sink_;                     // Called under __sink_mutex_.
+    std::mutex __input_mutex_;
+    std::mutex __sink_mutex_;
+    std::mutex __error_mutex_;
+    std::atomic<std::size_t> __pending_;
+    std::atomic<bool> __abort_;
+    bool __exhausted_;
+    std::exception_ptr __error_;
+
+    __pipeline_run(const std::vector<std::shared_ptr<__stage_node> >& __stages, const pipeline_options& __options)
+        : __stages_(__stages), __pending_(0), __abort_(false), __exhausted_(false)
+    {
+        for (std::size_t __w = 0; __w < __options.workers; ++__w)
+            __deques_.push_back(std::unique_ptr<__work_deque>(new __work_deque(__options.queue_capacity)));
+    }
+
+    void __fail()
+    {
+        std::lock_guard<std::mutex> __lock(__error_mutex_);
+        if (!__error_)
+            __error_ = std::current_exception();
+        __abort_ = true;
+    }
+
+    std::unique_ptr<__pipeline_task> __input()
+    {
+        std::lock_guard<std::mutex> __lock(__input_mutex_);
+        std::unique_ptr<__pipeline_task> __t;
+        if (__exhausted_)
+            return __t;
+        std::unique_ptr<__batch_base> __b = __next_input_();
+        if (!__b)
+        {
+            __exhausted_ = true;
+            return __t;
+        }
+        __t.reset(new __pipeline_task());
+        __t->__stage_ = 0;
+        __t->__batch_ = std::move(__b);
+        ++__pending_;
+        return __t;
+    }
+
+    void __execute(std::unique_ptr<__pipeline_task> __t, std::size_t __w)
+    {
+        try
+        {
+            std::unique_ptr<__batch_base> __out = __stages_[__t->__stage_]->__process(*__t->__batch_);
+            if (__out->size() != 0)
+            {
+                if (__t->__stage_ + 1 == __stages_.size())
+                {
+                    std::lock_guard<std::mutex> __lock(__sink_mutex_);
+                    __sink_(*__out);
+                }
+                else
+                {
+                    // Hand the whole batch to the next stage; run it here when the deque is full.
+                    std::unique_ptr<__pipeline_task> __next(new __pipeline_task());
+                    __next->__stage_ = __t->__stage_ + 1;
+                    __next->__batch_ = std::move(__out);
+                    ++__pending_;
+                    if (!__deques_[__w]->__push_back(__next))
+                        __execute(std::move(__next), __w);
+                }
+            }
+        }
+        catch (...)
+        {
+            __fail();
+        }
+        --__pending_;
+    }
+
+    void __worker(std::size_t __w)
+    {
+        const std::size_t __n = __deques_.size();
+        while (!__abort_)
+        {
+            std::unique_ptr<__pipeline_task> __t = __deques_[__w]->__pop_back();
+            for (std::size_t __k = 1; !__t && __k < __n; ++__k)
+                __t = __deques_[(__w + __k) % __n]->__steal_front();
+            if (!__t)
+            {
+                try
+                {
+                    __t = __input();
+                }
+                catch (...)
+                {
+                    __fail();
+                    return;
+                }
+            }
+            if (__t)
+                __execute(std::move(__t), __w);
+            else if (__pending_ == 0)
+                return;
+            else
+                std::this_thread::yield();
+        }
+    }
+};
+
+
+// Chain of stages from _In items to _Out items, run by a set of work-stealing workers.
+// Copies of a pipeline share their stages, and the stage statistics.
+template <class _In, class _Out>
+class pipeline
+{
+    template <class, class> friend class pipeline;
+
+    std::vector<std::shared_ptr<__stage_node> > __stages_;
+    pipeline_options __options_;
+
+    pipeline() {}
+
+public:
+    typedef _In  input_type;
+    typedef _Out output_type;
+
+    explicit pipeline(const stage<_In, _Out>& __s)
+    {
+        __stages_.push_back(std::make_shared<__typed_stage_node<_In, _Out> >(__s));
+    }
+
+    template <class _Next>
+    pipeline<_In, _Next> then(const stage<_Out, _Next>& __s) const
+    {
+        pipeline<_In, _Next> __p;
+        __p.__stages_ = __stages_;
+        __p.__stages_.push_back(std::make_shared<__typed_stage_node<_Out, _Next> >(__s));
+        __p.__options_ = __options_;
+        return __p;
+    }
+
+    pipeline_options& options() {return __options_;}
+    const pipeline_options& options() const {return __options_;}
+
+    std::vector<stage_statistics> statistics() const
+    {
+        std::vector<stage_statistics> __s;
+        for (std::size_t __i = 0; __i < __stages_.size(); ++__i)
+            __s.push_back(__stages_[__i]->__statistics());
+        return __s;
+    }
+
+    // Pushes [__first, __last) through the stages.  __sink receives the output in batches,
+    // const std::vector<_Out>&, one call at a time.  The order of the items is not kept.
+    // The first exception thrown by a stage or the sink stops the run and is rethrown.
+    template <class _InputIterator, class _Sink>
+    void run(_InputIterator __first, _InputIterator __last, _Sink __sink, executor& __exec = default_executor())
+    {
+        pipeline_options __options = __options_;
+        if (__options.workers == 0)
+            __options.workers = 1;
+        if (__options.batch_size == 0)
+            __options.batch_size = 1;
+        __pipeline_run __run(__stages_, __options);
+
+        const std::size_t __batch_size = __options.batch_size;
+        __run.__next_input_ = [&__first, &__last, __batch_size]() -> std::unique_ptr<__batch_base>
+        {
+            if (__first == __last)
+                return std::unique_ptr<__batch_base>();
+            std::unique_ptr<__batch<_In> > __b(new __batch<_In>());
+            __b->__items_.reserve(__batch_size);
+            for (; __first != __last && __b->__items_.size() < __batch_size; ++__first)
+                __b->__items_.push_back(*__first);
+            return std::unique_ptr<__batch_base>(__b.release());
+        };
+        __run.__sink_ = [&__sink](__batch_base& __b) {__sink(static_cast<const __batch<_Out>&>(__b).__items_);};
+
+        __exec.bulk(__options.workers, [&__run](std::size_t __w) {__run.__worker(__w);});
+        if (__run.__error_)
+            std::rethrow_exception(__run.__error_);
+    }
+};
+
+template <class _In, class _Out>
+inline
+pipeline<_In, _Out>
+make_pipeline(const stage<_In, _Out>& __s)
+{
+    return pipeline<_In, _Out>(__s);
+}
+
+} // namespace metric
+
+#endif // METRICS_PIPELINE_HPP
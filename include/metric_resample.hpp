@@ -0,0 +1,209 @@
+// -*- C++ -*-
+//
+//===---------------------------- resample --------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_RESAMPLE_HPP
+#define METRICS_RESAMPLE_HPP
+
+#include "metric_config.hpp"
+#include "metric_algorithm.hpp"
+#include "metric_dimension.hpp"
+#include "metric_ringbuffer.hpp"
+#include <chrono>
+#include <cmath>
+#include <ratio>
+#include <stdexcept>
+#include <type_traits>
+
+namespace metric {
+
+// Rate between two samples: held from the first until the second, or linear from one to the other.
+enum class interpolation
+{
+    step,
+    linear
+};
+
+template <class _Total, bool = treat_as_floating_point<typename _Total::rep>::value>
+struct __resample_total
+{
+    static inline _Total __apply(double __v, double&) {return _Total(static_cast<typename _Total::rep>(__v));}
+};
+
+// Integral totals are rounded to nearest, ties to even, and the rounding error is carried to the
+// next bucket: the totals of the buckets add up to the rounded total of the stream.
+template <class _Total>
+struct __resample_total<_Total, false>
+{
+    static inline _Total __apply(double __v, double& __carry)
+    {
+        const double __c = std::nearbyint(__v + __carry);
+        __carry += __v - __c;
+        return _Total(static_cast<typename _Total::rep>(__c));
+    }
+};
+
+
+// Turns a sorted stream of time stamped rates (a flowrate, a power) into buckets of a fixed
+// interval aligned on the epoch of the clock, holding the total over the bucket (a volume, an
+// energy) and the mean rate.  The rate is integrated between consecutive samples, following
+// the interpolation, and the pieces falling in each bucket are summed in a single pass.  Two
+// samples further apart than max_gap leave a gap: nothing is integrated between them.  Buckets
+// are written once closed, every bucket from the first sample to the last, including the ones
+// in gaps; covered tells how much of a bucket had data.
+template <class _Rate, class _Total, class _Clock = std::chrono::steady_clock>
+class resampler
+{
+    typedef quantity_dimension<_Rate>  _Rd;
+    typedef quantity_dimension<_Total> _Td;
+
+    static_assert(_Rd::value && _Td::value, "resampler needs metrics with a dimension");
+    static_assert(std::is_same<typename dimension_multiply<typename _Rd::type, dimension<0, 0, 1, 0, 0> >::type,
+                               typename _Td::type>::value,
+                  "resampler total must be the rate integrated over time");
+
+    typedef typename std::ratio_divide<typename _Rd::scale, typename _Td::scale>::type _Scale;
+
+public:
+    typedef _Rate  rate_type;
+    typedef _Total total_type;
+    typedef typename __rebind_rep<_Rate, double>::type mean_type;
+    typedef metric::sample<_Rate, _Clock> value_type;
+    typedef typename _Clock::duration duration;
+    typedef typename _Clock::time_point time_point;
+
+    struct bucket
+    {
+        time_point start;
+        duration   covered;     // Time of the bucket between samples, out of the gaps.
+        _Total     total;
+        mean_type  mean;        // Over the time covered; zero when nothing is.
+    };
+
+private:
+    duration      __interval_;
+    duration      __max_gap_;
+    interpolation __mode_;
+    bool          __started_;
+    value_type    __last_;
+    time_point    __open_;        // Start of the bucket being filled.
+    double        __integral_;    // Rate counts times seconds, in the open bucket.
+    duration      __covered_;
+    double        __carry_;
+
+    inline time_point __bucket_of(const time_point& __t) const
+    {
+        typename duration::rep __q = __t.time_since_epoch() / __interval_;
+        if (__t.time_since_epoch() % __interval_ < duration::zero())
+            --__q;
+        return time_point(__q * __interval_);
+    }
+
+    template <class _OutputIterator>
+    _OutputIterator __emit(_OutputIterator __out)
+    {
+        const double __seconds = std::chrono::duration<double>(__covered_).count();
+        const bucket __b = {__open_, __covered_,
+                            __resample_total<_Total>::__apply(__integral_ * _Scale::num / _Scale::den, __carry_),
+                            mean_type(__seconds > 0 ? __integral_ / __seconds : 0.)};
+        *__out = __b;
+        ++__out;
+        __open_ += __interval_;
+        __integral_ = 0;
+        __covered_ = duration::zero();
+        return __out;
+    }
+
+    // Rate at __t, between the last sample and __s.
+    inline double __rate_at(const value_type& __s, const time_point& __t) const
+    {
+        const double __r0 = static_cast<double>(__last_.value.count());
+        if (__mode_ == interpolation::step)
+            return __r0;
+        const double __f = std::chrono::duration<double>(__t - __last_.time).count()
+                         / std::chrono::duration<double>(__s.time - __last_.time).count();
+        return __r0 + (static_cast<double>(__s.value.count()) - __r0) * __f;
+    }
+
+public:
+    explicit resampler(duration __interval, interpolation __mode = interpolation::linear,
+                       duration __max_gap = duration::max())
+        : __interval_(__interval), __max_gap_(__max_gap), __mode_(__mode), __started_(false), __last_(),
+          __open_(), __integral_(0), __covered_(duration::zero()), __carry_(0)
+    {
+        if (__interval <= duration::zero())
+            throw std::invalid_argument("metric resampler: the interval must be positive");
+    }
+
+    inline duration interval() const {return __interval_;}
+
+    // Integrates up to the sample and writes the buckets it closes.  Throws
+    // std::invalid_argument on a sample older than the previous one.
+    template <class _OutputIterator>
+    _OutputIterator push(const value_type& __s, _OutputIterator __out)
+    {
+        if (!__started_)
+        {
+            __started_ = true;
+            __last_ = __s;
+            __open_ = __bucket_of(__s.time);
+            return __out;
+        }
+        if (__s.time < __last_.time)
+            throw std::invalid_argument("metric resampler: samples must be sorted by time");
+
+        const bool __gap = __s.time - __last_.time > __max_gap_;
+        time_point __a = __last_.time;
+        for (;;)
+        {
+            const time_point __end = __open_ + __interval_;
+            const time_point __b = __s.time < __end ? __s.time : __end;
+            if (!__gap && __a < __b)
+            {
+                const double __r = __mode_ == interpolation::step ? __rate_at(__s, __a)
+                                 : (__rate_at(__s, __a) + __rate_at(__s, __b)) / 2;
+                __integral_ += __r * std::chrono::duration<double>(__b - __a).count();
+                __covered_ += __b - __a;
+            }
+            if (__s.time < __end)
+                break;
+            __out = __emit(__out);
+            __a = __b;
+        }
+        __last_ = __s;
+        return __out;
+    }
+
+    // Batch update from a sorted range of samples, in the same pass.
+    template <class _InputIterator, class _OutputIterator>
+    _OutputIterator push(_InputIterator __first, _InputIterator __last, _OutputIterator __out)
+    {
+        for (; __first != __last; ++__first)
+            __out = push(*__first, __out);
+        return __out;
+    }
+
+    // End of the stream: writes the bucket being filled, partial, and starts over.
+    template <class _OutputIterator>
+    _OutputIterator flush(_OutputIterator __out)
+    {
+        if (__started_)
+            __out = __emit(__out);
+        __started_ = false;
+        __integral_ = 0;
+        __covered_ = duration::zero();
+        __carry_ = 0;
+        return __out;
+    }
+};
+
+} // namespace metric
+
+#endif // METRICS_RESAMPLE_HPP
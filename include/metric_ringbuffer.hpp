@@ -0,0 +1,214 @@
+// -*- C++ -*-
+//
+//===---------------------------- ringbuffer ------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_RINGBUFFER_HPP
+#define METRICS_RINGBUFFER_HPP
+
+#include "metric_config.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace metric {
+
+// Time stamped value.  A metric only holds its representation, the unit being in the type:
+// a metric::millivolt sample with a steady_clock time point takes 16 bytes.
+template <class _Metric, class _Clock = std::chrono::steady_clock>
+struct sample
+{
+    typedef _Metric metric_type;
+    typedef _Clock clock;
+    typedef typename _Clock::time_point time_point;
+
+    time_point time;
+    _Metric    value;
+
+    inline sample() : time(), value() {}
+    inline sample(const time_point& __t, const _Metric& __v) : time(__t), value(__v) {}
+};
+
+// Indices written by different threads are kept on different cache lines.
+static const std::size_t __cache_line = 64;
+
+inline std::size_t __ring_capacity(std::size_t __n)
+{
+    std::size_t __c = 2;
+    while (__c < __n)
+        __c <<= 1;
+    return __c;
+}
+
+
+// Single producer, single consumer ring.  The capacity is rounded up to a power of two and
+// allocated once.  Each side keeps a copy of the other side's index, only refreshed when the
+// ring looks full (or empty), so most operations do not touch the shared cache line.
+template <class _Metric, class _Clock = std::chrono::steady_clock>
+class spsc_ring
+{
+public:
+    typedef metric::sample<_Metric, _Clock> value_type;
+
+private:
+    const std::size_t       __mask_;
+    std::vector<value_type> __slots_;
+
+    alignas(__cache_line) std::atomic<std::size_t> __tail_;   // Written by the producer.
+    std::size_t                                    __head_cache_;
+    alignas(__cache_line) std::atomic<std::size_t> __head_;   // Written by the consumer.
+    std::size_t                                    __tail_cache_;
+
+public:
+    explicit spsc_ring(std::size_t __capacity)
+        : __mask_(__ring_capacity(__capacity) - 1), __slots_(__mask_ + 1),
+          __tail_(0), __head_cache_(0), __head_(0), __tail_cache_(0) {}
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    inline std::size_t capacity() const {return __mask_ + 1;}
+
+    // Approximate when called while the other side is running.
+    inline std::size_t size() const {return __tail_.load(std::memory_order_acquire) - __head_.load(std::memory_order_acquire);}
+    inline bool empty() const {return size() == 0;}
+
+    // Producer side: pushes up to __n samples, returns how many were pushed.
+    std::size_t push(const value_type* __first, std::size_t __n)
+    {
+        const std::size_t __t = __tail_.load(std::memory_order_relaxed);
+        std::size_t __free = capacity() - (__t - __head_cache_);
+        if (__free < __n)
+        {
+            __head_cache_ = __head_.load(std::memory_order_acquire);
+            __free = capacity() - (__t - __head_cache_);
+        }
+        if (__n > __free)
+            __n = __free;
+        for (std::size_t __i = 0; __i < __n; ++__i)
+            __slots_[(__t + __i) & __mask_] = __first[__i];
+        __tail_.store(__t + __n, std::memory_order_release);
+        return __n;
+    }
+
+    inline bool try_push(const value_type& __s) {return push(&__s, 1) == 1;}
+
+    // Consumer side: pops up to __n samples, returns how many were popped.
+    std::size_t pop(value_type* __out, std::size_t __n)
+    {
+        const std::size_t __h = __head_.load(std::memory_order_relaxed);
+        std::size_t __used = __tail_cache_ - __h;
+        if (__used < __n)
+        {
+            __tail_cache_ = __tail_.load(std::memory_order_acquire);
+            __used = __tail_cache_ - __h;
+        }
+        if (__n > __used)
+            __n = __used;
+        for (std::size_t __i = 0; __i < __n; ++__i)
+            __out[__i] = __slots_[(__h + __i) & __mask_];
+        __head_.store(__h + __n, std::memory_order_release);
+        return __n;
+    }
+
+    inline bool try_pop(value_type& __s) {return pop(&__s, 1) == 1;}
+};
+
+
+// Multiple producers, single consumer ring.  A producer claims a run of free slots with a
+// single compare and swap on the tail, fills them, then stamps each one with its position
+// plus one; the consumer stops at the first slot not stamped yet, so producers finishing out
+// of order are never overtaken.
+template <class _Metric, class _Clock = std::chrono::steady_clock>
+class mpsc_ring
+{
+public:
+    typedef metric::sample<_Metric, _Clock> value_type;
+
+private:
+    struct __slot
+    {
+        std::atomic<std::size_t> __stamp_;
+        value_type               __value_;
+
+        __slot() : __stamp_(0), __value_() {}
+    };
+
+    const std::size_t __mask_;
+    std::vector<__slot> __slots_;
+
+    alignas(__cache_line) std::atomic<std::size_t> __tail_;   // Claimed by the producers.
+    alignas(__cache_line) std::atomic<std::size_t> __head_;   // Written by the consumer.
+
+public:
+    explicit mpsc_ring(std::size_t __capacity)
+        : __mask_(__ring_capacity(__capacity) - 1), __slots_(__mask_ + 1), __tail_(0), __head_(0) {}
+
+    mpsc_ring(const mpsc_ring&) = delete;
+    mpsc_ring& operator=(const mpsc_ring&) = delete;
+
+    inline std::size_t capacity() const {return __mask_ + 1;}
+
+    // Approximate when called while the producers or the consumer are running.
+    inline std::size_t size() const
+    {
+        const std::size_t __h = __head_.load(std::memory_order_acquire);
+        const std::size_t __t = __tail_.load(std::memory_order_acquire);
+        return __t - __h;
+    }
+    inline bool empty() const {return size() == 0;}
+
+    // Producer side, from any thread: pushes up to __n samples, returns how many were pushed.
+    std::size_t push(const value_type* __first, std::size_t __n)
+    {
+        std::size_t __t = __tail_.load(std::memory_order_relaxed);
+        std::size_t __k;
+        do
+        {
+            const std::size_t __free = capacity() - (__t - __head_.load(std::memory_order_acquire));
+            __k = __n < __free ? __n : __free;
+            if (__k == 0)
+                return 0;
+        }
+        while (!__tail_.compare_exchange_weak(__t, __t + __k, std::memory_order_relaxed));
+
+        for (std::size_t __i = 0; __i < __k; ++__i)
+        {
+            __slot& __s = __slots_[(__t + __i) & __mask_];
+            __s.__value_ = __first[__i];
+            __s.__stamp_.store(__t + __i + 1, std::memory_order_release);
+        }
+        return __k;
+    }
+
+    inline bool try_push(const value_type& __s) {return push(&__s, 1) == 1;}
+
+    // Consumer side: pops up to __n samples, returns how many were popped.
+    std::size_t pop(value_type* __out, std::size_t __n)
+    {
+        const std::size_t __h = __head_.load(std::memory_order_relaxed);
+        std::size_t __i = 0;
+        for (; __i < __n; ++__i)
+        {
+            const __slot& __s = __slots_[(__h + __i) & __mask_];
+            if (__s.__stamp_.load(std::memory_order_acquire) != __h + __i + 1)
+                break;
+            __out[__i] = __s.__value_;
+        }
+        __head_.store(__h + __i, std::memory_order_release);
+        return __i;
+    }
+
+    inline bool try_pop(value_type& __s) {return pop(&__s, 1) == 1;}
+};
+
+} // namespace metric
+
+#endif // METRICS_RINGBUFFER_HPP
@@ -0,0 +1,149 @@
+// -*- C++ -*-
+//
+//===---------------------------- rounding --------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_ROUNDING_HPP
+#define METRICS_ROUNDING_HPP
+
+#include "metric_config.hpp"
+#include <cmath>
+
+namespace metric {
+
+enum __rounding
+{
+    __round_floor,
+    __round_ceil,
+    __round_half_even
+};
+
+// Two metrics of the same kind (same class template).
+template <class _Lhs, class _Rhs>
+struct __same_metric : std::false_type {};
+
+template <template <class, class> class _Master, class _Rep1, class _Period1, class _Rep2, class _Period2>
+struct __same_metric<_Master<_Rep1, _Period1>, _Master<_Rep2, _Period2> > : std::true_type {};
+
+
+// Quotient __q and remainder __r of a division by __d (with __d > 0), rounded following _Mode.
+template <class _Ct>
+inline METRICCONSTEXPR
+_Ct __round_quotient(const _Ct& __d, const _Ct& __q, const _Ct& __r, __rounding __mode)
+{
+    return __mode == __round_floor ? (__r < _Ct(0) ? __q - _Ct(1) : __q)
+         : __mode == __round_ceil  ? (__r > _Ct(0) ? __q + _Ct(1) : __q)
+         : __r < _Ct(0)
+           ? (-__r > __d + __r || (-__r == __d + __r && __q % _Ct(2) != _Ct(0)) ? __q - _Ct(1) : __q)
+           : ( __r > __d - __r || ( __r == __d - __r && __q % _Ct(2) != _Ct(0)) ? __q + _Ct(1) : __q);
+}
+
+template <class _Ct>
+inline METRICCONSTEXPR
+_Ct __round_divide(const _Ct& __n, const _Ct& __d, __rounding __mode)
+{
+    return __round_quotient(__d, __n / __d, __n % __d, __mode);
+}
+
+template <class _Float>
+inline _Float __round_float(const _Float& __v, __rounding __mode)
+{
+    return __mode == __round_floor ? std::floor(__v)
+         : __mode == __round_ceil  ? std::ceil(__v)
+         : std::nearbyint(__v);  // Default rounding mode: to nearest, ties to even.
+}
+
+
+template <class _FromMetric, class _ToMetric, __rounding _Mode,
+          class _Period = typename std::ratio_divide<typename _FromMetric::period, typename _ToMetric::period>::type,
+          bool = __is_integer_rep<typename _ToMetric::rep>::value,
+          bool = __is_integer_rep<typename _FromMetric::rep>::value>
+struct __metric_round;
+
+// Integer to integer: the ratio is applied in integer arithmetic, the remainder decides the rounding.
+template <class _FromMetric, class _ToMetric, __rounding _Mode, class _Period>
+struct __metric_round<_FromMetric, _ToMetric, _Mode, _Period, true, true>
+{
+    typedef typename std::common_type<typename _ToMetric::rep, typename _FromMetric::rep, intmax_t>::type _Ct;
+
+    inline METRICCONSTEXPR
+    _ToMetric operator()(const _FromMetric& __fd) const
+    {
+        return _ToMetric(static_cast<typename _ToMetric::rep>(
+                   __round_divide(static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_Period::num),
+                                  static_cast<_Ct>(_Period::den), _Mode)));
+    }
+};
+
+// Floating point to integer.
+template <class _FromMetric, class _ToMetric, __rounding _Mode, class _Period>
+struct __metric_round<_FromMetric, _ToMetric, _Mode, _Period, true, false>
+{
+    typedef typename std::common_type<typename _FromMetric::rep, long double>::type _Ct;
+
+    inline
+    _ToMetric operator()(const _FromMetric& __fd) const
+    {
+        return _ToMetric(static_cast<typename _ToMetric::rep>(
+                   __round_float(static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_Period::num)
+                                                                / static_cast<_Ct>(_Period::den), _Mode)));
+    }
+};
+
+// Floating point destination: nothing to round.
+template <class _FromMetric, class _ToMetric, __rounding _Mode, class _Period, bool _FromInteger>
+struct __metric_round<_FromMetric, _ToMetric, _Mode, _Period, false, _FromInteger>
+    : __metric_cast<_FromMetric, _ToMetric>
+{
+};
+
+
+template <class _ToMetric, class _FromMetric>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __same_metric<_FromMetric, _ToMetric>::value,
+    _ToMetric
+>::type
+floor_cast(const _FromMetric& __fd)
+{
+    return __metric_round<_FromMetric, _ToMetric, __round_floor>()(__fd);
+}
+
+template <class _ToMetric, class _FromMetric>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __same_metric<_FromMetric, _ToMetric>::value,
+    _ToMetric
+>::type
+ceil_cast(const _FromMetric& __fd)
+{
+    return __metric_round<_FromMetric, _ToMetric, __round_ceil>()(__fd);
+}
+
+// Round to nearest, ties to even.
+template <class _ToMetric, class _FromMetric>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __same_metric<_FromMetric, _ToMetric>::value,
+    _ToMetric
+>::type
+round_cast(const _FromMetric& __fd)
+{
+    return __metric_round<_FromMetric, _ToMetric, __round_half_even>()(__fd);
+}
+
+} // namespace metric
+
+#endif // METRICS_ROUNDING_HPP
@@ -0,0 +1,528 @@
+// -*- C++ -*-
+//
+//===---------------------------- sketch ----------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_SKETCH_HPP
+#define METRICS_SKETCH_HPP
+
+#include "metric_config.hpp"
+#include "metric_algorithm.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace metric {
+
+// Sketches are serialized little endian, whatever the host, so they can be merged across
+// processes and machines.
+inline void __sketch_put(std::vector<unsigned char>& __out, std::uint64_t __v)
+{
+    for (unsigned __i = 0; __i < 8; ++__i)
+        __out.push_back(static_cast<unsigned char>(__v >> (8 * __i)));
+}
+
+inline void __sketch_put(std::vector<unsigned char>& __out, double __d)
+{
+    std::uint64_t __v;
+    std::memcpy(&__v, &__d, sizeof(__v));
+    __sketch_put(__out, __v);
+}
+
+class __sketch_reader
+{
+    const unsigned char* __p_;
+    const unsigned char* __end_;
+
+public:
+    inline __sketch_reader(const void* __data, std::size_t __size)
+        : __p_(static_cast<const unsigned char*>(__data)), __end_(__p_ + __size) {}
+
+    inline std::uint64_t __read()
+    {
+        if (__end_ - __p_ < 8)
+            throw std::invalid_argument("metric sketch: truncated data");
+        std::uint64_t __v = 0;
+        for (unsigned __i = 0; __i < 8; ++__i)
+            __v |= static_cast<std::uint64_t>(__p_[__i]) << (8 * __i);
+        __p_ += 8;
+        return __v;
+    }
+
+    inline double __read_double()
+    {
+        const std::uint64_t __v = __read();
+        double __d;
+        std::memcpy(&__d, &__v, sizeof(__d));
+        return __d;
+    }
+
+    inline void __expect(std::uint64_t __v)
+    {
+        if (__read() != __v)
+            throw std::invalid_argument("metric sketch: not a sketch of this type");
+    }
+
+    inline void __finish() const
+    {
+        if (__p_ != __end_)
+            throw std::invalid_argument("metric sketch: trailing data");
+    }
+};
+
+// Quantiles are interpolated: they come in the unit of the sketch with a double count.
+template <class _Metric>
+struct __quantile_type
+{
+    typedef typename __rebind_rep<_Metric, double>::type type;
+};
+
+
+// Merging t-digest (Dunning, Ertl).  Values are buffered, then merged into at most
+// _Compression + 2 centroids whose size is bounded by the arcsine scale function: centroids
+// are small near the tails, so p99 and p999 stay accurate while p50 gets coarser.  Memory is
+// fixed by _Compression, whatever the number of values added or sketches merged.
+template <class _Metric, unsigned _Compression = 100>
+class tdigest
+{
+    static_assert(_Compression >= 10, "tdigest compression must be at least 10");
+
+public:
+    typedef _Metric metric_type;
+    typedef typename __quantile_type<_Metric>::type quantile_type;
+
+    static const std::size_t capacity = _Compression + 2;
+    static const std::size_t buffer_size = 4 * _Compression;
+
+private:
+    struct __centroid
+    {
+        double __mean_;
+        double __weight_;
+
+        inline bool operator<(const __centroid& __c) const {return __mean_ < __c.__mean_;}
+    };
+
+    static const std::uint64_t __tag = 0x3174736567696474ULL;    // "tdigest1"
+
+    // Centroids first, sorted after each __compress, then the values not merged yet.
+    std::array<__centroid, capacity + buffer_size> __c_;
+    std::size_t __merged_;
+    std::size_t __size_;
+    double __count_;
+    double __min_;
+    double __max_;
+
+    static inline double __scale(double __q)
+    {
+        return _Compression / (2 * 3.14159265358979323846) * std::asin(2 * __q - 1);
+    }
+
+    static inline double __inverse_scale(double __k)
+    {
+        return (std::sin(__k * (2 * 3.14159265358979323846) / _Compression) + 1) / 2;
+    }
+
+    // Merges the values __c[__merged, __size) into the sorted centroids __c[0, __merged), in
+    // place.  Returns the number of centroids.
+    static std::size_t __compress(__centroid* __c, std::size_t __merged, std::size_t __size, double __count)
+    {
+        if (__size == __merged)
+            return __size;
+        std::sort(__c + __merged, __c + __size);
+        std::inplace_merge(__c, __c + __merged, __c + __size);
+
+        double __seen = 0;
+        double __limit = __count * __inverse_scale(__scale(0) + 1);
+        std::size_t __n = 0;
+        for (std::size_t __i = 1; __i < __size; ++__i)
+        {
+            __centroid& __cur = __c[__n];
+            const __centroid& __next = __c[__i];
+            if (__seen + __cur.__weight_ + __next.__weight_ <= __limit || __n + 1 == capacity)
+            {
+                __cur.__weight_ += __next.__weight_;
+                __cur.__mean_ += (__next.__mean_ - __cur.__mean_) * __next.__weight_ / __cur.__weight_;
+            }
+            else
+            {
+                __seen += __cur.__weight_;
+                __limit = __count * __inverse_scale(__scale(__seen / __count) + 1);
+                __c[++__n] = __next;
+            }
+        }
+        return __n + 1;
+    }
+
+    // The merged centroids, without modifying the sketch: in place when no value is buffered,
+    // else merged in __tmp.
+    const __centroid* __centroids(std::vector<__centroid>& __tmp, std::size_t& __n) const
+    {
+        if (__size_ == __merged_)
+        {
+            __n = __size_;
+            return __c_.data();
+        }
+        __tmp.assign(__c_.begin(), __c_.begin() + __size_);
+        __n = __compress(__tmp.data(), __merged_, __size_, __count_);
+        return __tmp.data();
+    }
+
+    inline void __push(double __mean, double __weight)
+    {
+        if (__size_ == __c_.size())
+            compress();
+        const __centroid __c = {__mean, __weight};
+        __c_[__size_++] = __c;
+        __count_ += __weight;
+    }
+
+public:
+    inline tdigest()
+        : __merged_(0), __size_(0), __count_(0),
+          __min_(std::numeric_limits<double>::infinity()), __max_(-std::numeric_limits<double>::infinity()) {}
+
+    inline void add(const _Metric& __m, double __weight = 1)
+    {
+        const double __v = static_cast<double>(__m.count());
+        __min_ = __v < __min_ ? __v : __min_;
+        __max_ = __v > __max_ ? __v : __max_;
+        __push(__v, __weight);
+    }
+
+    template <class _InputIterator>
+    void add(_InputIterator __first, _InputIterator __last)
+    {
+        for (; __first != __last; ++__first)
+            add(*__first);
+    }
+
+    // Adds the centroids of an other sketch, of this thread or deserialized from an other process.
+    void merge(const tdigest& __o)
+    {
+        if (&__o == this)
+        {
+            const tdigest __copy(__o);
+            merge(__copy);
+            return;
+        }
+        std::vector<__centroid> __tmp;
+        std::size_t __n;
+        const __centroid* __c = __o.__centroids(__tmp, __n);
+        for (std::size_t __i = 0; __i < __n; ++__i)
+            __push(__c[__i].__mean_, __c[__i].__weight_);
+        __min_ = __o.__min_ < __min_ ? __o.__min_ : __min_;
+        __max_ = __o.__max_ > __max_ ? __o.__max_ : __max_;
+    }
+
+    // Merges the buffered values into the centroids.  The const members never modify the
+    // sketch, so several threads may read a shared one; with values buffered, they merge a copy
+    // each time, which calling compress() once saves.
+    void compress() {__merged_ = __size_ = __compress(__c_.data(), __merged_, __size_, __count_);}
+
+    inline void clear() {*this = tdigest();}
+
+    inline bool empty() const {return __count_ == 0;}
+    inline double count() const {return __count_;}
+    inline quantile_type minimum() const {return quantile_type(__min_);}
+    inline quantile_type maximum() const {return quantile_type(__max_);}
+
+    // Number of centroids once the buffered values are merged.
+    inline std::size_t centroids() const
+    {
+        std::vector<__centroid> __tmp;
+        std::size_t __n;
+        __centroids(__tmp, __n);
+        return __n;
+    }
+
+    // Value below which a fraction __q of the values fall, interpolated between the centres of
+    // the centroids, the minimum and the maximum.  An empty sketch answers zero.
+    quantile_type quantile(double __q) const
+    {
+        if (__count_ == 0)
+            return quantile_type(0.);
+        std::vector<__centroid> __tmp;
+        std::size_t __n;
+        const __centroid* __c = __centroids(__tmp, __n);
+        const double __index = (__q < 0 ? 0 : __q > 1 ? 1 : __q) * __count_;
+        double __seen = 0, __left = 0, __left_mean = __min_;
+        for (std::size_t __i = 0; __i < __n; ++__i)
+        {
+            const double __centre = __seen + __c[__i].__weight_ / 2;
+            if (__index < __centre)
+                return quantile_type(__left_mean + (__c[__i].__mean_ - __left_mean) * (__index - __left) / (__centre - __left));
+            __seen += __c[__i].__weight_;
+            __left = __centre;
+            __left_mean = __c[__i].__mean_;
+        }
+        const double __f = __count_ > __left ? (__index - __left) / (__count_ - __left) : 1;
+        return quantile_type(__left_mean + (__max_ - __left_mean) * __f);
+    }
+
+    std::vector<unsigned char> serialize() const
+    {
+        std::vector<__centroid> __tmp;
+        std::size_t __n;
+        const __centroid* __c = __centroids(__tmp, __n);
+        std::vector<unsigned char> __out;
+        __out.reserve(8 * (5 + 2 * __n));
+        __sketch_put(__out, __tag);
+        __sketch_put(__out, static_cast<std::uint64_t>(_Compression));
+        __sketch_put(__out, __min_);
+        __sketch_put(__out, __max_);
+        __sketch_put(__out, static_cast<std::uint64_t>(__n));
+        for (std::size_t __i = 0; __i < __n; ++__i)
+        {
+            __sketch_put(__out, __c[__i].__mean_);
+            __sketch_put(__out, __c[__i].__weight_);
+        }
+        return __out;
+    }
+
+    // Throws std::invalid_argument when the data is not a serialized tdigest of this compression.
+    static tdigest deserialize(const void* __data, std::size_t __size)
+    {
+        __sketch_reader __r(__data, __size);
+        __r.__expect(__tag);
+        __r.__expect(_Compression);
+        tdigest __t;
+        __t.__min_ = __r.__read_double();
+        __t.__max_ = __r.__read_double();
+        const std::uint64_t __n = __r.__read();
+        if (__n > capacity)
+            throw std::invalid_argument("metric sketch: too many centroids");
+        for (std::size_t __i = 0; __i < __n; ++__i)
+        {
+            const double __mean = __r.__read_double();
+            __t.__push(__mean, __r.__read_double());
+        }
+        __r.__finish();
+        __t.__merged_ = __t.__size_;
+        return __t;
+    }
+};
+
+template <class _Metric, unsigned _Compression>
+const std::size_t tdigest<_Metric, _Compression>::capacity;
+
+template <class _Metric, unsigned _Compression>
+const std::size_t tdigest<_Metric, _Compression>::buffer_size;
+
+
+// Log-linear histogram of integral counts, as HdrHistogram: values below 2^_Bits have a bucket
+// each, larger ones share 2^_Bits buckets per power of two, so a bucket is never wider than
+// 2^-_Bits of its values.  Negative values have their own buckets.  Counts are exact, merging
+// adds buckets, and the memory is fixed by _Bits and the size of the representation.
+template <class _Metric, unsigned _Bits = 5>
+class log_histogram
+{
+    typedef typename _Metric::rep _Rep;
+    typedef typename std::make_unsigned<_Rep>::type _Magnitude;
+
+    static_assert(std::is_integral<_Rep>::value, "log_histogram needs an integral representation");
+    static_assert(_Bits >= 1 && _Bits < 16, "log_histogram sub-bucket bits must be in [1, 16)");
+
+public:
+    typedef _Metric metric_type;
+    typedef typename __quantile_type<_Metric>::type quantile_type;
+
+    static const unsigned    digits = std::numeric_limits<_Magnitude>::digits;
+    static const std::size_t buckets = (static_cast<std::size_t>(digits) - _Bits + 1) << _Bits;
+
+private:
+    static const std::uint64_t __tag = 0x31747369686f6c6dULL;    // "mlohist1"
+
+    std::array<std::uint64_t, buckets> __positive_;
+    std::array<std::uint64_t, buckets> __negative_;
+    std::uint64_t __count_;
+    _Rep __min_;
+    _Rep __max_;
+
+    static inline unsigned __high_bit(_Magnitude __v)
+    {
+        unsigned __h = 0;
+        while (__v >>= 1)
+            ++__h;
+        return __h;
+    }
+
+    static inline std::size_t __index(_Magnitude __v)
+    {
+        if (__v < (_Magnitude(1) << _Bits))
+            return static_cast<std::size_t>(__v);
+        const unsigned __h = __high_bit(__v);
+        return (static_cast<std::size_t>(__h - _Bits + 1) << _Bits) + static_cast<std::size_t>((__v >> (__h - _Bits)) - (_Magnitude(1) << _Bits));
+    }
+
+    // Lowest magnitude of a bucket, and its width.
+    static inline double __lowest(std::size_t __i)
+    {
+        const std::size_t __e = __i >> _Bits;
+        const double __m = static_cast<double>(__i & ((std::size_t(1) << _Bits) - 1));
+        return __e == 0 ? __m : std::ldexp(__m + (std::size_t(1) << _Bits), static_cast<int>(__e - 1));
+    }
+
+    static inline double __width(std::size_t __i)
+    {
+        const std::size_t __e = __i >> _Bits;
+        return __e == 0 ? 1 : std::ldexp(1., static_cast<int>(__e - 1));
+    }
+
+    static inline _Magnitude __magnitude(_Rep __r)
+    {
+        return __r < 0 ? static_cast<_Magnitude>(_Magnitude(0) - static_cast<_Magnitude>(__r)) : static_cast<_Magnitude>(__r);
+    }
+
+public:
+    inline log_histogram()
+        : __count_(0), __min_(std::numeric_limits<_Rep>::max()), __max_(std::numeric_limits<_Rep>::lowest())
+    {
+        __positive_.fill(0);
+        __negative_.fill(0);
+    }
+
+    inline void add(const _Metric& __m, std::uint64_t __n = 1)
+    {
+        const _Rep __r = __m.count();
+        (__r < 0 ? __negative_ : __positive_)[__index(__magnitude(__r))] += __n;
+        __count_ += __n;
+        __min_ = __r < __min_ ? __r : __min_;
+        __max_ = __r > __max_ ? __r : __max_;
+    }
+
+    template <class _InputIterator>
+    void add(_InputIterator __first, _InputIterator __last)
+    {
+        for (; __first != __last; ++__first)
+            add(*__first);
+    }
+
+    void merge(const log_histogram& __o)
+    {
+        for (std::size_t __i = 0; __i < buckets; ++__i)
+        {
+            __positive_[__i] += __o.__positive_[__i];
+            __negative_[__i] += __o.__negative_[__i];
+        }
+        __count_ += __o.__count_;
+        __min_ = __o.__min_ < __min_ ? __o.__min_ : __min_;
+        __max_ = __o.__max_ > __max_ ? __o.__max_ : __max_;
+    }
+
+    inline void clear() {*this = log_histogram();}
+
+    inline bool empty() const {return __count_ == 0;}
+    inline std::uint64_t count() const {return __count_;}
+    inline _Metric minimum() const {return _Metric(__min_);}
+    inline _Metric maximum() const {return _Metric(__max_);}
+
+    // Value below which a fraction __q of the values fall: the middle of the bucket holding the
+    // rank, within the minimum and the maximum, which are exact.  An empty histogram answers zero.
+    quantile_type quantile(double __q) const
+    {
+        if (__count_ == 0)
+            return quantile_type(0.);
+        const double __clamped = __q < 0 ? 0 : __q > 1 ? 1 : __q;
+        std::uint64_t __rank = static_cast<std::uint64_t>(std::ceil(__clamped * static_cast<double>(__count_)));
+        if (__rank <= 1)
+            return quantile_type(static_cast<double>(__min_));
+        if (__rank >= __count_)
+            return quantile_type(static_cast<double>(__max_));
+        double __v = static_cast<double>(__max_);
+        std::uint64_t __seen = 0;
+        bool __found = false;
+        for (std::size_t __i = buckets; __i-- > 0 && !__found; )
+            if ((__seen += __negative_[__i]) >= __rank)
+            {
+                __v = -(__lowest(__i) + (__width(__i) - 1) / 2);
+                __found = true;
+            }
+        for (std::size_t __i = 0; __i < buckets && !__found; ++__i)
+            if ((__seen += __positive_[__i]) >= __rank)
+            {
+                __v = __lowest(__i) + (__width(__i) - 1) / 2;
+                __found = true;
+            }
+        const double __lo = static_cast<double>(__min_), __hi = static_cast<double>(__max_);
+        return quantile_type(__v < __lo ? __lo : __v > __hi ? __hi : __v);
+    }
+
+    // Only the buckets in use are written.
+    std::vector<unsigned char> serialize() const
+    {
+        std::vector<unsigned char> __out;
+        __sketch_put(__out, __tag);
+        __sketch_put(__out, static_cast<std::uint64_t>(_Bits));
+        __sketch_put(__out, static_cast<std::uint64_t>(digits));
+        __sketch_put(__out, static_cast<std::uint64_t>(static_cast<std::int64_t>(__min_)));
+        __sketch_put(__out, static_cast<std::uint64_t>(static_cast<std::int64_t>(__max_)));
+        std::uint64_t __used = 0;
+        for (std::size_t __i = 0; __i < buckets; ++__i)
+            __used += (__positive_[__i] != 0) + (__negative_[__i] != 0);
+        __sketch_put(__out, __used);
+        for (std::size_t __i = 0; __i < buckets; ++__i)
+        {
+            if (__negative_[__i] != 0)
+            {
+                __sketch_put(__out, static_cast<std::uint64_t>(buckets + __i));
+                __sketch_put(__out, __negative_[__i]);
+            }
+            if (__positive_[__i] != 0)
+            {
+                __sketch_put(__out, static_cast<std::uint64_t>(__i));
+                __sketch_put(__out, __positive_[__i]);
+            }
+        }
+        return __out;
+    }
+
+    // Throws std::invalid_argument when the data is not a serialized histogram of this layout.
+    static log_histogram deserialize(const void* __data, std::size_t __size)
+    {
+        __sketch_reader __r(__data, __size);
+        __r.__expect(__tag);
+        __r.__expect(_Bits);
+        __r.__expect(digits);
+        log_histogram __h;
+        __h.__min_ = static_cast<_Rep>(static_cast<std::int64_t>(__r.__read()));
+        __h.__max_ = static_cast<_Rep>(static_cast<std::int64_t>(__r.__read()));
+        const std::uint64_t __used = __r.__read();
+        if (__used > 2 * buckets)
+            throw std::invalid_argument("metric sketch: too many buckets");
+        for (std::uint64_t __k = 0; __k < __used; ++__k)
+        {
+            const std::uint64_t __i = __r.__read();
+            const std::uint64_t __n = __r.__read();
+            if (__i >= 2 * buckets)
+                throw std::invalid_argument("metric sketch: bucket out of range");
+            (__i < buckets ? __h.__positive_[__i] : __h.__negative_[__i - buckets]) += __n;
+            __h.__count_ += __n;
+        }
+        __r.__finish();
+        return __h;
+    }
+};
+
+template <class _Metric, unsigned _Bits>
+const unsigned log_histogram<_Metric, _Bits>::digits;
+
+template <class _Metric, unsigned _Bits>
+const std::size_t log_histogram<_Metric, _Bits>::buckets;
+
+} // namespace metric
+
+#endif // METRICS_SKETCH_HPP
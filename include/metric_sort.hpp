@@ -0,0 +1,282 @@
+// -*- C++ -*-
+//
+//===---------------------------- sort ------------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_SORT_HPP
+#define METRICS_SORT_HPP
+
+#include "metric_config.hpp"
+#include "metric_half.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace metric {
+
+// Counts mapped to unsigned keys of the same size and the same order: the sign bit of
+// integers is flipped, floats are flipped whole when negative, only their sign bit otherwise.
+// Negative zero comes before zero, NaNs at the ends following their sign.
+template <std::size_t _Size> struct __radix_unsigned;
+template <> struct __radix_unsigned<1> {typedef unsigned char      type;};
+template <> struct __radix_unsigned<2> {typedef unsigned short     type;};
+template <> struct __radix_unsigned<4> {typedef unsigned int       type;};
+template <> struct __radix_unsigned<8> {typedef unsigned long long type;};
+
+template <class _Rep, bool = std::is_floating_point<_Rep>::value, bool = std::is_signed<_Rep>::value>
+struct __radix_key
+{
+    static_assert(std::is_arithmetic<_Rep>::value, "radix sorts need an integral or floating representation");
+
+    typedef typename __radix_unsigned<sizeof(_Rep)>::type type;
+
+    static inline type __to(_Rep __r) {return static_cast<type>(__r);}
+    static inline _Rep __from(type __k) {return static_cast<_Rep>(__k);}
+};
+
+template <class _Rep>
+struct __radix_key<_Rep, false, true>
+{
+    typedef typename __radix_unsigned<sizeof(_Rep)>::type type;
+    static const type __sign = static_cast<type>(type(1) << (sizeof(type) * 8 - 1));
+
+    static inline type __to(_Rep __r) {return static_cast<type>(static_cast<type>(__r) ^ __sign);}
+    static inline _Rep __from(type __k) {return static_cast<_Rep>(static_cast<type>(__k ^ __sign));}
+};
+
+template <class _Rep>
+struct __radix_key<_Rep, true, true>
+{
+    typedef typename __radix_unsigned<sizeof(_Rep)>::type type;
+    static const type __sign = static_cast<type>(type(1) << (sizeof(type) * 8 - 1));
+
+    static inline type __to(_Rep __r)
+    {
+        type __b;
+        std::memcpy(&__b, &__r, sizeof(__b));
+        return (__b & __sign) ? static_cast<type>(~__b) : static_cast<type>(__b | __sign);
+    }
+
+    static inline _Rep __from(type __k)
+    {
+        const type __b = (__k & __sign) ? static_cast<type>(__k & ~__sign) : static_cast<type>(~__k);
+        _Rep __r;
+        std::memcpy(&__r, &__b, sizeof(__r));
+        return __r;
+    }
+};
+
+// float16 and bfloat16 are mapped from their bits, as the other floats.
+template <class _Format>
+struct __radix_key<__half_float<_Format>, false, false>
+{
+    typedef unsigned short type;
+    static const type __sign = 0x8000;
+
+    static inline type __to(const __half_float<_Format>& __r)
+    {
+        const type __b = __r.bits();
+        return (__b & __sign) ? static_cast<type>(~__b) : static_cast<type>(__b | __sign);
+    }
+
+    static inline __half_float<_Format> __from(type __k)
+    {
+        return __half_float<_Format>::from_bits((__k & __sign) ? static_cast<type>(__k & ~__sign) : static_cast<type>(~__k));
+    }
+};
+
+static const std::size_t __radix_small = 256;
+
+// Least significant digit first, a byte at a time, stable.  The histograms of every digit are
+// filled while the keys are built; digits where all keys agree are skipped.
+template <class _Key, class _Payload>
+class __radix_sorter
+{
+    static const std::size_t __digits = sizeof(_Key);
+    static const bool __has_payload = !std::is_empty<_Payload>::value;
+
+    std::vector<_Key>     __keys_;
+    std::vector<_Payload> __payload_;
+    std::size_t           __hist_[__digits][256];
+
+public:
+    inline __radix_sorter() {std::memset(__hist_, 0, sizeof(__hist_));}
+
+    inline void reserve(std::size_t __n) {__keys_.reserve(__n); __payload_.reserve(__n);}
+    inline std::size_t size() const {return __keys_.size();}
+
+    inline void push_back(_Key __k, const _Payload& __p)
+    {
+        for (std::size_t __d = 0; __d < __digits; ++__d)
+            ++__hist_[__d][(__k >> (8 * __d)) & 0xff];
+        __keys_.push_back(__k);
+        if (__has_payload)
+            __payload_.push_back(__p);
+    }
+
+    inline void clear()
+    {
+        __keys_.clear();
+        __payload_.clear();
+        std::memset(__hist_, 0, sizeof(__hist_));
+    }
+
+    inline const std::vector<_Key>& keys() const {return __keys_;}
+    inline const std::vector<_Payload>& payload() const {return __payload_;}
+
+    void sort()
+    {
+        const std::size_t __n = __keys_.size();
+        if (__n < __radix_small)
+        {
+            std::vector<std::size_t> __order(__n);
+            for (std::size_t __i = 0; __i < __n; ++__i)
+                __order[__i] = __i;
+            const std::vector<_Key>& __k = __keys_;
+            std::stable_sort(__order.begin(), __order.end(), [&](std::size_t __a, std::size_t __b) {return __k[__a] < __k[__b];});
+            std::vector<_Key> __sk(__n);
+            std::vector<_Payload> __sp(__has_payload ? __n : 0);
+            for (std::size_t __i = 0; __i < __n; ++__i)
+            {
+                __sk[__i] = __keys_[__order[__i]];
+                if (__has_payload)
+                    __sp[__i] = __payload_[__order[__i]];
+            }
+            __keys_.swap(__sk);
+            __payload_.swap(__sp);
+            return;
+        }
+
+        std::vector<_Key> __tk(__n);
+        std::vector<_Payload> __tp(__has_payload ? __n : 0);
+        for (std::size_t __d = 0; __d < __digits; ++__d)
+        {
+            std::size_t* __h = __hist_[__d];
+            const unsigned __shift = static_cast<unsigned>(8 * __d);
+            if (__h[(__keys_[0] >> __shift) & 0xff] == __n)
+                continue;
+            std::size_t __offsets[256];
+            std::size_t __sum = 0;
+            for (std::size_t __b = 0; __b < 256; ++__b)
+            {
+                __offsets[__b] = __sum;
+                __sum += __h[__b];
+            }
+            for (std::size_t __i = 0; __i < __n; ++__i)
+            {
+                const std::size_t __pos = __offsets[(__keys_[__i] >> __shift) & 0xff]++;
+                __tk[__pos] = __keys_[__i];
+                if (__has_payload)
+                    __tp[__pos] = __payload_[__i];
+            }
+            __keys_.swap(__tk);
+            __payload_.swap(__tp);
+        }
+    }
+};
+
+// Sorts only keys: the metrics are rebuilt from them.
+struct __no_payload {};
+
+
+// Sorts a range of metrics with an integral or floating representation in ascending order.
+template <class _RandomAccessIterator>
+void radix_sort(_RandomAccessIterator __first, _RandomAccessIterator __last)
+{
+    typedef typename std::iterator_traits<_RandomAccessIterator>::value_type _Metric;
+    typedef __radix_key<typename _Metric::rep> _Kt;
+    const std::size_t __n = static_cast<std::size_t>(__last - __first);
+    __radix_sorter<typename _Kt::type, __no_payload> __s;
+    __s.reserve(__n);
+    for (_RandomAccessIterator __i = __first; __i != __last; ++__i)
+        __s.push_back(_Kt::__to((*__i).count()), __no_payload());
+    __s.sort();
+    for (std::size_t __i = 0; __i < __n; ++__i, (void) ++__first)
+        *__first = _Metric(_Kt::__from(__s.keys()[__i]));
+}
+
+// Writes the indices of the elements in ascending order; equal elements keep their order.
+template <class _RandomAccessIterator, class _OutputIterator>
+_OutputIterator radix_argsort(_RandomAccessIterator __first, _RandomAccessIterator __last, _OutputIterator __out)
+{
+    typedef typename std::iterator_traits<_RandomAccessIterator>::value_type _Metric;
+    typedef __radix_key<typename _Metric::rep> _Kt;
+    const std::size_t __n = static_cast<std::size_t>(__last - __first);
+    __radix_sorter<typename _Kt::type, std::size_t> __s;
+    __s.reserve(__n);
+    for (std::size_t __i = 0; __i < __n; ++__i)
+        __s.push_back(_Kt::__to((*(__first + __i)).count()), __i);
+    __s.sort();
+    return std::copy(__s.payload().begin(), __s.payload().end(), __out);
+}
+
+
+// Sorts ranges of metrics of one kind in different units together.  Each element is converted
+// to _Common while its key is built, in the single pass that also fills the histograms.  The
+// order is the one of the values converted to _Common: with an integral _Common, values that
+// only differ by less than one _Common count compare equal.
+template <class _Common>
+class mixed_unit_sorter
+{
+    typedef __radix_key<typename _Common::rep> _Kt;
+
+    __radix_sorter<typename _Kt::type, std::size_t> __s_;
+    bool __sorted_;
+
+    inline void __sort()
+    {
+        if (!__sorted_)
+            __s_.sort();
+        __sorted_ = true;
+    }
+
+public:
+    typedef _Common value_type;
+
+    inline mixed_unit_sorter() : __sorted_(false) {}
+
+    // Appends a range; its elements are numbered after the ones of the ranges added before.
+    template <class _InputIterator>
+    void add(_InputIterator __first, _InputIterator __last)
+    {
+        typedef typename std::iterator_traits<_InputIterator>::value_type _Metric;
+        const __metric_cast<_Metric, _Common> __cast = __metric_cast<_Metric, _Common>();
+        for (; __first != __last; ++__first)
+            __s_.push_back(_Kt::__to(__cast(*__first).count()), __s_.size());
+        __sorted_ = false;
+    }
+
+    inline std::size_t size() const {return __s_.size();}
+    inline void clear() {__s_.clear(); __sorted_ = false;}
+
+    // All the elements added, in ascending order, in _Common.
+    template <class _OutputIterator>
+    _OutputIterator sort(_OutputIterator __out)
+    {
+        __sort();
+        for (std::size_t __i = 0; __i < __s_.size(); ++__i, (void) ++__out)
+            *__out = _Common(_Kt::__from(__s_.keys()[__i]));
+        return __out;
+    }
+
+    // Numbers of the elements added, in ascending order.
+    template <class _OutputIterator>
+    _OutputIterator argsort(_OutputIterator __out)
+    {
+        __sort();
+        return std::copy(__s_.payload().begin(), __s_.payload().end(), __out);
+    }
+};
+
+} // namespace metric
+
+#endif // METRICS_SORT_HPP
@@ -0,0 +1,211 @@
+// -*- C++ -*-
+//
+//===---------------------------- span ------------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_SPAN_HPP
+#define METRICS_SPAN_HPP
+
+#include "metric_config.hpp"
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace metric {
+
+// A metric laid out exactly as its representation: an array of reps can be read in place as
+// an array of metrics.  True for every metric of this library with a trivially copyable rep.
+template <class _Metric>
+struct is_rep_layout_compatible
+    : std::integral_constant<bool,
+        std::is_standard_layout<_Metric>::value &&
+        std::is_trivially_copyable<_Metric>::value &&
+        sizeof(_Metric) == sizeof(typename _Metric::rep) &&
+        alignof(_Metric) == alignof(typename _Metric::rep)> {};
+
+// Representation of _Metric, with the constness of _Metric.
+template <class _Metric>
+struct __span_rep
+{
+    typedef typename std::conditional<std::is_const<_Metric>::value,
+                                      const typename _Metric::rep, typename _Metric::rep>::type type;
+};
+
+
+// Contiguous metrics, or reps read as metrics, without copy.  The metric may be const.
+template <class _Metric>
+class quantity_span
+{
+    static_assert(is_rep_layout_compatible<typename std::remove_cv<_Metric>::type>::value,
+                  "quantity_span needs a metric laid out as its representation");
+
+public:
+    typedef _Metric element_type;
+    typedef typename std::remove_cv<_Metric>::type value_type;
+    typedef typename __span_rep<_Metric>::type rep;
+    typedef _Metric* iterator;
+    typedef std::size_t size_type;
+
+private:
+    _Metric*  __data_;
+    size_type __size_;
+
+public:
+    inline METRICCONSTEXPR quantity_span() : __data_(nullptr), __size_(0) {}
+    inline METRICCONSTEXPR quantity_span(_Metric* __p, size_type __n) : __data_(__p), __size_(__n) {}
+    inline quantity_span(rep* __p, size_type __n) : __data_(reinterpret_cast<_Metric*>(__p)), __size_(__n) {}
+
+    // quantity_span<M> to quantity_span<const M>.
+    template <class _Metric2, typename std::enable_if<std::is_convertible<_Metric2*, _Metric*>::value, int>::type = 0>
+    inline METRICCONSTEXPR quantity_span(const quantity_span<_Metric2>& __s) : __data_(__s.data()), __size_(__s.size()) {}
+
+    inline METRICCONSTEXPR _Metric* data() const {return __data_;}
+    inline rep* counts() const {return reinterpret_cast<rep*>(__data_);}
+    inline METRICCONSTEXPR size_type size() const {return __size_;}
+    inline METRICCONSTEXPR bool empty() const {return __size_ == 0;}
+
+    inline METRICCONSTEXPR iterator begin() const {return __data_;}
+    inline METRICCONSTEXPR iterator end() const {return __data_ + __size_;}
+    inline METRICCONSTEXPR _Metric& operator[](size_type __i) const {return __data_[__i];}
+
+    inline METRICCONSTEXPR quantity_span first(size_type __n) const {return quantity_span(__data_, __n);}
+    inline METRICCONSTEXPR quantity_span last(size_type __n) const {return quantity_span(__data_ + __size_ - __n, __n);}
+    inline METRICCONSTEXPR quantity_span subspan(size_type __offset, size_type __n) const {return quantity_span(__data_ + __offset, __n);}
+};
+
+
+// Random access iterator stepping over __stride metrics at a time.  It holds the first metric
+// and an index: the address of a metric is formed only when it is read, so the end of a
+// channel of an interleaved buffer does not point past the buffer.
+template <class _Metric>
+class strided_iterator
+{
+public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef typename std::remove_cv<_Metric>::type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef _Metric* pointer;
+    typedef _Metric& reference;
+
+private:
+    _Metric*       __base_;
+    std::ptrdiff_t __i_;
+    std::ptrdiff_t __stride_;
+
+public:
+    inline METRICCONSTEXPR strided_iterator() : __base_(nullptr), __i_(0), __stride_(1) {}
+    inline METRICCONSTEXPR strided_iterator(_Metric* __base, std::ptrdiff_t __i, std::ptrdiff_t __stride)
+        : __base_(__base), __i_(__i), __stride_(__stride) {}
+
+    inline METRICCONSTEXPR reference operator*() const {return __base_[__i_ * __stride_];}
+    inline METRICCONSTEXPR pointer operator->() const {return __base_ + __i_ * __stride_;}
+    inline METRICCONSTEXPR reference operator[](difference_type __n) const {return __base_[(__i_ + __n) * __stride_];}
+
+    inline strided_iterator& operator++() {++__i_; return *this;}
+    inline strided_iterator  operator++(int) {strided_iterator __t(*this); ++__i_; return __t;}
+    inline strided_iterator& operator--() {--__i_; return *this;}
+    inline strided_iterator  operator--(int) {strided_iterator __t(*this); --__i_; return __t;}
+    inline strided_iterator& operator+=(difference_type __n) {__i_ += __n; return *this;}
+    inline strided_iterator& operator-=(difference_type __n) {__i_ -= __n; return *this;}
+
+    inline METRICCONSTEXPR strided_iterator operator+(difference_type __n) const {return strided_iterator(__base_, __i_ + __n, __stride_);}
+    inline METRICCONSTEXPR strided_iterator operator-(difference_type __n) const {return strided_iterator(__base_, __i_ - __n, __stride_);}
+    inline METRICCONSTEXPR difference_type operator-(const strided_iterator& __o) const {return __i_ - __o.__i_;}
+    friend inline METRICCONSTEXPR strided_iterator operator+(difference_type __n, const strided_iterator& __i) {return __i + __n;}
+
+    // Iterators of the same span share their first metric and their stride.
+    inline METRICCONSTEXPR bool operator==(const strided_iterator& __o) const {return __i_ == __o.__i_;}
+    inline METRICCONSTEXPR bool operator!=(const strided_iterator& __o) const {return __i_ != __o.__i_;}
+    inline METRICCONSTEXPR bool operator< (const strided_iterator& __o) const {return __i_ <  __o.__i_;}
+    inline METRICCONSTEXPR bool operator> (const strided_iterator& __o) const {return __i_ >  __o.__i_;}
+    inline METRICCONSTEXPR bool operator<=(const strided_iterator& __o) const {return __i_ <= __o.__i_;}
+    inline METRICCONSTEXPR bool operator>=(const strided_iterator& __o) const {return __i_ >= __o.__i_;}
+};
+
+// Every __stride-th metric of a buffer, __size of them.
+template <class _Metric>
+class strided_span
+{
+    static_assert(is_rep_layout_compatible<typename std::remove_cv<_Metric>::type>::value,
+                  "strided_span needs a metric laid out as its representation");
+
+public:
+    typedef _Metric element_type;
+    typedef typename std::remove_cv<_Metric>::type value_type;
+    typedef typename __span_rep<_Metric>::type rep;
+    typedef strided_iterator<_Metric> iterator;
+    typedef std::size_t size_type;
+
+private:
+    _Metric*       __data_;
+    size_type      __size_;
+    std::ptrdiff_t __stride_;
+
+public:
+    inline METRICCONSTEXPR strided_span() : __data_(nullptr), __size_(0), __stride_(1) {}
+    inline METRICCONSTEXPR strided_span(_Metric* __p, size_type __n, std::ptrdiff_t __stride)
+        : __data_(__p), __size_(__n), __stride_(__stride) {}
+    inline strided_span(rep* __p, size_type __n, std::ptrdiff_t __stride)
+        : __data_(reinterpret_cast<_Metric*>(__p)), __size_(__n), __stride_(__stride) {}
+    inline METRICCONSTEXPR strided_span(const quantity_span<_Metric>& __s)
+        : __data_(__s.data()), __size_(__s.size()), __stride_(1) {}
+
+    inline METRICCONSTEXPR _Metric* data() const {return __data_;}
+    inline METRICCONSTEXPR size_type size() const {return __size_;}
+    inline METRICCONSTEXPR std::ptrdiff_t stride() const {return __stride_;}
+    inline METRICCONSTEXPR bool empty() const {return __size_ == 0;}
+
+    inline METRICCONSTEXPR iterator begin() const {return iterator(__data_, 0, __stride_);}
+    inline METRICCONSTEXPR iterator end() const {return iterator(__data_, static_cast<std::ptrdiff_t>(__size_), __stride_);}
+    inline METRICCONSTEXPR _Metric& operator[](size_type __i) const {return __data_[static_cast<std::ptrdiff_t>(__i) * __stride_];}
+};
+
+
+// Multi-channel buffer with the channels interleaved: frame f holds the samples of channels
+// 0 .. channels - 1, channel c is read with a stride of channels.
+template <class _Metric>
+class interleaved_view
+{
+    static_assert(is_rep_layout_compatible<typename std::remove_cv<_Metric>::type>::value,
+                  "interleaved_view needs a metric laid out as its representation");
+
+public:
+    typedef typename __span_rep<_Metric>::type rep;
+    typedef std::size_t size_type;
+
+private:
+    _Metric*  __data_;
+    size_type __frames_;
+    size_type __channels_;
+
+public:
+    inline interleaved_view(rep* __p, size_type __frames, size_type __channels)
+        : __data_(reinterpret_cast<_Metric*>(__p)), __frames_(__frames), __channels_(__channels) {}
+    inline METRICCONSTEXPR interleaved_view(_Metric* __p, size_type __frames, size_type __channels)
+        : __data_(__p), __frames_(__frames), __channels_(__channels) {}
+
+    inline METRICCONSTEXPR size_type frames() const {return __frames_;}
+    inline METRICCONSTEXPR size_type channels() const {return __channels_;}
+
+    inline METRICCONSTEXPR strided_span<_Metric> channel(size_type __c) const
+    {
+        return strided_span<_Metric>(__data_ + __c, __frames_, static_cast<std::ptrdiff_t>(__channels_));
+    }
+
+    inline METRICCONSTEXPR quantity_span<_Metric> frame(size_type __f) const
+    {
+        return quantity_span<_Metric>(__data_ + __f * __channels_, __channels_);
+    }
+
+    inline METRICCONSTEXPR _Metric& operator()(size_type __f, size_type __c) const {return __data_[__f * __channels_ + __c];}
+};
+
+} // namespace metric
+
+#endif // METRICS_SPAN_HPP
@@ -0,0 +1,575 @@
+// -*- C++ -*-
+//
+//===---------------------------- stream ----------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_STREAM_HPP
+#define METRICS_STREAM_HPP
+
+#include "metric_config.hpp"
+
+// Coroutine streams need C++20.  Nothing is declared otherwise.
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define METRIC_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef METRIC_HAS_COROUTINES
+
+#include "metric_dimension.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace metric {
+namespace stream {
+
+// Synchronous lazy sequence: the body runs up to the next co_yield each time the
+// iterator is incremented.
+template <class _Tp>
+class generator
+{
+public:
+    struct promise_type
+    {
+        const _Tp* __value_ = nullptr;
+        std::exception_ptr __error_;
+
+        generator get_return_object() {return generator(std::coroutine_handle<promise_type>::from_promise(*this));}
+        std::suspend_always initial_suspend() noexcept {return {};}
+        std::suspend_always final_suspend() noexcept {return {};}
+        std::suspend_always yield_value(const _Tp& __v) noexcept {__value_ = std::addressof(__v); return {};}
+        void return_void() noexcept {}
+        void unhandled_exception() {__error_ = std::current_exception();}
+        template <class _Up> void await_transform(_Up&&) = delete;   // No co_await in a generator.
+    };
+
+    class iterator
+    {
+        std::coroutine_handle<promise_type> __h_;
+
+        void __advance()
+        {
+            __h_.resume();
+            if (__h_.done())
+            {
+                std::exception_ptr __error = __h_.promise().__error_;
+                __h_ = nullptr;
+                if (__error)
+                    std::rethrow_exception(__error);
+            }
+        }
+
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef _Tp value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const _Tp* pointer;
+        typedef const _Tp& reference;
+
+        iterator() = default;
+        explicit iterator(std::coroutine_handle<promise_type> __h) : __h_(__h) {__advance();}
+
+        reference operator*() const {return *__h_.promise().__value_;}
+        pointer operator->() const {return __h_.promise().__value_;}
+        iterator& operator++() {__advance(); return *this;}
+        void operator++(int) {__advance();}
+        bool operator==(const iterator& __o) const {return __h_ == __o.__h_;}
+        bool operator!=(const iterator& __o) const {return __h_ != __o.__h_;}
+    };
+
+private:
+    std::coroutine_handle<promise_type> __h_;
+
+    explicit generator(std::coroutine_handle<promise_type> __h) : __h_(__h) {}
+
+public:
+    typedef _Tp value_type;
+
+    generator(generator&& __o) noexcept : __h_(std::exchange(__o.__h_, nullptr)) {}
+    generator& operator=(generator&& __o) noexcept
+    {
+        if (this != &__o)
+        {
+            if (__h_)
+                __h_.destroy();
+            __h_ = std::exchange(__o.__h_, nullptr);
+        }
+        return *this;
+    }
+    ~generator() {if (__h_) __h_.destroy();}
+
+    // Single pass.
+    iterator begin() {return __h_ ? iterator(__h_) : iterator();}
+    iterator end() {return iterator();}
+};
+
+
+// Schedulers resume the coroutines posted to them.  The first exception escaping a task is
+// kept and rethrown to the thread joining the tasks, by run() or wait().
+class scheduler
+{
+    std::atomic<std::size_t> __tasks_{0};
+    std::mutex __error_mutex_;
+    std::exception_ptr __error_;
+
+protected:
+    void __rethrow()
+    {
+        std::exception_ptr __error;
+        {
+            std::lock_guard<std::mutex> __lock(__error_mutex_);
+            __error = std::exchange(__error_, nullptr);
+        }
+        if (__error)
+            std::rethrow_exception(__error);
+    }
+
+public:
+    virtual ~scheduler() {}
+    virtual void post(std::coroutine_handle<> __h) = 0;
+
+    // co_await sched.schedule() moves the coroutine onto the scheduler.
+    auto schedule()
+    {
+        struct __awaiter
+        {
+            scheduler& __s_;
+            bool await_ready() const noexcept {return false;}
+            void await_suspend(std::coroutine_handle<> __h) {__s_.post(__h);}
+            void await_resume() const noexcept {}
+        };
+        return __awaiter{*this};
+    }
+
+    std::size_t tasks() const {return __tasks_;}
+
+    void __task_started() {++__tasks_;}
+    virtual void __task_finished() {--__tasks_;}
+
+    void __task_failed(std::exception_ptr __e)
+    {
+        std::lock_guard<std::mutex> __lock(__error_mutex_);
+        if (!__error_)
+            __error_ = __e;
+    }
+};
+
+// Runs everything on the thread calling run().
+class single_thread_scheduler : public scheduler
+{
+    std::mutex __mutex_;
+    std::deque<std::coroutine_handle<> > __ready_;
+
+public:
+    void post(std::coroutine_handle<> __h)
+    {
+        std::lock_guard<std::mutex> __lock(__mutex_);
+        __ready_.push_back(__h);
+    }
+
+    // Resumes the ready coroutines until none is left, then rethrows the first exception
+    // escaping a task.
+    void run()
+    {
+        for (;;)
+        {
+            std::coroutine_handle<> __h;
+            {
+                std::lock_guard<std::mutex> __lock(__mutex_);
+                if (__ready_.empty())
+                    break;
+                __h = __ready_.front();
+                __ready_.pop_front();
+            }
+            __h.resume();
+        }
+        __rethrow();
+    }
+};
+
+// Runs the coroutines on a fixed set of threads.
+class pool_scheduler : public scheduler
+{
+    std::mutex __mutex_;
+    std::condition_variable __ready_cv_;
+    std::condition_variable __idle_cv_;
+    std::deque<std::coroutine_handle<> > __ready_;
+    std::vector<std::thread> __threads_;
+    bool __stop_ = false;
+
+    void __loop()
+    {
+        for (;;)
+        {
+            std::coroutine_handle<> __h;
+            {
+                std::unique_lock<std::mutex> __lock(__mutex_);
+                __ready_cv_.wait(__lock, [&] {return __stop_ || !__ready_.empty();});
+                if (__ready_.empty())
+                    return;
+                __h = __ready_.front();
+                __ready_.pop_front();
+            }
+            __h.resume();
+        }
+    }
+
+public:
+    explicit pool_scheduler(std::size_t __threads = std::thread::hardware_concurrency())
+    {
+        for (std::size_t __i = 0; __i < (__threads ? __threads : 1); ++__i)
+            __threads_.emplace_back([this] {__loop();});
+    }
+
+    ~pool_scheduler()
+    {
+        {
+            std::lock_guard<std::mutex> __lock(__mutex_);
+            __stop_ = true;
+        }
+        __ready_cv_.notify_all();
+        for (std::thread& __t : __threads_)
+            __t.join();
+    }
+
+    void post(std::coroutine_handle<> __h)
+    {
+        {
+            std::lock_guard<std::mutex> __lock(__mutex_);
+            __ready_.push_back(__h);
+        }
+        __ready_cv_.notify_one();
+    }
+
+    void __task_finished()
+    {
+        std::lock_guard<std::mutex> __lock(__mutex_);
+        scheduler::__task_finished();
+        __idle_cv_.notify_all();
+    }
+
+    // Blocks until every spawned task has finished, then rethrows the first exception escaping
+    // a task.
+    void wait()
+    {
+        {
+            std::unique_lock<std::mutex> __lock(__mutex_);
+            __idle_cv_.wait(__lock, [&] {return tasks() == 0;});
+        }
+        __rethrow();
+    }
+};
+
+
+// Coroutine started with spawn(), which owns its own frame.  An exception escaping it ends
+// the task and goes to its scheduler.
+class task
+{
+public:
+    struct promise_type
+    {
+        scheduler* __scheduler_ = nullptr;
+
+        task get_return_object() {return task(std::coroutine_handle<promise_type>::from_promise(*this));}
+        std::suspend_always initial_suspend() noexcept {return {};}
+        std::suspend_never final_suspend() noexcept
+        {
+            if (__scheduler_)
+                __scheduler_->__task_finished();
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception()
+        {
+            if (__scheduler_)
+                __scheduler_->__task_failed(std::current_exception());
+        }
+    };
+
+private:
+    std::coroutine_handle<promise_type> __h_;
+
+    explicit task(std::coroutine_handle<promise_type> __h) : __h_(__h) {}
+    friend void spawn(scheduler&, task);
+
+public:
+    task(task&& __o) noexcept : __h_(std::exchange(__o.__h_, nullptr)) {}
+    task& operator=(task&&) = delete;
+    ~task() {if (__h_) __h_.destroy();}
+};
+
+// Hands the task to the scheduler, which runs it until its end.
+inline void spawn(scheduler& __s, task __t)
+{
+    std::coroutine_handle<task::promise_type> __h = std::exchange(__t.__h_, nullptr);
+    __h.promise().__scheduler_ = &__s;
+    __s.__task_started();
+    __s.post(__h);
+}
+
+
+// Bounded buffer between coroutines.  send() suspends while the buffer is full and
+// receive() while it is empty: a fast producer is slowed down to its consumer.
+// Suspended coroutines are resumed through the scheduler.
+template <class _Tp>
+class channel
+{
+    struct __sender
+    {
+        std::coroutine_handle<> __h_;
+        _Tp* __value_;
+        bool* __sent_;
+    };
+
+    struct __receiver
+    {
+        std::coroutine_handle<> __h_;
+        std::optional<_Tp>* __value_;
+    };
+
+    scheduler& __scheduler_;
+    const std::size_t __capacity_;
+    std::mutex __mutex_;
+    std::deque<_Tp> __buffer_;
+    std::deque<__sender> __senders_;
+    std::deque<__receiver> __receivers_;
+    bool __closed_ = false;
+
+public:
+    channel(scheduler& __s, std::size_t __capacity) : __scheduler_(__s), __capacity_(__capacity ? __capacity : 1) {}
+
+    channel(const channel&) = delete;
+    channel& operator=(const channel&) = delete;
+
+    std::size_t capacity() const {return __capacity_;}
+
+    // co_await ch.send(v): false when the channel is closed.
+    auto send(_Tp __v)
+    {
+        struct __awaiter
+        {
+            channel& __c_;
+            _Tp __value_;
+            bool __sent_ = false;
+
+            bool await_ready() const noexcept {return false;}
+            bool await_suspend(std::coroutine_handle<> __h)
+            {
+                std::lock_guard<std::mutex> __lock(__c_.__mutex_);
+                if (__c_.__closed_)
+                    return false;
+                __sent_ = true;
+                if (!__c_.__receivers_.empty())
+                {
+                    __receiver __r = __c_.__receivers_.front();
+                    __c_.__receivers_.pop_front();
+                    *__r.__value_ = std::move(__value_);
+                    __c_.__scheduler_.post(__r.__h_);
+                    return false;
+                }
+                if (__c_.__buffer_.size() < __c_.__capacity_)
+                {
+                    __c_.__buffer_.push_back(std::move(__value_));
+                    return false;
+                }
+                __sent_ = false;
+                __c_.__senders_.push_back(__sender{__h, &__value_, &__sent_});
+                return true;
+            }
+            bool await_resume() const noexcept {return __sent_;}
+        };
+        return __awaiter{*this, std::move(__v)};
+    }
+
+    // co_await ch.receive(): empty once the channel is closed and drained.
+    auto receive()
+    {
+        struct __awaiter
+        {
+            channel& __c_;
+            std::optional<_Tp> __value_;
+
+            bool await_ready() const noexcept {return false;}
+            bool await_suspend(std::coroutine_handle<> __h)
+            {
+                std::lock_guard<std::mutex> __lock(__c_.__mutex_);
+                if (!__c_.__buffer_.empty())
+                {
+                    __value_ = std::move(__c_.__buffer_.front());
+                    __c_.__buffer_.pop_front();
+                    if (!__c_.__senders_.empty())
+                    {
+                        __sender __s = __c_.__senders_.front();
+                        __c_.__senders_.pop_front();
+                        __c_.__buffer_.push_back(std::move(*__s.__value_));
+                        *__s.__sent_ = true;
+                        __c_.__scheduler_.post(__s.__h_);
+                    }
+                    return false;
+                }
+                if (!__c_.__senders_.empty())
+                {
+                    __sender __s = __c_.__senders_.front();
+                    __c_.__senders_.pop_front();
+                    __value_ = std::move(*__s.__value_);
+                    *__s.__sent_ = true;
+                    __c_.__scheduler_.post(__s.__h_);
+                    return false;
+                }
+                if (__c_.__closed_)
+                    return false;
+                __c_.__receivers_.push_back(__receiver{__h, &__value_});
+                return true;
+            }
+            std::optional<_Tp> await_resume() {return std::move(__value_);}
+        };
+        return __awaiter{*this, std::nullopt};
+    }
+
+    // Wakes up every waiting coroutine: pending sends fail, receives drain the buffer then get nothing.
+    void close()
+    {
+        std::lock_guard<std::mutex> __lock(__mutex_);
+        __closed_ = true;
+        for (const __receiver& __r : __receivers_)
+            __scheduler_.post(__r.__h_);
+        __receivers_.clear();
+        for (const __sender& __s : __senders_)
+            __scheduler_.post(__s.__h_);
+        __senders_.clear();
+    }
+};
+
+
+// Operators on generators.
+
+template <class _Tp, class _Fn>
+generator<std::decay_t<std::invoke_result_t<_Fn&, const _Tp&> > >
+map(generator<_Tp> __in, _Fn __fn)
+{
+    for (const _Tp& __v : __in)
+        co_yield __fn(__v);
+}
+
+template <class _ToMetric, class _Tp>
+generator<_ToMetric>
+cast(generator<_Tp> __in)
+{
+    const __metric_cast<_Tp, _ToMetric> __cast;
+    for (const _Tp& __v : __in)
+        co_yield __cast(__v);
+}
+
+// Consecutive, non overlapping windows of __n values; the last one may be shorter.
+template <class _Tp>
+generator<std::vector<_Tp> >
+window(generator<_Tp> __in, std::size_t __n)
+{
+    std::vector<_Tp> __w;
+    __w.reserve(__n);
+    for (const _Tp& __v : __in)
+    {
+        __w.push_back(__v);
+        if (__w.size() == __n)
+        {
+            co_yield __w;
+            __w.clear();
+        }
+    }
+    if (!__w.empty())
+        co_yield __w;
+}
+
+// Running integral of samples taken every __dt (rectangle rule): the type is the one of
+// sample * __dt, e.g. a volume for a flow rate.
+template <class _Tp, class _Rep, class _Period>
+generator<std::decay_t<decltype(std::declval<const _Tp&>() * std::declval<const std::chrono::duration<_Rep, _Period>&>())> >
+integrate(generator<_Tp> __in, std::chrono::duration<_Rep, _Period> __dt)
+{
+    typedef std::decay_t<decltype(std::declval<const _Tp&>() * __dt)> _Integral;
+    _Integral __total = _Integral::zero();
+    for (const _Tp& __v : __in)
+    {
+        __total += __v * __dt;
+        co_yield __total;
+    }
+}
+
+
+// Operators on channels: each is a task reading __in until it is closed, then closing __out.
+
+template <class _In, class _Out, class _Fn>
+task map(channel<_In>& __in, channel<_Out>& __out, _Fn __fn)
+{
+    while (std::optional<_In> __v = co_await __in.receive())
+        if (!co_await __out.send(__fn(*__v)))
+            break;
+    __out.close();
+}
+
+template <class _In, class _Out>
+task cast(channel<_In>& __in, channel<_Out>& __out)
+{
+    const __metric_cast<_In, _Out> __cast;
+    while (std::optional<_In> __v = co_await __in.receive())
+        if (!co_await __out.send(__cast(*__v)))
+            break;
+    __out.close();
+}
+
+template <class _Tp>
+task window(channel<_Tp>& __in, channel<std::vector<_Tp> >& __out, std::size_t __n)
+{
+    std::vector<_Tp> __w;
+    while (std::optional<_Tp> __v = co_await __in.receive())
+    {
+        __w.push_back(*__v);
+        if (__w.size() == __n)
+        {
+            if (!co_await __out.send(std::move(__w)))
+                break;
+            __w.clear();
+        }
+    }
+    if (!__w.empty())
+        co_await __out.send(std::move(__w));
+    __out.close();
+}
+
+template <class _Tp, class _Integral, class _Rep, class _Period>
+task integrate(channel<_Tp>& __in, channel<_Integral>& __out, std::chrono::duration<_Rep, _Period> __dt)
+{
+    _Integral __total = _Integral::zero();
+    while (std::optional<_Tp> __v = co_await __in.receive())
+    {
+        __total += *__v * __dt;
+        if (!co_await __out.send(__total))
+            break;
+    }
+    __out.close();
+}
+
+} // namespace stream
+} // namespace metric
+
+#endif // METRIC_HAS_COROUTINES
+
+#endif // METRICS_STREAM_HPP
@@ -0,0 +1,372 @@
+// -*- C++ -*-
+//
+//===---------------------------- summation -------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_SUMMATION_HPP
+#define METRICS_SUMMATION_HPP
+
+#include "metric_config.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace metric {
+
+// Accumulators of metrics with a floating point representation.
+// The compensations rely on IEEE arithmetic: they are defeated by -ffast-math and alike.
+
+// Kahan compensated summation.
+template <class _Metric>
+class kahan_accumulator
+{
+    static_assert(std::is_floating_point<typename _Metric::rep>::value, "kahan_accumulator needs a floating point representation");
+
+public:
+    typedef _Metric metric_type;
+    typedef typename _Metric::rep rep;
+
+private:
+    rep __sum_;
+    rep __c_;
+
+public:
+    inline kahan_accumulator() : __sum_(0), __c_(0) {}
+
+    inline kahan_accumulator& operator+=(const _Metric& __m)
+    {
+        const rep __y = __m.count() - __c_;
+        const rep __t = __sum_ + __y;
+        __c_ = (__t - __sum_) - __y;
+        __sum_ = __t;
+        return *this;
+    }
+
+    template <class _InputIterator>
+    inline kahan_accumulator& add(_InputIterator __first, _InputIterator __last)
+    {
+        for (; __first != __last; ++__first)
+            *this += *__first;
+        return *this;
+    }
+
+    inline _Metric value() const {return _Metric(__sum_ - __c_);}
+};
+
+
+// Neumaier (improved Kahan-Babuska) summation: also exact when an addend is larger than the sum.
+template <class _Metric>
+class neumaier_accumulator
+{
+    static_assert(std::is_floating_point<typename _Metric::rep>::value, "neumaier_accumulator needs a floating point representation");
+
+public:
+    typedef _Metric metric_type;
+    typedef typename _Metric::rep rep;
+
+private:
+    rep __sum_;
+    rep __c_;
+
+    static inline void __add(rep& __s, rep& __c, const rep& __x)
+    {
+        const rep __t = __s + __x;
+        __c += std::fabs(__s) >= std::fabs(__x) ? (__s - __t) + __x : (__x - __t) + __s;
+        __s = __t;
+    }
+
+public:
+    inline neumaier_accumulator() : __sum_(0), __c_(0) {}
+
+    inline neumaier_accumulator& operator+=(const _Metric& __m)
+    {
+        __add(__sum_, __c_, __m.count());
+        return *this;
+    }
+
+    // Batch add: four independent compensated lanes, merged at the end.
+    template <class _ForwardIterator>
+    neumaier_accumulator& add(_ForwardIterator __first, _ForwardIterator __last)
+    {
+        rep __s[4] = {0, 0, 0, 0};
+        rep __c[4] = {0, 0, 0, 0};
+        for (typename std::iterator_traits<_ForwardIterator>::difference_type __n = std::distance(__first, __last);
+             __n >= 4; __n -= 4)
+            for (int __l = 0; __l < 4; ++__l, (void) ++__first)
+                __add(__s[__l], __c[__l], __first->count());
+        for (; __first != __last; ++__first)
+            __add(__s[0], __c[0], __first->count());
+        for (int __l = 0; __l < 4; ++__l)
+        {
+            __add(__sum_, __c_, __s[__l]);
+            __c_ += __c[__l];
+        }
+        return *this;
+    }
+
+    inline neumaier_accumulator& merge(const neumaier_accumulator& __other)
+    {
+        __add(__sum_, __c_, __other.__sum_);
+        __c_ += __other.__c_;
+        return *this;
+    }
+
+    inline _Metric value() const {return _Metric(__sum_ + __c_);}
+};
+
+
+// Exact summation: every addend is spread without rounding over a fixed point register
+// covering the whole double range, in 32-bit limbs held in 64-bit integers (the upper half
+// absorbs carries, propagated every 2^29 additions).  The sum only depends on the multiset
+// of addends: it is bit-identical whatever the order or the split between accumulators.
+// The result is the exact sum rounded to double once, then converted to the representation.
+template <class _Metric>
+class reproducible_accumulator
+{
+    static_assert(std::is_floating_point<typename _Metric::rep>::value &&
+                  sizeof(typename _Metric::rep) <= sizeof(double),
+                  "reproducible_accumulator needs a float or double representation");
+
+public:
+    typedef _Metric metric_type;
+    typedef typename _Metric::rep rep;
+
+private:
+    // Bit 0 of the register weights 2^-1074, the smallest subnormal.
+    static const int __limbs = 68;
+    static const unsigned long __carry_interval = 1UL << 29;
+
+    long long     __l_[__limbs];
+    unsigned long __pending_;
+    bool          __nan_;
+    bool          __pinf_;
+    bool          __ninf_;
+
+    inline void __normalize()
+    {
+        for (int __i = 0; __i + 1 < __limbs; ++__i)
+        {
+            __l_[__i + 1] += __l_[__i] >> 32;
+            __l_[__i] &= 0xffffffffLL;
+        }
+        __pending_ = 0;
+    }
+
+    inline void __spread(double __x)
+    {
+        unsigned long long __bits;
+        std::memcpy(&__bits, &__x, sizeof(__bits));
+        const int __exp = static_cast<int>((__bits >> 52) & 0x7ff);
+        unsigned long long __m = __bits & 0xfffffffffffffULL;
+        const bool __neg = (__bits >> 63) != 0;
+        if (__exp == 0x7ff)
+        {
+            if (__m != 0)
+                __nan_ = true;
+            else
+                (__neg ? __ninf_ : __pinf_) = true;
+            return;
+        }
+        if (__exp != 0)
+            __m |= 1ULL << 52;
+        const int __pos = __exp == 0 ? 0 : __exp - 1;
+        const int __k = __pos / 32;
+        const int __s = __pos % 32;
+        const unsigned long long __lo = (__m & 0xffffffffULL) << __s;
+        const unsigned long long __hi = (__m >> 32) << __s;
+        const long long __d0 = static_cast<long long>(__lo & 0xffffffffULL);
+        const long long __d1 = static_cast<long long>((__lo >> 32) + (__hi & 0xffffffffULL));
+        const long long __d2 = static_cast<long long>(__hi >> 32);
+        if (__neg)
+        {
+            __l_[__k] -= __d0;
+            __l_[__k + 1] -= __d1;
+            __l_[__k + 2] -= __d2;
+        }
+        else
+        {
+            __l_[__k] += __d0;
+            __l_[__k + 1] += __d1;
+            __l_[__k + 2] += __d2;
+        }
+    }
+
+#if defined(__AVX2__)
+    // __spread of four addends: the limb index and the three signed digits of each are worked
+    // out four lanes at a time, then added to the register one addend after the other (two
+    // addends may hit the same limbs).  Infinities and NaNs take the scalar path.
+    inline void __spread4(const double* __x)
+    {
+        const __m256i __zero = _mm256_setzero_si256();
+        const __m256i __low32 = _mm256_set1_epi64x(0xffffffffLL);
+        const __m256i __bits = _mm256_castpd_si256(_mm256_loadu_pd(__x));
+        const __m256i __exp = _mm256_and_si256(_mm256_srli_epi64(__bits, 52), _mm256_set1_epi64x(0x7ff));
+        if (!_mm256_testz_si256(_mm256_cmpeq_epi64(__exp, _mm256_set1_epi64x(0x7ff)), _mm256_set1_epi64x(-1)))
+        {
+            for (int __i = 0; __i < 4; ++__i)
+                __spread(__x[__i]);
+            return;
+        }
+        // All ones for normal numbers, which have the implicit bit and a position of exp - 1.
+        const __m256i __normal = _mm256_xor_si256(_mm256_cmpeq_epi64(__exp, __zero), _mm256_set1_epi64x(-1));
+        const __m256i __m = _mm256_or_si256(_mm256_and_si256(__bits, _mm256_set1_epi64x(0xfffffffffffffLL)),
+                                            _mm256_and_si256(__normal, _mm256_set1_epi64x(1LL << 52)));
+        const __m256i __pos = _mm256_add_epi64(__exp, __normal);
+        const __m256i __s = _mm256_and_si256(__pos, _mm256_set1_epi64x(31));
+        const __m256i __lo = _mm256_sllv_epi64(_mm256_and_si256(__m, __low32), __s);
+        const __m256i __hi = _mm256_sllv_epi64(_mm256_srli_epi64(__m, 32), __s);
+        // Negative addends are subtracted: digits negated as (d ^ -1) + 1.
+        const __m256i __neg = _mm256_sub_epi64(__zero, _mm256_srli_epi64(__bits, 63));
+        long long __k[4], __d0[4], __d1[4], __d2[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(__k), _mm256_srli_epi64(__pos, 5));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(__d0),
+                            _mm256_sub_epi64(_mm256_xor_si256(_mm256_and_si256(__lo, __low32), __neg), __neg));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(__d1),
+                            _mm256_sub_epi64(_mm256_xor_si256(_mm256_add_epi64(_mm256_srli_epi64(__lo, 32),
+                                                                               _mm256_and_si256(__hi, __low32)), __neg), __neg));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(__d2),
+                            _mm256_sub_epi64(_mm256_xor_si256(_mm256_srli_epi64(__hi, 32), __neg), __neg));
+        for (int __i = 0; __i < 4; ++__i)
+        {
+            __l_[__k[__i]] += __d0[__i];
+            __l_[__k[__i] + 1] += __d1[__i];
+            __l_[__k[__i] + 2] += __d2[__i];
+        }
+    }
+#endif
+
+public:
+    inline reproducible_accumulator() : __pending_(0), __nan_(false), __pinf_(false), __ninf_(false)
+    {
+        for (int __i = 0; __i < __limbs; ++__i)
+            __l_[__i] = 0;
+    }
+
+    inline reproducible_accumulator& operator+=(const _Metric& __m)
+    {
+        __spread(static_cast<double>(__m.count()));
+        if (++__pending_ == __carry_interval)
+            __normalize();
+        return *this;
+    }
+
+    // Batch add: the carries are checked once per block instead of once per addend, and with
+    // AVX2 the addends are spread four at a time.
+    template <class _InputIterator>
+    reproducible_accumulator& add(_InputIterator __first, _InputIterator __last)
+    {
+        while (__first != __last)
+        {
+            unsigned long __room = __carry_interval - __pending_;
+#if defined(__AVX2__)
+            for (; __room >= 4 && __first != __last; )
+            {
+                double __x[4];
+                unsigned long __n = 0;
+                for (; __n < 4 && __first != __last; ++__n, (void) ++__first)
+                    __x[__n] = static_cast<double>(__first->count());
+                if (__n == 4)
+                    __spread4(__x);
+                else
+                    for (unsigned long __i = 0; __i < __n; ++__i)
+                        __spread(__x[__i]);
+                __room -= __n;
+                __pending_ += __n;
+            }
+#endif
+            for (; __room != 0 && __first != __last; --__room, (void) ++__first, (void) ++__pending_)
+                __spread(static_cast<double>(__first->count()));
+            if (__pending_ == __carry_interval)
+                __normalize();
+        }
+        return *this;
+    }
+
+    inline reproducible_accumulator& merge(const reproducible_accumulator& __other)
+    {
+        __normalize();
+        reproducible_accumulator __o(__other);
+        __o.__normalize();
+        for (int __i = 0; __i < __limbs; ++__i)
+            __l_[__i] += __o.__l_[__i];
+        __nan_  |= __other.__nan_;
+        __pinf_ |= __other.__pinf_;
+        __ninf_ |= __other.__ninf_;
+        return *this;
+    }
+
+    _Metric value() const
+    {
+        if (__nan_ || (__pinf_ && __ninf_))
+            return _Metric(static_cast<rep>(std::numeric_limits<double>::quiet_NaN()));
+        if (__pinf_ || __ninf_)
+            return _Metric(static_cast<rep>(__pinf_ ? std::numeric_limits<double>::infinity()
+                                                    : -std::numeric_limits<double>::infinity()));
+
+        // Canonical form: limbs in [0, 2^32), the sign in the top limb, then the magnitude.
+        reproducible_accumulator __a(*this);
+        __a.__normalize();
+        const bool __neg = __a.__l_[__limbs - 1] < 0;
+        if (__neg)
+        {
+            for (int __i = 0; __i < __limbs; ++__i)
+                __a.__l_[__i] = -__a.__l_[__i];
+            __a.__normalize();
+        }
+        int __h = __limbs - 1;
+        while (__h >= 0 && __a.__l_[__h] == 0)
+            --__h;
+        if (__h < 0)
+            return _Metric(rep(0));
+        if (__a.__l_[__h] > 0xffffffffLL)
+            return _Metric(static_cast<rep>(__neg ? -std::numeric_limits<double>::infinity()
+                                                  :  std::numeric_limits<double>::infinity()));
+
+        // The 64 leading bits, with a sticky bit for everything below: a single rounding to double.
+        const unsigned long long __l0 = static_cast<unsigned long long>(__a.__l_[__h]);
+        const unsigned long long __l1 = __h >= 1 ? static_cast<unsigned long long>(__a.__l_[__h - 1]) : 0;
+        const unsigned long long __l2 = __h >= 2 ? static_cast<unsigned long long>(__a.__l_[__h - 2]) : 0;
+        int __sh = 0;
+        while ((__l0 << __sh & 0x80000000ULL) == 0)
+            ++__sh;
+        unsigned long long __top = (__l0 << (32 + __sh)) | (__l1 << __sh) | (__l2 >> (32 - __sh));
+        bool __sticky = (__l2 & ((1ULL << (32 - __sh)) - 1)) != 0;
+        for (int __i = __h - 3; __i >= 0 && !__sticky; --__i)
+            __sticky = __a.__l_[__i] != 0;
+        if (__sticky)
+            __top |= 1;
+        const double __r = std::ldexp(static_cast<double>(__top), 32 * (__h - 1) - __sh - 1074);
+        return _Metric(static_cast<rep>(__neg ? -__r : __r));
+    }
+};
+
+template <class _Metric>
+const int reproducible_accumulator<_Metric>::__limbs;
+
+template <class _Metric>
+const unsigned long reproducible_accumulator<_Metric>::__carry_interval;
+
+
+// Order independent sum of a range.
+template <class _InputIterator>
+inline
+typename std::iterator_traits<_InputIterator>::value_type
+reproducible_sum(_InputIterator __first, _InputIterator __last)
+{
+    return reproducible_accumulator<typename std::iterator_traits<_InputIterator>::value_type>().add(__first, __last).value();
+}
+
+} // namespace metric
+
+#endif // METRICS_SUMMATION_HPP
@@ -0,0 +1,528 @@
+// -*- C++ -*-
+//
+//===---------------------------- wide integer ----------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_WIDEINT_HPP
+#define METRICS_WIDEINT_HPP
+
+#include "metric_config.hpp"
+#include <cmath>
+#include <string>
+
+#if defined(__SIZEOF_INT128__)
+	#define METRIC_HAS_INT128 1
+#endif
+
+namespace metric {
+
+#ifdef METRIC_HAS_INT128
+
+__extension__ typedef          __int128  int128;
+__extension__ typedef unsigned __int128 uint128;
+
+template <>
+struct limits_values<int128>
+{
+public:
+    inline static METRICCONSTEXPR int128 zero() {return int128(0);}
+    inline static METRICCONSTEXPR int128 max()  {return static_cast<int128>(~uint128(0) >> 1);}
+    inline static METRICCONSTEXPR int128 min()  {return -max() - 1;}
+};
+
+template <>
+struct limits_values<uint128>
+{
+public:
+    inline static METRICCONSTEXPR uint128 zero() {return uint128(0);}
+    inline static METRICCONSTEXPR uint128 max()  {return ~uint128(0);}
+    inline static METRICCONSTEXPR uint128 min()  {return uint128(0);}
+};
+
+template <> struct __is_integer_rep<int128>  : std::true_type {};
+template <> struct __is_integer_rep<uint128> : std::true_type {};
+template <> struct __is_scalar_rep<int128>   : std::true_type {};
+template <> struct __is_scalar_rep<uint128>  : std::true_type {};
+
+#endif // METRIC_HAS_INT128
+
+
+// Fixed width 256 bits two's complement integer.
+// Usable as representation of every metric, it keeps long horizon counters exact without allocation.
+class int256
+{
+public:
+    typedef unsigned long long limb_type;
+
+private:
+    limb_type __l_[4];  // Little endian limbs.
+
+    struct __raw {};
+
+    inline METRICCONSTEXPR
+    int256(__raw, limb_type __l0, limb_type __l1, limb_type __l2, limb_type __l3)
+        : __l_{__l0, __l1, __l2, __l3} {}
+
+    static inline METRICCONSTEXPR limb_type __fill(bool __negative) {return __negative ? ~limb_type(0) : limb_type(0);}
+
+    // 64 x 64 -> 128 bits product.
+    static inline void __mul64(limb_type __a, limb_type __b, limb_type& __hi, limb_type& __lo)
+    {
+#ifdef METRIC_HAS_INT128
+        uint128 __p = static_cast<uint128>(__a) * __b;
+        __lo = static_cast<limb_type>(__p);
+        __hi = static_cast<limb_type>(__p >> 64);
+#else
+        const limb_type __mask = 0xffffffffULL;
+        limb_type __a0 = __a & __mask, __a1 = __a >> 32;
+        limb_type __b0 = __b & __mask, __b1 = __b >> 32;
+        limb_type __p00 = __a0 * __b0, __p01 = __a0 * __b1;
+        limb_type __p10 = __a1 * __b0, __p11 = __a1 * __b1;
+        limb_type __mid = (__p00 >> 32) + (__p01 & __mask) + (__p10 & __mask);
+        __lo = (__mid << 32) | (__p00 & __mask);
+        __hi = __p11 + (__p01 >> 32) + (__p10 >> 32) + (__mid >> 32);
+#endif
+    }
+
+    // Constant expression helpers of (v * 10 + d), used by the literal parser.
+    static inline METRICCONSTEXPR limb_type __mul10_low(limb_type __a, limb_type __c)
+    {
+        return ((((__a >> 32) * 10 + (((__a & 0xffffffffULL) * 10 + __c) >> 32)) << 32)
+                | (((__a & 0xffffffffULL) * 10 + __c) & 0xffffffffULL));
+    }
+
+    static inline METRICCONSTEXPR limb_type __mul10_carry(limb_type __a, limb_type __c)
+    {
+        return ((__a >> 32) * 10 + (((__a & 0xffffffffULL) * 10 + __c) >> 32)) >> 32;
+    }
+
+    bool __fits_limb() const {return (__l_[1] | __l_[2] | __l_[3]) == 0;}
+
+    int __highest_bit() const
+    {
+        for (int __i = 3; __i >= 0; --__i)
+            for (int __b = 63; __l_[__i] && __b >= 0; --__b)
+                if ((__l_[__i] >> __b) & 1)
+                    return __i * 64 + __b;
+        return -1;
+    }
+
+    static bool __uless(const int256& __a, const int256& __b)
+    {
+        for (int __i = 3; __i >= 0; --__i)
+            if (__a.__l_[__i] != __b.__l_[__i])
+                return __a.__l_[__i] < __b.__l_[__i];
+        return false;
+    }
+
+    // Unsigned division, both operands are taken as magnitudes.
+    static void __udivmod(const int256& __n, const int256& __d, int256& __q, int256& __r)
+    {
+        if (__d.__fits_limb())
+        {
+            const limb_type __dv = __d.__l_[0];
+            if (__n.__fits_limb())
+            {
+                __q = int256(__raw(), __n.__l_[0] / __dv, 0, 0, 0);
+                __r = int256(__raw(), __n.__l_[0] % __dv, 0, 0, 0);
+                return;
+            }
+#ifdef METRIC_HAS_INT128
+            limb_type __rem = 0;
+            for (int __i = 3; __i >= 0; --__i)
+            {
+                uint128 __cur = (static_cast<uint128>(__rem) << 64) | __n.__l_[__i];
+                __q.__l_[__i] = static_cast<limb_type>(__cur / __dv);
+                __rem = static_cast<limb_type>(__cur % __dv);
+            }
+            __r = int256(__raw(), __rem, 0, 0, 0);
+            return;
+#endif
+        }
+
+        __q = int256(0);
+        __r = int256(0);
+        for (int __b = __n.__highest_bit(); __b >= 0; --__b)
+        {
+            __r = __r << 1;
+            __r.__l_[0] |= (__n.__l_[__b / 64] >> (__b % 64)) & 1;
+            if (!__uless(__r, __d))
+            {
+                __r -= __d;
+                __q.__l_[__b / 64] |= limb_type(1) << (__b % 64);
+            }
+        }
+    }
+
+    static void __divmod(const int256& __n, const int256& __d, int256& __q, int256& __r)
+    {
+        const bool __nneg = __n.__negative();
+        const bool __dneg = __d.__negative();
+        __udivmod(__nneg ? -__n : __n, __dneg ? -__d : __d, __q, __r);
+        if (__nneg != __dneg) __q = -__q;
+        if (__nneg)           __r = -__r;
+    }
+
+public:
+
+    inline
+    int256() = default;
+
+    template <class _Int>
+        inline METRICCONSTEXPR
+        int256(_Int __v,
+            typename std::enable_if
+            <
+                std::is_integral<_Int>::value && std::is_signed<_Int>::value
+            >::type* = 0)
+                : __l_{static_cast<limb_type>(static_cast<long long>(__v)),
+                       __fill(__v < 0), __fill(__v < 0), __fill(__v < 0)} {}
+
+    template <class _Int>
+        inline METRICCONSTEXPR
+        int256(_Int __v,
+            typename std::enable_if
+            <
+                std::is_integral<_Int>::value && !std::is_signed<_Int>::value
+            >::type* = 0)
+                : __l_{static_cast<limb_type>(__v), 0, 0, 0} {}
+
+#ifdef METRIC_HAS_INT128
+    inline METRICCONSTEXPR
+    int256(int128 __v)
+        : __l_{static_cast<limb_type>(static_cast<uint128>(__v)),
+               static_cast<limb_type>(static_cast<uint128>(__v) >> 64),
+               __fill(__v < 0), __fill(__v < 0)} {}
+
+    inline METRICCONSTEXPR
+    int256(uint128 __v)
+        : __l_{static_cast<limb_type>(__v), static_cast<limb_type>(__v >> 64), 0, 0} {}
+#endif
+
+    template <class _Float>
+        inline
+        explicit int256(_Float __v,
+            typename std::enable_if
+            <
+                std::is_floating_point<_Float>::value
+            >::type* = 0)
+    {
+        long double __m = std::fabs(static_cast<long double>(__v));
+        for (int __i = 3; __i >= 0; --__i)
+        {
+            long double __unit = std::ldexp(1.0L, 64 * __i);
+            long double __limb = std::floor(__m / __unit);
+            __l_[__i] = static_cast<limb_type>(__limb);
+            __m -= __limb * __unit;
+        }
+        if (__v < 0)
+            *this = -*this;
+    }
+
+    // observers
+
+    inline METRICCONSTEXPR limb_type limb(unsigned __i) const {return __l_[__i];}
+    inline METRICCONSTEXPR bool __negative() const {return (__l_[3] >> 63) != 0;}
+
+    template <class _Int, typename std::enable_if<std::is_integral<_Int>::value, int>::type = 0>
+        inline METRICCONSTEXPR
+        explicit operator _Int() const {return static_cast<_Int>(__l_[0]);}
+
+#ifdef METRIC_HAS_INT128
+    inline METRICCONSTEXPR
+    explicit operator int128() const
+    {
+        return static_cast<int128>((static_cast<uint128>(__l_[1]) << 64) | __l_[0]);
+    }
+
+    inline METRICCONSTEXPR
+    explicit operator uint128() const
+    {
+        return (static_cast<uint128>(__l_[1]) << 64) | __l_[0];
+    }
+#endif
+
+    template <class _Float, typename std::enable_if<std::is_floating_point<_Float>::value, int>::type = 0>
+        inline
+        explicit operator _Float() const
+    {
+        const int256 __m = __negative() ? -*this : *this;
+        long double __r = 0;
+        for (int __i = 3; __i >= 0; --__i)
+            __r = __r * std::ldexp(1.0L, 64) + static_cast<long double>(__m.__l_[__i]);
+        return static_cast<_Float>(__negative() ? -__r : __r);
+    }
+
+    inline METRICCONSTEXPR
+    explicit operator bool() const {return (__l_[0] | __l_[1] | __l_[2] | __l_[3]) != 0;}
+
+    // arithmetic
+
+    inline int256  operator+() const {return *this;}
+    inline int256  operator-() const {return ~*this + int256(1);}
+    inline int256  operator~() const {return int256(__raw(), ~__l_[0], ~__l_[1], ~__l_[2], ~__l_[3]);}
+
+    inline int256& operator++()    {return *this += int256(1);}
+    inline int256  operator++(int) {int256 __t(*this); ++*this; return __t;}
+    inline int256& operator--()    {return *this -= int256(1);}
+    inline int256  operator--(int) {int256 __t(*this); --*this; return __t;}
+
+    inline int256& operator+=(const int256& __o)
+    {
+        limb_type __carry = 0;
+        for (int __i = 0; __i < 4; ++__i)
+        {
+            limb_type __s = __l_[__i] + __carry;
+            __carry = (__s < __carry);
+            __l_[__i] = __s + __o.__l_[__i];
+            __carry += (__l_[__i] < __s);
+        }
+        return *this;
+    }
+
+    inline int256& operator-=(const int256& __o)
+    {
+        limb_type __borrow = 0;
+        for (int __i = 0; __i < 4; ++__i)
+        {
+            limb_type __s = __l_[__i] - __o.__l_[__i];
+            limb_type __b = (__s > __l_[__i]);
+            __l_[__i] = __s - __borrow;
+            __borrow = __b + (__l_[__i] > __s);
+        }
+        return *this;
+    }
+
+    inline int256& operator*=(const int256& __o)
+    {
+        limb_type __r[4] = {0, 0, 0, 0};
+        for (int __i = 0; __i < 4; ++__i)
+        {
+            limb_type __carry = 0;
+            for (int __j = 0; __i + __j < 4; ++__j)
+            {
+                limb_type __hi, __lo;
+                __mul64(__l_[__i], __o.__l_[__j], __hi, __lo);
+                __lo += __carry;
+                __hi += (__lo < __carry);
+                __r[__i + __j] += __lo;
+                __hi += (__r[__i + __j] < __lo);
+                __carry = __hi;
+            }
+        }
+        *this = int256(__raw(), __r[0], __r[1], __r[2], __r[3]);
+        return *this;
+    }
+
+    inline int256& operator/=(const int256& __o) {int256 __q, __r; __divmod(*this, __o, __q, __r); return *this = __q;}
+    inline int256& operator%=(const int256& __o) {int256 __q, __r; __divmod(*this, __o, __q, __r); return *this = __r;}
+
+    inline int256& operator&=(const int256& __o) {for (int __i = 0; __i < 4; ++__i) __l_[__i] &= __o.__l_[__i]; return *this;}
+    inline int256& operator|=(const int256& __o) {for (int __i = 0; __i < 4; ++__i) __l_[__i] |= __o.__l_[__i]; return *this;}
+    inline int256& operator^=(const int256& __o) {for (int __i = 0; __i < 4; ++__i) __l_[__i] ^= __o.__l_[__i]; return *this;}
+
+    inline int256& operator<<=(unsigned __s)
+    {
+        limb_type __r[4] = {0, 0, 0, 0};
+        const unsigned __w = __s / 64, __b = __s % 64;
+        for (unsigned __i = __w; __i < 4; ++__i)
+        {
+            __r[__i] = __l_[__i - __w] << __b;
+            if (__b && __i > __w)
+                __r[__i] |= __l_[__i - __w - 1] >> (64 - __b);
+        }
+        *this = int256(__raw(), __r[0], __r[1], __r[2], __r[3]);
+        return *this;
+    }
+
+    // Arithmetic shift, the sign is propagated.
+    inline int256& operator>>=(unsigned __s)
+    {
+        const limb_type __f = __fill(__negative());
+        limb_type __r[4] = {__f, __f, __f, __f};
+        const unsigned __w = __s / 64, __b = __s % 64;
+        for (unsigned __i = 0; __i + __w < 4; ++__i)
+        {
+            __r[__i] = __l_[__i + __w] >> __b;
+            const limb_type __next = (__i + __w + 1 < 4) ? __l_[__i + __w + 1] : __f;
+            if (__b)
+                __r[__i] |= __next << (64 - __b);
+        }
+        *this = int256(__raw(), __r[0], __r[1], __r[2], __r[3]);
+        return *this;
+    }
+
+    friend inline int256 operator+(int256 __a, const int256& __b) {return __a += __b;}
+    friend inline int256 operator-(int256 __a, const int256& __b) {return __a -= __b;}
+    friend inline int256 operator*(int256 __a, const int256& __b) {return __a *= __b;}
+    friend inline int256 operator/(int256 __a, const int256& __b) {return __a /= __b;}
+    friend inline int256 operator%(int256 __a, const int256& __b) {return __a %= __b;}
+    friend inline int256 operator&(int256 __a, const int256& __b) {return __a &= __b;}
+    friend inline int256 operator|(int256 __a, const int256& __b) {return __a |= __b;}
+    friend inline int256 operator^(int256 __a, const int256& __b) {return __a ^= __b;}
+    friend inline int256 operator<<(int256 __a, unsigned __s) {return __a <<= __s;}
+    friend inline int256 operator>>(int256 __a, unsigned __s) {return __a >>= __s;}
+
+    // comparison
+
+    friend inline METRICCONSTEXPR bool operator==(const int256& __a, const int256& __b)
+    {
+        return __a.__l_[0] == __b.__l_[0] && __a.__l_[1] == __b.__l_[1]
+            && __a.__l_[2] == __b.__l_[2] && __a.__l_[3] == __b.__l_[3];
+    }
+
+    friend inline METRICCONSTEXPR bool operator!=(const int256& __a, const int256& __b) {return !(__a == __b);}
+
+    friend inline bool operator<(const int256& __a, const int256& __b)
+    {
+        if (__a.__negative() != __b.__negative())
+            return __a.__negative();
+        return __uless(__a, __b);
+    }
+
+    friend inline bool operator> (const int256& __a, const int256& __b) {return __b < __a;}
+    friend inline bool operator<=(const int256& __a, const int256& __b) {return !(__b < __a);}
+    friend inline bool operator>=(const int256& __a, const int256& __b) {return !(__a < __b);}
+
+    // special values
+
+    static inline METRICCONSTEXPR int256 max()
+    {
+        return int256(__raw(), ~limb_type(0), ~limb_type(0), ~limb_type(0), ~limb_type(0) >> 1);
+    }
+
+    static inline METRICCONSTEXPR int256 min()
+    {
+        return int256(__raw(), 0, 0, 0, limb_type(1) << 63);
+    }
+
+    // v * 10 + d, used to build literals at compile time.
+    static inline METRICCONSTEXPR int256 __mul10_add(const int256& __v, unsigned __d)
+    {
+        return int256(__raw(),
+            __mul10_low(__v.__l_[0], __d),
+            __mul10_low(__v.__l_[1], __mul10_carry(__v.__l_[0], __d)),
+            __mul10_low(__v.__l_[2], __mul10_carry(__v.__l_[1], __mul10_carry(__v.__l_[0], __d))),
+            __mul10_low(__v.__l_[3], __mul10_carry(__v.__l_[2], __mul10_carry(__v.__l_[1], __mul10_carry(__v.__l_[0], __d)))));
+    }
+
+    friend inline std::string to_string(const int256& __v)
+    {
+        if (!__v)
+            return "0";
+        const int256 __chunk(1000000000000000000LL);
+        int256 __m = __v.__negative() ? -__v : __v;
+        std::string __s;
+        while (__m)
+        {
+            int256 __q, __r;
+            __udivmod(__m, __chunk, __q, __r);
+            unsigned long long __part = __r.__l_[0];
+            for (int __i = 0; __i < 18 && (__part || __q); ++__i, __part /= 10)
+                __s.insert(__s.begin(), static_cast<char>('0' + __part % 10));
+            __m = __q;
+        }
+        if (__v.__negative())
+            __s.insert(__s.begin(), '-');
+        return __s;
+    }
+};
+
+// Decimal representation.
+std::string to_string(const int256& __v);
+
+template <>
+struct limits_values<int256>
+{
+public:
+    inline static METRICCONSTEXPR int256 zero() {return int256(0);}
+    inline static METRICCONSTEXPR int256 max()  {return int256::max();}
+    inline static METRICCONSTEXPR int256 min()  {return int256::min();}
+};
+
+template <> struct __is_integer_rep<int256> : std::true_type {};
+template <> struct __is_scalar_rep<int256>  : std::true_type {};
+
+template <class _Tp, bool = __is_integer_rep<_Tp>::value, bool = std::is_floating_point<_Tp>::value>
+struct __int256_common
+{
+};
+
+template <class _Tp>
+struct __int256_common<_Tp, true, false>
+{
+    typedef int256 type;
+};
+
+template <class _Tp>
+struct __int256_common<_Tp, false, true>
+{
+    typedef _Tp type;
+};
+
+
+// Decimal literal parsing, done at compile time.
+template <class _Int>
+inline METRICCONSTEXPR _Int __literal_step(const _Int& __v, unsigned __d) {return __v * 10 + __d;}
+
+inline METRICCONSTEXPR int256 __literal_step(const int256& __v, unsigned __d) {return int256::__mul10_add(__v, __d);}
+
+template <class _Int, char... _Digits>
+struct __decimal_literal;
+
+template <class _Int>
+struct __decimal_literal<_Int>
+{
+    static inline METRICCONSTEXPR _Int value(const _Int& __acc) {return __acc;}
+};
+
+template <class _Int, char _Digit, char... _Digits>
+struct __decimal_literal<_Int, _Digit, _Digits...>
+{
+    static_assert((_Digit >= '0' && _Digit <= '9') || _Digit == '\'', "Wide integer literals must be decimal");
+
+    static inline METRICCONSTEXPR _Int value(const _Int& __acc)
+    {
+        return __decimal_literal<_Int, _Digits...>::value(
+            _Digit == '\'' ? __acc : __literal_step(__acc, static_cast<unsigned>(_Digit - '0')));
+    }
+};
+
+namespace literals {
+#ifdef METRIC_HAS_INT128
+template <char... _Digits>
+constexpr int128 operator ""_i128() { return __decimal_literal<int128, _Digits...>::value(int128(0)); }
+#endif
+template <char... _Digits>
+constexpr int256 operator ""_i256() { return __decimal_literal<int256, _Digits...>::value(int256(0)); }
+}
+
+} // namespace metric
+
+namespace std
+{
+    // CLASS TEMPLATE common_type SPECIALIZATIONS
+    template <>
+    struct common_type<metric::int256, metric::int256>
+    {
+        typedef metric::int256 type;
+    };
+
+    template <class _Tp>
+    struct common_type<metric::int256, _Tp> : metric::__int256_common<_Tp>
+    {
+    };
+
+    template <class _Tp>
+    struct common_type<_Tp, metric::int256> : metric::__int256_common<_Tp>
+    {
+    };
+}
+
+#endif // METRICS_WIDEINT_HPP
@@ -0,0 +1,313 @@
+// -*- C++ -*-
+//
+//===---------------------------- window ----------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_WINDOW_HPP
+#define METRICS_WINDOW_HPP
+
+#include "metric_config.hpp"
+#include "metric_algorithm.hpp"
+#include "metric_ringbuffer.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace metric {
+
+// Queue in a power of two ring, doubling when full.  Windows over a count of samples reserve
+// it once; windows over a duration grow it to their largest number of samples.
+template <class _Tp>
+class __window_ring
+{
+    std::vector<_Tp> __slots_;
+    std::size_t      __head_;
+    std::size_t      __tail_;
+
+    void __resize(std::size_t __capacity)
+    {
+        std::vector<_Tp> __s(__capacity);
+        for (std::size_t __i = 0; __i < size(); ++__i)
+            __s[__i] = (*this)[__i];
+        __tail_ = size();
+        __head_ = 0;
+        __slots_.swap(__s);
+    }
+
+public:
+    inline __window_ring() : __head_(0), __tail_(0) {}
+
+    inline void reserve(std::size_t __n)
+    {
+        if (__n > __slots_.size())
+            __resize(__ring_capacity(__n));
+    }
+
+    inline std::size_t size() const {return __tail_ - __head_;}
+    inline bool empty() const {return __tail_ == __head_;}
+
+    inline const _Tp& operator[](std::size_t __i) const {return __slots_[(__head_ + __i) & (__slots_.size() - 1)];}
+    inline const _Tp& front() const {return (*this)[0];}
+    inline const _Tp& back() const {return (*this)[size() - 1];}
+
+    inline void push_back(const _Tp& __v)
+    {
+        if (size() == __slots_.size())
+            __resize(__slots_.empty() ? 8 : 2 * __slots_.size());
+        __slots_[__tail_++ & (__slots_.size() - 1)] = __v;
+    }
+
+    inline void pop_front() {++__head_;}
+    inline void pop_back() {--__tail_;}
+    inline void clear() {__head_ = __tail_ = 0;}
+};
+
+
+// Running sum, updated on insertion and eviction.  Integers are summed exactly in the wide
+// representation of metric::sum; floating points with a Neumaier compensation, so evictions
+// do not leave rounding errors behind.
+template <class _Rep, bool = treat_as_floating_point<_Rep>::value>
+class __window_sum
+{
+public:
+    typedef typename __sum_rep<_Rep>::type type;
+
+private:
+    type __s_;
+
+public:
+    inline __window_sum() : __s_(0) {}
+    inline void __add(_Rep __r) {__s_ += __r;}
+    inline void __sub(_Rep __r) {__s_ -= __r;}
+    inline type __value() const {return __s_;}
+};
+
+template <class _Rep>
+class __window_sum<_Rep, true>
+{
+public:
+    typedef typename __sum_rep<_Rep>::type type;
+
+private:
+    type __s_;
+    type __c_;
+
+public:
+    inline __window_sum() : __s_(0), __c_(0) {}
+
+    inline void __add(type __x)
+    {
+        const type __t = __s_ + __x;
+        __c_ += std::fabs(__s_) >= std::fabs(__x) ? (__s_ - __t) + __x : (__x - __t) + __s_;
+        __s_ = __t;
+    }
+
+    inline void __sub(type __x) {__add(-__x);}
+    inline type __value() const {return __s_ + __c_;}
+};
+
+
+// Samples of a window, oldest first, with the monotonic queues of its minimum and maximum:
+// each keeps the samples that can still become the extremum, numbered in order of insertion.
+// A sample enters and leaves each queue at most once, so updates are amortized O(1).
+template <class _Metric>
+class __window_core
+{
+public:
+    typedef typename _Metric::rep rep;
+    typedef typename __rebind_rep<_Metric, typename __window_sum<rep>::type>::type sum_type;
+    typedef typename __rebind_rep<_Metric, typename __mean_rep<rep>::type>::type mean_type;
+
+private:
+    struct __entry
+    {
+        std::size_t __seq_;
+        rep         __value_;
+    };
+
+    __window_ring<rep>     __values_;
+    __window_ring<__entry> __min_;
+    __window_ring<__entry> __max_;
+    std::size_t            __first_;
+    std::size_t            __next_;
+    __window_sum<rep>      __sum_;
+
+public:
+    inline __window_core() : __first_(0), __next_(0) {}
+
+    inline void __reserve(std::size_t __n)
+    {
+        __values_.reserve(__n);
+        __min_.reserve(__n);
+        __max_.reserve(__n);
+    }
+
+    inline void __push(rep __r)
+    {
+        const __entry __e = {__next_++, __r};
+        while (!__min_.empty() && !(__min_.back().__value_ < __r))
+            __min_.pop_back();
+        __min_.push_back(__e);
+        while (!__max_.empty() && !(__r < __max_.back().__value_))
+            __max_.pop_back();
+        __max_.push_back(__e);
+        __values_.push_back(__r);
+        __sum_.__add(__r);
+    }
+
+    inline void __pop()
+    {
+        __sum_.__sub(__values_.front());
+        __values_.pop_front();
+        if (__min_.front().__seq_ == __first_)
+            __min_.pop_front();
+        if (__max_.front().__seq_ == __first_)
+            __max_.pop_front();
+        ++__first_;
+    }
+
+    inline void __clear()
+    {
+        __values_.clear();
+        __min_.clear();
+        __max_.clear();
+        __first_ = __next_ = 0;
+        __sum_ = __window_sum<rep>();
+    }
+
+    inline std::size_t size() const {return __values_.size();}
+    inline bool empty() const {return __values_.empty();}
+
+    // The oldest and the newest samples, the extrema, sum and mean of a non empty window.
+    inline _Metric front() const {return _Metric(__values_.front());}
+    inline _Metric back() const {return _Metric(__values_.back());}
+    inline _Metric minimum() const {return _Metric(__min_.front().__value_);}
+    inline _Metric maximum() const {return _Metric(__max_.front().__value_);}
+    inline sum_type sum() const {return sum_type(__sum_.__value());}
+
+    inline mean_type mean() const
+    {
+        typedef typename mean_type::rep _Mr;
+        return mean_type(static_cast<_Mr>(__sum_.__value()) / static_cast<_Mr>(size()));
+    }
+};
+
+
+// Minimum, maximum, sum and mean of the last n samples pushed.  Memory is allocated once, at
+// construction.
+template <class _Metric>
+class rolling_window : public __window_core<_Metric>
+{
+    typedef __window_core<_Metric> __base;
+
+    std::size_t __n_;
+
+public:
+    typedef _Metric metric_type;
+
+    inline explicit rolling_window(std::size_t __n) : __n_(__n > 0 ? __n : 1) {__base::__reserve(__n_);}
+
+    inline std::size_t capacity() const {return __n_;}
+    inline bool full() const {return __base::size() == __n_;}
+
+    inline void push(const _Metric& __m)
+    {
+        if (full())
+            __base::__pop();
+        __base::__push(__m.count());
+    }
+
+    // Batch update: of a long range, only the last n samples are pushed.
+    template <class _InputIterator>
+    void push(_InputIterator __first, _InputIterator __last)
+    {
+        __skip(__first, __last, typename std::iterator_traits<_InputIterator>::iterator_category());
+        for (; __first != __last; ++__first)
+            push(*__first);
+    }
+
+    inline void clear() {__base::__clear();}
+
+private:
+    template <class _InputIterator, class _Tag>
+    inline void __skip(_InputIterator&, _InputIterator, _Tag) {}
+
+    template <class _RandomAccessIterator>
+    inline void __skip(_RandomAccessIterator& __first, _RandomAccessIterator __last, std::random_access_iterator_tag)
+    {
+        if (static_cast<std::size_t>(__last - __first) > __n_)
+        {
+            __first = __last - static_cast<std::ptrdiff_t>(__n_);
+            __base::__clear();
+        }
+    }
+};
+
+
+// Minimum, maximum, sum and mean of the samples of the last span of time: a sample stamped t
+// stays in the window while the newest time stamp is before t + span.  Time stamps must not
+// decrease.
+template <class _Metric, class _Clock = std::chrono::steady_clock>
+class timed_window : public __window_core<_Metric>
+{
+    typedef __window_core<_Metric> __base;
+
+public:
+    typedef _Metric metric_type;
+    typedef metric::sample<_Metric, _Clock> value_type;
+    typedef typename _Clock::duration duration;
+    typedef typename _Clock::time_point time_point;
+
+private:
+    duration                  __span_;
+    __window_ring<time_point> __times_;
+
+public:
+    inline explicit timed_window(const duration& __span) : __span_(__span) {}
+
+    inline duration span() const {return __span_;}
+
+    // Evicts the samples that are out of the window at __now.
+    inline void advance(const time_point& __now)
+    {
+        while (!__times_.empty() && !(__now - __times_.front() < __span_))
+        {
+            __times_.pop_front();
+            __base::__pop();
+        }
+    }
+
+    inline void push(const time_point& __t, const _Metric& __m)
+    {
+        advance(__t);
+        __times_.push_back(__t);
+        __base::__push(__m.count());
+    }
+
+    inline void push(const value_type& __s) {push(__s.time, __s.value);}
+
+    // Batch update from a range of samples, oldest first.
+    template <class _InputIterator>
+    void push(_InputIterator __first, _InputIterator __last)
+    {
+        for (; __first != __last; ++__first)
+            push(*__first);
+    }
+
+    inline time_point oldest() const {return __times_.front();}
+    inline time_point newest() const {return __times_.back();}
+
+    inline void clear() {__base::__clear(); __times_.clear();}
+};
+
+} // namespace metric
+
+#endif // METRICS_WINDOW_HPP
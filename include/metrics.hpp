@@ -16,6 +16,7 @@
 #define METRICS_ALL_HPP
 
 #include "angularspeed.hpp"
+#include "density.hpp"
 #include "energy.hpp"
 #include "mass.hpp"
 #include "power.hpp"
@@ -23,7 +24,9 @@
 #include "distance.hpp"
 #include "force.hpp"
 #include "metric_config.hpp"
+#include "metric_wideint.hpp"
 #include "pressure.hpp"
+#include "sipressure.hpp"
 #include "volume.hpp"
 #include "electriccurrent.hpp"
 #include "frequency.hpp"
@@ -32,5 +35,8 @@
 #include "electricresistance.hpp"
 
 #include "electric_conversion.hpp"
+#include "metric_rounding.hpp"
+#include "metric_dimension.hpp"
+#include "metric_batch.hpp"
 
 #endif // METRICS_ALL_HPP
@@ -0,0 +1,201 @@
+// -*- C++ -*-
+//
+//===---------------------------- sipressure ------------------------------===//
+//
+// Copyright (c) 2018, 2019, Christophe Pijcke
+//
+// This file was largely inspired by the chrono library
+//  from the LLVM Compiler Infrastructure.
+//
+// This file is dual licensed under the MIT and the University of Illinois Open
+// Source Licenses.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef METRICS_SIPRESSURE_HPP
+#define METRICS_SIPRESSURE_HPP
+
+#include "metric_config.hpp"
+#include "pressure.hpp"
+#include <type_traits>
+
+namespace metric {
+
+// Pressure whose period is relative to the pascal.  The metric::pressure periods are relative
+// to the atmosphere, so pascal <-> kilopascal conversions go through ratios of 101325; here
+// the SI units differ by powers of ten only, the atmosphere and the mmHg being derived units.
+template <class _Rep, class _Period = std::ratio<1> > class si_pressure;
+
+template <typename A> struct __is_si_pressure: __is_specialization<A, si_pressure> {};
+
+// One atmosphere, in pascal.
+typedef std::ratio<101325> __atmosphere_pascal;
+
+
+template <class _ToPressure, class _Rep, class _Period>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __is_si_pressure<_ToPressure>::value,
+    _ToPressure
+>::type
+si_pressure_cast(const si_pressure<_Rep, _Period>& __fd)
+{
+    return __metric_cast<si_pressure<_Rep, _Period>, _ToPressure>()(__fd);
+}
+
+template <class _Rep, class _Period>
+class si_pressure
+{
+    static_assert(!__is_si_pressure<_Rep>::value, "A si_pressure representation can not be a si_pressure");
+    static_assert(std::__is_ratio<_Period>::value, "Second template parameter of si_pressure must be a std::ratio");
+    static_assert(_Period::num > 0, "si_pressure period must be positive");
+
+public:
+    typedef _Rep rep;
+    typedef _Period period;
+private:
+    rep __rep_;
+public:
+
+    inline METRICCONSTEXPR
+    si_pressure() = default;
+
+    template <class _Rep2>
+        inline METRICCONSTEXPR
+        explicit si_pressure(const _Rep2& __r,
+            typename std::enable_if
+            <
+               std::is_convertible<_Rep2, rep>::value &&
+               (treat_as_floating_point<rep>::value ||
+               !treat_as_floating_point<_Rep2>::value)
+            >::type* = 0) noexcept
+                : __rep_(__r) {}
+
+    // conversions
+    template <class _Rep2, class _Period2>
+        inline METRICCONSTEXPR
+		si_pressure(const si_pressure<_Rep2, _Period2>& __d,
+            typename std::enable_if
+            <
+                __no_overflow<_Period2, period>::value && (
+                treat_as_floating_point<rep>::value ||
+                (__no_overflow<_Period2, period>::type::den == 1 &&
+                 !treat_as_floating_point<_Rep2>::value))
+            >::type* = 0) noexcept
+                : __rep_(metric::si_pressure_cast<si_pressure>(__d).count()) {}
+
+    // observer
+
+    inline METRICCONSTEXPR rep count() const noexcept {return __rep_;}
+
+    // arithmetic
+
+    inline METRICCONSTEXPR si_pressure  operator+() const {return *this;}
+    inline METRICCONSTEXPR si_pressure  operator-() const {return si_pressure(-__rep_);}
+    inline const si_pressure& operator++()      {++__rep_; return *this;}
+    inline const si_pressure  operator++(int)   {return si_pressure(__rep_++);}
+    inline const si_pressure& operator--()      {--__rep_; return *this;}
+    inline const si_pressure  operator--(int)   {return si_pressure(__rep_--);}
+
+    inline const si_pressure& operator+=(const si_pressure& __d) {__rep_ += __d.count(); return *this;}
+    inline const si_pressure& operator-=(const si_pressure& __d) {__rep_ -= __d.count(); return *this;}
+
+    inline const si_pressure& operator*=(const rep& rhs) {__rep_ *= rhs; return *this;}
+    inline const si_pressure& operator/=(const rep& rhs) {__rep_ /= rhs; return *this;}
+    inline const si_pressure& operator%=(const rep& rhs) {__rep_ %= rhs; return *this;}
+    inline const si_pressure& operator%=(const si_pressure& rhs) {__rep_ %= rhs.count(); return *this;}
+
+    // special values
+
+    inline static METRICCONSTEXPR si_pressure zero() {return si_pressure(limits_values<rep>::zero());}
+    inline static METRICCONSTEXPR si_pressure min()  {return si_pressure(limits_values<rep>::min());}
+    inline static METRICCONSTEXPR si_pressure max()  {return si_pressure(limits_values<rep>::max());}
+};
+
+
+// Migration from and to the atmosphere based metric::pressure.  The count is first read in the
+// other family with the same unit, which is exact, then cast once.
+template <class _ToPressure, class _Rep, class _Period>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __is_si_pressure<_ToPressure>::value,
+    _ToPressure
+>::type
+si_pressure_cast(const pressure<_Rep, _Period>& __fd) noexcept
+{
+    typedef si_pressure<_Rep, typename std::ratio_multiply<_Period, __atmosphere_pascal>::type> _Same;
+    return __metric_cast<_Same, _ToPressure>()(_Same(__fd.count()));
+}
+
+template <class _ToPressure, class _Rep, class _Period>
+inline
+METRICCONSTEXPR
+typename std::enable_if
+<
+    __is_pressure<_ToPressure>::value,
+    _ToPressure
+>::type
+pressure_cast(const si_pressure<_Rep, _Period>& __fd) noexcept
+{
+    typedef pressure<_Rep, typename std::ratio_divide<_Period, __atmosphere_pascal>::type> _Same;
+    return __metric_cast<_Same, _ToPressure>()(_Same(__fd.count()));
+}
+
+
+namespace si {
+
+template <class _Rep, class _Period = std::ratio<1> > using pressure = si_pressure<_Rep, _Period>;
+
+template <class _ToPressure, class _Pressure>
+inline
+METRICCONSTEXPR
+_ToPressure
+pressure_cast(const _Pressure& __fd) noexcept
+{
+    return metric::si_pressure_cast<_ToPressure>(__fd);
+}
+
+#ifdef _WIN32
+typedef si_pressure<long long                              > pascl;
+#else
+typedef si_pressure<long long                              > pascal;
+#endif
+typedef si_pressure<long long, std::hecto                  > hectopascal;
+typedef si_pressure<long long, std::kilo                   > kilopascal;
+typedef si_pressure<long long, std::mega                   > megapascal;
+typedef si_pressure<long long, std::giga                   > gigapascal;
+typedef si_pressure<long long, std::tera                   > terapascal;
+typedef si_pressure<long long, std::ratio<100000>          > bar;
+typedef si_pressure<long long, std::hecto                  > millibar;
+typedef si_pressure<long long, std::ratio<1, 10>           > microbar;
+typedef si_pressure<long long, __atmosphere_pascal         > atmosphere;
+typedef si_pressure<long long, std::ratio<101325, 760>     > millimetremercury; // Torr ou mmHg.
+
+// Same suffixes as metric::literals: bring them in with using-declarations to migrate a scope.
+namespace literals {
+constexpr millimetremercury operator ""_mmHg(unsigned long long v) { return millimetremercury(v); }
+#ifdef _WIN32
+constexpr             pascl operator ""_Pa(  unsigned long long v) { return             pascl(v); }
+#else
+constexpr            pascal operator ""_Pa(  unsigned long long v) { return            pascal(v); }
+#endif
+constexpr       hectopascal operator ""_hPa( unsigned long long v) { return       hectopascal(v); }
+constexpr        kilopascal operator ""_kPa( unsigned long long v) { return        kilopascal(v); }
+constexpr        megapascal operator ""_MPa( unsigned long long v) { return        megapascal(v); }
+constexpr        gigapascal operator ""_GPa( unsigned long long v) { return        gigapascal(v); }
+constexpr        terapascal operator ""_TPa( unsigned long long v) { return        terapascal(v); }
+constexpr               bar operator ""_bar( unsigned long long v) { return               bar(v); }
+constexpr          millibar operator ""_mbar(unsigned long long v) { return          millibar(v); }
+constexpr          microbar operator ""_ubar(unsigned long long v) { return          microbar(v); }
+constexpr        atmosphere operator ""_atm( unsigned long long v) { return        atmosphere(v); }
+} // namespace literals
+
+} // namespace si
+
+} // namespace metric
+
+#endif // METRICS_SIPRESSURE_HPP
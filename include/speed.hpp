@@ -59,117 +59,6 @@ namespace std
 
 namespace metric {
 
-template <class _FromSpeed, class _ToSpeed,
-    class _PeriodDistance = typename std::ratio_divide<typename _FromSpeed::distance_period, typename _ToSpeed::distance_period>::type,
-    class _PeriodDuration = typename std::ratio_divide<typename _FromSpeed::duration_period, typename _ToSpeed::duration_period>::type,
-    bool = _PeriodDistance::num == 1,
-    bool = _PeriodDistance::den == 1,
-    bool = _PeriodDuration::num == 1,
-    bool = _PeriodDuration::den == 1>
-    struct __speed_cast;
-
-template <class _FromSpeed, class _ToSpeed, class _PeriodDistance, class _PeriodDuration>
-struct __speed_cast<_FromSpeed, _ToSpeed, _PeriodDistance, _PeriodDuration, true, true, true, true>
-{
-    inline  _ToSpeed operator()(const _FromSpeed& __fd) const
-    {
-        return _ToSpeed(static_cast<typename _ToSpeed::distance_rep>(__fd.count()));
-    }
-};
-
-template <class _FromSpeed, class _ToSpeed, class _PeriodDistance, class _PeriodDuration>
-struct __speed_cast<_FromSpeed, _ToSpeed, _PeriodDistance, _PeriodDuration, true, true, false, true>
-{
-    inline
-        _ToSpeed operator()(const _FromSpeed& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToSpeed::distance_rep, typename _FromSpeed::distance_rep, intmax_t>::type _Ct;
-
-        return _ToSpeed(static_cast<typename _ToSpeed::distance_rep>(
-            static_cast<_Ct>(__fd.count()) / static_cast<_Ct>(_PeriodDuration::num)));
-    }
-};
-
-template <class _FromSpeed, class _ToSpeed, class _PeriodDistance, class _PeriodDuration>
-struct __speed_cast<_FromSpeed, _ToSpeed, _PeriodDistance, _PeriodDuration, true, true, true, false>
-{
-    inline
-        _ToSpeed operator()(const _FromSpeed& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToSpeed::distance_rep, typename _FromSpeed::distance_rep, intmax_t>::type _Ct;
-
-        return _ToSpeed(static_cast<typename _ToSpeed::distance_rep>(
-            static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodDuration::den)));
-    }
-};
-
-template <class _FromSpeed, class _ToSpeed, class _PeriodDistance, class _PeriodDuration>
-struct __speed_cast<_FromSpeed, _ToSpeed, _PeriodDistance, _PeriodDuration, false, true, false, true>
-{
-    inline
-        _ToSpeed operator()(const _FromSpeed& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToSpeed::distance_rep, typename _FromSpeed::distance_rep, intmax_t>::type _Ct;
-
-        return _ToSpeed(static_cast<typename _ToSpeed::distance_rep>(
-        		(static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodDistance::num)) / static_cast<_Ct>(_PeriodDuration::num)));
-    }
-};
-
-template <class _FromSpeed, class _ToSpeed, class _PeriodDistance, class _PeriodDuration>
-struct __speed_cast<_FromSpeed, _ToSpeed, _PeriodDistance, _PeriodDuration, false, true, true, true>
-{
-    inline
-        _ToSpeed operator()(const _FromSpeed& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToSpeed::distance_rep, typename _FromSpeed::distance_rep, intmax_t>::type _Ct;
-
-        return _ToSpeed(static_cast<typename _ToSpeed::power_rep>(
-            static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodDistance::num)));
-    }
-};
-
-template <class _FromSpeed, class _ToSpeed, class _PeriodVolume, class _PeriodDuration>
-struct __speed_cast<_FromSpeed, _ToSpeed, _PeriodVolume, _PeriodDuration, false, false, true, true>
-{
-    inline
-	_ToSpeed operator()(const _FromSpeed& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToSpeed::distance_rep, typename _FromSpeed::distance_rep, intmax_t>::type _Ct;
-
-        return _ToSpeed(static_cast<typename _ToSpeed::distance_rep>(
-            static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodVolume::num)
-										   / static_cast<_Ct>(_PeriodVolume::den) ));
-    }
-};
-
-template <class _FromSpeed, class _ToSpeed, class _PeriodSpeed, class _PeriodDuration>
-struct __speed_cast<_FromSpeed, _ToSpeed, _PeriodSpeed, _PeriodDuration, false, true, true, false>
-{
-    inline
-        _ToSpeed operator()(const _FromSpeed& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToSpeed::distance_rep, typename _FromSpeed::distance_rep, intmax_t>::type _Ct;
-
-        return _ToSpeed(static_cast<typename _ToSpeed::speed_rep>(
-        		(static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodSpeed::num)) * static_cast<_Ct>(_PeriodDuration::den)));
-    }
-};
-
-template <class _FromSpeed, class _ToSpeed, class _PeriodSpeed, class _PeriodDuration>
-struct __speed_cast<_FromSpeed, _ToSpeed, _PeriodSpeed, _PeriodDuration, true, false, true, false>
-{
-    inline
-        _ToSpeed operator()(const _FromSpeed& __fd) const
-    {
-    	typedef typename std::common_type<typename _ToSpeed::distance_rep, typename _FromSpeed::distance_rep, intmax_t>::type _Ct;
-
-        return _ToSpeed(static_cast<typename _ToSpeed::distance_rep>(
-        		(static_cast<_Ct>(__fd.count()) * static_cast<_Ct>(_PeriodDuration::den) / static_cast<_Ct>(_PeriodSpeed::den))));
-    }
-};
-
-
 template <class _ToSpeed, class _Vol, class _Period>
 inline
 METRICCONSTEXPR
@@ -178,9 +67,9 @@ typename std::enable_if
     __is_speed<_ToSpeed>::value,
     _ToSpeed
 >::type
-speed_cast(const speed<_Vol, _Period>& __fd)
+speed_cast(const speed<_Vol, _Period>& __fd) noexcept
 {
-    return __speed_cast<speed<_Vol, _Period>, _ToSpeed>()(__fd);
+    return __metric_cast<speed<_Vol, _Period>, _ToSpeed>()(__fd);
 }
 
 
@@ -200,6 +89,8 @@ public:
     typedef typename _Distance::period	distance_period;
     typedef typename _Time::rep			duration_rep;
     typedef typename _Time::period		duration_period;
+    typedef distance_rep		rep;
+    typedef typename std::ratio_divide<distance_period, duration_period>::type period;	// One count, as distance per duration.
 
 private:
     distance_rep __rep_;
@@ -215,9 +106,9 @@ public:
             typename std::enable_if
             <
                std::is_convertible<_Rep2, distance_rep>::value &&
-               (std::is_floating_point<distance_rep>::value ||
-               !std::is_floating_point<_Rep2>::value)
-            >::type* = 0)
+               (treat_as_floating_point<distance_rep>::value ||
+               !treat_as_floating_point<_Rep2>::value)
+            >::type* = 0) noexcept
                 : __rep_(__r) {}
 
     // conversions
@@ -227,15 +118,15 @@ public:
             typename std::enable_if
             <
                 __no_overflow<typename _Distance2::distance_period, distance_period>::value && (
-                std::is_floating_point<distance_rep>::value ||
+                treat_as_floating_point<distance_rep>::value ||
                 (__no_overflow<typename _Distance2::distance_period, distance_period>::type::den == 1 &&
-                 !std::is_floating_point<typename _Distance2::distance_rep>::value))
-            >::type* = 0*/)
+                 !treat_as_floating_point<typename _Distance2::distance_rep>::value))
+            >::type* = 0*/) noexcept
                 : __rep_(metric::speed_cast<speed>(__d).count()) {}
 
     // observer
 
-    inline METRICCONSTEXPR distance_rep count() const {return __rep_;}
+    inline METRICCONSTEXPR distance_rep count() const noexcept {return __rep_;}
 
     // arithmetic
 
@@ -309,22 +200,41 @@ template <
 	typename DurationRep,
 	typename DurationPer
 >
-inline Distance operator*(
+inline METRICCONSTEXPR Distance operator*(
 	const speed<Distance, std::chrono::duration<DurationRep, DurationPer>>& s,
-	const std::chrono::duration<DurationRep, DurationPer>& d)
+	const std::chrono::duration<DurationRep, DurationPer>& d) noexcept
 {
 	return Distance(s.count() * d.count());
 }
 
+// Distance = Speed * Time, with any duration.  The count is the plain product, expressed in the
+// distance unit of speed period * duration period: exact, without any scaling.
+template <
+	typename Distance,
+	typename Time,
+	typename DurationRep,
+	typename DurationPer
+>
+inline METRICCONSTEXPR distance<
+	typename std::common_type<typename Distance::rep, DurationRep>::type,
+	typename std::ratio_multiply<typename speed<Distance, Time>::period, DurationPer>::type> operator*(
+	const speed<Distance, Time>& s,
+	const std::chrono::duration<DurationRep, DurationPer>& d) noexcept
+{
+	typedef typename std::common_type<typename Distance::rep, DurationRep>::type _Cr;
+	return distance<_Cr, typename std::ratio_multiply<typename speed<Distance, Time>::period, DurationPer>::type>(
+		static_cast<_Cr>(s.count()) * static_cast<_Cr>(d.count()));
+}
+
 // Time = Distance / Speed
 template <
 	typename Duration,
 	typename DistanceRep,
 	typename DistancePer
 >
-inline Duration operator/(
+inline METRICCONSTEXPR Duration operator/(
 	const distance<DistanceRep, DistancePer>& v,
-	const speed<distance<DistanceRep, DistancePer>, Duration>& f)
+	const speed<distance<DistanceRep, DistancePer>, Duration>& f) noexcept
 {
 	return Duration(v.count() / f.count());
 }
@@ -336,9 +246,9 @@ template <
 	typename DurationRep,
 	typename DurationPer
 >
-inline speed<distance<DistanceRep, DistancePer>, std::chrono::duration<DurationRep, DurationPer>> operator/(
+inline METRICCONSTEXPR speed<distance<DistanceRep, DistancePer>, std::chrono::duration<DurationRep, DurationPer>> operator/(
 	const distance<DistanceRep, DistancePer>& v,
-	const std::chrono::duration<DurationRep, DurationPer>& d)
+	const std::chrono::duration<DurationRep, DurationPer>& d) noexcept
 {
 	return speed<distance<DistanceRep, DistancePer>, std::chrono::duration<DurationRep, DurationPer>>(v.count() / d.count());
 }
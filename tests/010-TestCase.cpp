@@ -4,7 +4,28 @@
 #define CATCH_CONFIG_MAIN
 
 #include <catch2/catch.hpp>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 #include "../include/metrics.hpp"
+#include "../include/metric_algorithm.hpp"
+#include "../include/metric_summation.hpp"
+#include "../include/metric_parallel.hpp"
+#include "../include/metric_pipeline.hpp"
+#include "../include/metric_stream.hpp"
+#include "../include/metric_ringbuffer.hpp"
+#include "../include/metric_compact.hpp"
+#include "../include/metric_half.hpp"
+#include "../include/metric_span.hpp"
+#include "../include/metric_hash.hpp"
+#include "../include/metric_groupby.hpp"
+#include "../include/metric_sort.hpp"
+#include "../include/metric_sketch.hpp"
+#include "../include/metric_window.hpp"
+#include "../include/metric_filter.hpp"
+#include "../include/metric_resample.hpp"
 
 
 using namespace metric::literals;
@@ -51,6 +72,47 @@ TEST_CASE( "Mass conversion (pass)", "[single-file]" )
 	REQUIRE((_12kg / 2_kg) == 6);
 }
 
+TEST_CASE( "Densities (pass)", "[single-file]" )
+{
+	REQUIRE(metric::kilogram_per_litre(1) == 1000_kg_m3);
+	REQUIRE(1_g_l == 1000_mg_l);
+	metric::density<double> d = 10_kg / 10_l;
+	REQUIRE(d == 1000_g_l);
+	REQUIRE(metric::mass_cast<metric::gram>(2_kg_l * 3_ml) == 6_g);
+	REQUIRE(metric::volume_cast<metric::millilitre>(10_kg / metric::density<double>(997.0)) == 10030_ml);
+
+	// The samples are computed at compile time.
+	static_assert(metric::water_density::size == 321, "");
+	static_assert(metric::water_density::sample(200).count() == metric::fluid::water::value(25.0), "");
+	static_assert(metric::mercury_density::exact(0.0).count() == 13595.1, "");
+
+	REQUIRE(metric::water_density::at(25.0).count() == Approx(waterDensity<25>::value).epsilon(1e-9));
+	REQUIRE(metric::water_density::at(3.98).count() == Approx(metric::fluid::water::value(3.98)).epsilon(1e-7));
+	REQUIRE(metric::water_density::at(-5.0) == metric::water_density::sample(0));
+	REQUIRE(metric::water_density::at(90.0) == metric::water_density::sample(320));
+	REQUIRE(metric::mercury_density::at(5.0).count() == Approx(mercuryDensity<5>::value).epsilon(1e-9));
+
+	// Integral results are rounded to nearest: 10029.6 ml, 999.97 g.
+	REQUIRE(metric::water_density::volume_of<metric::millilitre>(10_kg, 25.0) == 10030_ml);
+	REQUIRE(metric::water_density::mass_of<metric::gram>(1_l, 4.0) == 1000_g);
+	REQUIRE(metric::water_density::mass_of<metric::milligram>(1_l, 4.0) == 999970_mg);
+
+	std::vector<metric::kilogram> masses = {10_kg, 10_kg, 1_kg};
+	std::vector<double> celsius = {25.0, 25.0, 5.0};
+	std::vector<metric::millilitre> volumes(3);
+	metric::water_density::volumes<metric::millilitre>(masses.begin(), masses.end(), celsius.begin(), volumes.begin());
+	REQUIRE(volumes == std::vector<metric::millilitre>{10030_ml, 10030_ml, 1000_ml});
+	std::vector<metric::milligram> back(3);
+	metric::water_density::masses<metric::milligram>(volumes.begin(), volumes.end(), celsius.begin(), back.begin());
+	REQUIRE(back[2] == 999961_mg);
+
+	// Every 0.1 °C from 0 to 100 °C: 1001 samples.
+	typedef metric::density_table<metric::fluid::water, 0, 100, 10> fine_water;
+	static_assert(fine_water::size == 1001, "");
+	static_assert(fine_water::sample(1000).count() == metric::fluid::water::value(100.0), "");
+	REQUIRE(fine_water::at(25.0).count() == Approx(waterDensity<25>::value).epsilon(1e-9));
+}
+
 TEST_CASE( "Electricity conversion (pass)", "[single-file]" )
 {
 	// U = R * I
@@ -186,7 +248,7 @@ TEST_CASE( "Energy conversion (pass)", "[single-file]" )
 	REQUIRE(metric::calorie(1000000) <= metric::watthour(1164));
 
 	// std::cout << "1 000 000 calorie := " << metric::energy_cast<metric::joule>(metric::calorie(1000000)).count() << " joule." << std::endl;
-	REQUIRE(metric::energy_cast<metric::joule>(metric::calorie(1000000)).count() == 4183200);
+	REQUIRE(metric::energy_cast<metric::joule>(metric::calorie(1000000)).count() == 4186046);
 
 
 	REQUIRE(metric::kilowatthour(40) == metric::kilowatt(10) * std::chrono::hours(4));
@@ -222,6 +284,68 @@ TEST_CASE( "Energy conversion (pass)", "[single-file]" )
 	*/
 }
 
+TEST_CASE( "Constexpr compound conversions (pass)", "[single-file]" )
+{
+	static_assert(metric::energy_cast<metric::joule>(metric::watthour(2)).count() == 7200, "energy_cast");
+	static_assert(metric::energy_cast<metric::joule>(metric::calorie(43)).count() == 180, "one folded ratio");
+	static_assert(metric::speed_cast<metric::metre_second>(metric::kilometre_hour(36)).count() == 10, "speed_cast");
+	static_assert(metric::flowrate_cast<metric::millilitre_second>(metric::millilitre_hour(36000)).count() == 10, "flowrate_cast");
+	static_assert(metric::joule(metric::watthour(1)).count() == 3600, "converting constructor");
+	static_assert(metric::millimetre_second(metric::metre_second(2)).count() == 2000, "converting constructor");
+
+	static_assert((metric::kilowatt(10) * std::chrono::hours(4)).count() == 40, "energy = power * time");
+	static_assert((metric::kilowatthour(40) / std::chrono::hours(4)).count() == 10, "power = energy / time");
+	static_assert((metric::kilowatthour(40) / metric::kilowatt(10)).count() == 4, "time = energy / power");
+	static_assert((metric::metre_second(3) * std::chrono::seconds(4)).count() == 12, "distance = speed * time");
+	static_assert((metric::millilitre(600) / metric::millilitre_minute(100)).count() == 6, "time = volume / flowrate");
+	static_assert((metric::ohm(2) * metric::ampere(3)).count() == 6, "U = R * I");
+	static_assert((metric::volt(6) / metric::ampere(3)).count() == 2, "R = U / I");
+	static_assert(metric::joule(3600) == metric::watthour(1), "mixed-unit comparison");
+
+	static_assert(noexcept(metric::energy_cast<metric::joule>(metric::watthour(1))), "noexcept");
+	static_assert(noexcept(metric::speed_cast<metric::metre_second>(metric::kilometre_hour(1))), "noexcept");
+	static_assert(noexcept(metric::flowrate_cast<metric::millilitre_second>(metric::millilitre_hour(1))), "noexcept");
+	static_assert(noexcept(metric::kilowatt(1) * std::declval<const std::chrono::hours&>()), "noexcept");
+	static_assert(noexcept(metric::ohm(1) * metric::ampere(1)), "noexcept");
+	static_assert(noexcept(metric::newton(1) / metric::kilogram(1)), "noexcept");
+
+	constexpr metric::joule folded = metric::energy_cast<metric::joule>(metric::calorie(1000000));
+	REQUIRE(folded.count() == 4186046);
+}
+
+TEST_CASE( "Mixed-duration compound operators (pass)", "[single-file]" )
+{
+	// km/h * ms: the product is exact, in 1/3600 m.
+	static_assert(std::is_same<decltype(metric::kilometre_hour(36) * std::chrono::milliseconds(500))::period,
+	                           std::ratio<1, 3600> >::value, "folded period");
+	static_assert(metric::kilometre_hour(36) * std::chrono::milliseconds(500) == metric::metre(5), "exact");
+	REQUIRE(metric::distance_cast<metric::millimetre>(metric::kilometre_hour(1) * std::chrono::milliseconds(1)).count() == 0);
+	REQUIRE(metric::kilometre_hour(1) * std::chrono::milliseconds(3600) == metric::metre(1));
+	REQUIRE(metric::millilitre_minute(120) * std::chrono::seconds(30) == metric::millilitre(60));
+	REQUIRE(metric::millilitre_hour(1) * std::chrono::hours(2) == metric::millilitre(2));     // Same duration: unchanged.
+	REQUIRE(metric::kilowatthour(10) / std::chrono::minutes(30) == metric::kilowatt(20));
+	REQUIRE(metric::joule(7) / std::chrono::milliseconds(2) == metric::watt(3500));
+
+	std::vector<std::chrono::milliseconds> intervals = {std::chrono::milliseconds(250), std::chrono::milliseconds(1500),
+	                                                    std::chrono::milliseconds(60000)};
+	std::vector<metric::microlitre> delivered(3);
+	metric::batch_multiply_each<metric::microlitre>(metric::millilitre_minute(6), intervals.begin(), intervals.end(), delivered.begin());
+	REQUIRE(delivered == std::vector<metric::microlitre>{25_ul, 150_ul, 6000_ul});
+
+	std::vector<metric::kilometre_hour> speeds = {metric::kilometre_hour(36), metric::kilometre_hour(72), metric::kilometre_hour(1)};
+	std::vector<metric::millimetre> travelled(3);
+	metric::batch_multiply<metric::millimetre>(speeds.begin(), speeds.end(), intervals.begin(), travelled.begin());
+	REQUIRE(travelled == std::vector<metric::millimetre>{2500_mm, 30000_mm, 16666_mm});
+
+	typedef metric::energy<metric::milliwatt, std::chrono::seconds> millijoule;
+	std::vector<millijoule> energies = {millijoule(10000), millijoule(3000), millijoule(120000)};
+	std::vector<metric::milliwatt> average(3);
+	metric::batch_divide<metric::milliwatt>(energies.begin(), energies.end(), intervals.begin(), average.begin());
+	REQUIRE(average == std::vector<metric::milliwatt>{40000_mW, 2000_mW, 2000_mW});
+	metric::batch_divide_each<metric::milliwatt>(energies.begin(), energies.end(), std::chrono::minutes(1), average.begin());
+	REQUIRE(average == std::vector<metric::milliwatt>{166_mW, 50_mW, 2000_mW});
+}
+
 TEST_CASE( "ForceMass conversion (pass)", "[single-file]" )
 {
 	REQUIRE(metric::millinewton(1000) == metric::newton(1));
@@ -257,6 +381,36 @@ TEST_CASE( "Pressure conversion (pass)", "[single-file]" )
 	REQUIRE(metric::bar(1) < metric::millimetremercury(751));
 }
 
+TEST_CASE( "SI pressure conversion (pass)", "[single-file]" )
+{
+	using metric::si::literals::operator"" _kPa;
+	using metric::si::literals::operator"" _TPa;
+	using metric::si::literals::operator"" _atm;
+
+	static_assert(std::is_same<metric::si::kilopascal::period, std::kilo>::value, "");
+	static_assert(std::is_same<std::common_type<metric::si::pascal, metric::si::kilopascal>::type, metric::si::pascal>::value, "");
+	metric::si::pascal pa = 5_kPa;
+	REQUIRE(pa.count() == 5000);
+	REQUIRE(metric::si::pascal(1000000000000) == 1_TPa);
+	REQUIRE(metric::si::pascal(9000000000000000000LL) == metric::si::terapascal(9000000));
+	REQUIRE(metric::si::millibar(100) == metric::si::hectopascal(100));
+	REQUIRE(metric::si::bar(1) == 100_kPa);
+	REQUIRE(1_atm == metric::si::pascal(101325));
+	REQUIRE(metric::si::pressure_cast<metric::si::millimetremercury>(1_atm).count() == 760);
+	REQUIRE(metric::si::pressure_cast<metric::si::kilopascal>(metric::si::pascal(2500)).count() == 2);
+	metric::si::pressure<double, std::kilo> kpa = metric::si::pascal(2500);
+	REQUIRE(kpa.count() == 2.5);
+
+	// Migration from and to the atmosphere based pressures.
+	REQUIRE(metric::si::pressure_cast<metric::si::pascal>(metric::kilopascal(12)) == 12_kPa);
+	REQUIRE(metric::si::pressure_cast<metric::si::millibar>(metric::bar(1)).count() == 1000);
+	REQUIRE(metric::pressure_cast<metric::hectopascal>(metric::si::bar(2)) == metric::hectopascal(2000));
+	REQUIRE(metric::pressure_cast<metric::millimetremercury>(1_atm).count() == 760);
+
+	REQUIRE(metric::si::pressure_cast<metric::si::pascal>(metric::newton(3000) / metric::square_metre(2)) == metric::si::pascal(1500));
+	REQUIRE(metric::si::kilopascal(10) * metric::square_metre(3) == metric::newton(30000));
+}
+
 void checkSpeed(metric::metre distance, std::chrono::minutes duration)
 {
 	metric::kilometre_hour kmh = distance / duration;
@@ -327,3 +481,1295 @@ TEST_CASE( "Angular speed conversion (pass)", "[single-file]" )
 	REQUIRE(360_degsec == metric::turn_hour(3600));
 }
 
+
+TEST_CASE( "Wide representation (pass)", "[single-file]" )
+{
+	typedef metric::energy<metric::power<metric::int256>, std::chrono::hours> watthour256;
+	typedef metric::energy<metric::power<metric::int256, std::milli>, std::chrono::seconds> millijoule256;
+
+	// 9.2e21 Wh: far beyond long long once expressed in millijoule.
+	const metric::int256 lifetime = metric::int256(9200000000000000000LL) * 1000;
+	watthour256 counter(lifetime);
+	counter += watthour256(1);
+
+	REQUIRE(metric::energy_cast<millijoule256>(counter).count() == (lifetime + 1) * 3600000);
+	REQUIRE(counter == millijoule256((lifetime + 1) * 3600000));
+	REQUIRE(counter > millijoule256(lifetime * 3600000));
+	REQUIRE(metric::to_string(metric::energy_cast<millijoule256>(counter).count()) == "33120000000000000000003600000");
+	REQUIRE(metric::to_string(-lifetime / 7) == "-1314285714285714285714");
+	REQUIRE((-lifetime) % 7 == metric::int256(-2));
+	REQUIRE(static_cast<long long>(counter.count() / 1000) == 9200000000000000000LL);
+	REQUIRE(static_cast<double>(lifetime) == Approx(9.2e21));
+	REQUIRE(metric::int256(9.2e21) == lifetime);
+
+	static_assert((18446744073709551616_i256).limb(1) == 1, "wide literals are constant expressions");
+	REQUIRE(57896044618658097711785492504343953926634992332820282019728792003956564819967_i256 == watthour256::max().count());
+	REQUIRE(watthour256::min().count() < watthour256::zero().count());
+	REQUIRE((watthour256::max().count() >> 254) == metric::int256(1));
+	REQUIRE((metric::int256(-8) >> 2) == metric::int256(-2));
+
+#ifdef METRIC_HAS_INT128
+	typedef metric::energy<metric::power<metric::int128>, std::chrono::seconds> joule128;
+	joule128 total(170141183460469231731687303715884105727_i128);
+	REQUIRE(total.count() == metric::limits_values<metric::int128>::max());
+	REQUIRE(metric::energy_cast<joule128>(metric::watthour(1)) == metric::joule(3600));
+	REQUIRE(metric::int256(total.count()) * 2 + 1 == metric::int256(metric::limits_values<metric::uint128>::max()));
+#endif
+}
+
+TEST_CASE( "Rounding casts (pass)", "[single-file]" )
+{
+	// 1.5 kWh, 2.5 kWh and their opposites.
+	REQUIRE(metric::floor_cast<metric::kilowatthour>(metric::wattsecond( 5400000)) == 1_kWh);
+	REQUIRE(metric::ceil_cast<metric::kilowatthour>( metric::wattsecond( 5400000)) == 2_kWh);
+	REQUIRE(metric::round_cast<metric::kilowatthour>(metric::wattsecond( 5400000)) == 2_kWh);
+	REQUIRE(metric::round_cast<metric::kilowatthour>(metric::wattsecond( 9000000)) == 2_kWh);
+	REQUIRE(metric::round_cast<metric::kilowatthour>(metric::wattsecond( 9000001)) == 3_kWh);
+	REQUIRE(metric::floor_cast<metric::kilowatthour>(metric::wattsecond(-5400000)) == metric::kilowatthour(-2));
+	REQUIRE(metric::ceil_cast<metric::kilowatthour>( metric::wattsecond(-5400000)) == metric::kilowatthour(-1));
+	REQUIRE(metric::round_cast<metric::kilowatthour>(metric::wattsecond(-5400000)) == metric::kilowatthour(-2));
+	REQUIRE(metric::round_cast<metric::kilowatthour>(metric::wattsecond(-9000000)) == metric::kilowatthour(-2));
+
+	REQUIRE(metric::round_cast<metric::kilometre>(metric::metre(2500)) == 2_km);
+	REQUIRE(metric::round_cast<metric::kilometre>(metric::metre(3500)) == 4_km);
+	REQUIRE(metric::floor_cast<metric::kilometre>(metric::metre(-1)) == metric::kilometre(-1));
+	REQUIRE(metric::ceil_cast<metric::kilometre>(metric::metre(1)) == 1_km);
+	REQUIRE(metric::round_cast<metric::millimetremercury>(metric::bar(1)) == 750_mmHg);
+	REQUIRE(metric::ceil_cast<metric::millimetremercury>(metric::bar(1)) == 751_mmHg);
+	REQUIRE(metric::floor_cast<metric::metre>(metric::distance<double, std::kilo>(1.2345)) == 1234_m);
+	REQUIRE(metric::round_cast<metric::millilitre_minute>(metric::millilitre_hour(90)) == metric::millilitre_minute(2));
+
+	const metric::wattsecond readings[] = {metric::wattsecond(5400000), metric::wattsecond(9000000), metric::wattsecond(-1)};
+	metric::kilowatthour billed[3];
+	metric::batch_round_cast<metric::kilowatthour>(readings, readings + 3, billed);
+	REQUIRE(billed[0] == 2_kWh);
+	REQUIRE(billed[1] == 2_kWh);
+	REQUIRE(billed[2] == 0_kWh);
+	metric::batch_ceil_cast<metric::kilowatthour>(readings, readings + 3, billed);
+	REQUIRE(billed[2] == 0_kWh);
+	REQUIRE(billed[1] == 3_kWh);
+	metric::batch_floor_cast<metric::kilowatthour>(readings, readings + 3, billed);
+	REQUIRE(billed[2] == metric::kilowatthour(-1));
+
+	metric::millimetre lengths[3];
+	const metric::metre metres[] = {1_m, 2_m, 3_m};
+	metric::batch_cast<metric::millimetre>(metres, metres + 3, lengths);
+	REQUIRE(lengths[2] == 3000_mm);
+
+	// Compound metrics go through the same cast, on the folded period of a count.
+	const metric::joule joules[] = {metric::joule(3600), metric::joule(7200000)};
+	metric::watthour watthours[2];
+	metric::batch_cast<metric::watthour>(joules, joules + 2, watthours);
+	REQUIRE(watthours[0] == metric::watthour(1));
+	REQUIRE(watthours[1] == metric::watthour(2000));
+	const metric::kilometre_hour speeds[] = {metric::kilometre_hour(36), metric::kilometre_hour(90)};
+	metric::metre_hour metre_hours[2];
+	metric::batch_cast<metric::metre_hour>(speeds, speeds + 2, metre_hours);
+	REQUIRE(metre_hours[1] == metric::metre_hour(90000));
+	const metric::millilitre_hour flows[] = {metric::millilitre_hour(90), metric::millilitre_hour(150)};
+	metric::millilitre_minute per_minute[2];
+	metric::batch_round_cast<metric::millilitre_minute>(flows, flows + 2, per_minute);
+	REQUIRE(per_minute[0] == metric::millilitre_minute(2));
+	REQUIRE(per_minute[1] == metric::millilitre_minute(2));
+	const metric::calorie calories[] = {metric::calorie(1000000)};
+	metric::joule folded[1];
+	metric::batch_cast<metric::joule>(calories, calories + 1, folded);
+	REQUIRE(folded[0] == metric::energy_cast<metric::joule>(calories[0]));
+}
+
+TEST_CASE( "Dimensional analysis (pass)", "[single-file]" )
+{
+	// Relations without dedicated operators.
+	REQUIRE(1000_Pa * 3_ml_sec == 3_mW);                 // Pressure * Flowrate = Power
+	REQUIRE(10_N * 3_m_sec == 30_W);                     // Force * Speed = Power
+	REQUIRE(10_N * 2_m == 20_j);                         // Force * Distance = Energy
+	REQUIRE(2_kg * metric::metre_second_squared(5) == 10_N);
+	REQUIRE(2_kg * (10_m_sec / std::chrono::seconds(2)) == 10_N);
+	REQUIRE((10_m_sec / std::chrono::seconds(2)) * 3 == metric::metre_second_squared(15));
+	REQUIRE(2 * metric::metre_second_squared(5) == metric::metre_second_squared(10));
+	REQUIRE(metric::metre_second_squared(15) / 2 == metric::metre_second_squared(7));
+	REQUIRE((metric::metre_second_squared(15) / 2.).count() == Approx(7.5));
+	REQUIRE((std::is_same<decltype(metric::millimetre_second_squared(3) * 1.5), metric::derived_quantity<metric::dimension<1, 0, -2, 0, 0>, double, std::milli> >::value));
+	REQUIRE(metric::metre(3) * metric::metre(4) == metric::square_metre(12));
+	REQUIRE(6_km / 2_m_sec == std::chrono::seconds(3000));
+	REQUIRE(20_Wh / 2_W == std::chrono::hours(10));
+	REQUIRE(metric::mass_cast<metric::gram>(2_l * (3_kg / 1_l)) == 6_kg);
+
+	// The scales are folded in the result period: one multiply, exact.
+	auto power = 1000_Pa * 3_ml_sec;
+	REQUIRE(power.count() == 3000);
+	REQUIRE((std::is_same<decltype(power), metric::power<long long, std::micro> >::value));
+	static_assert((10_N * 3_m_sec).count() == 30, "the product is a constant expression");
+	REQUIRE((std::is_same<decltype(std::chrono::seconds(2) * 3_mN), metric::derived_quantity<metric::dimension<1, 1, -1, 0, 0>, long long, std::milli> >::value));
+
+	// Dedicated operators are still chosen when they exist.
+	REQUIRE((std::is_same<decltype(2_kW * std::chrono::hours(3)), metric::kilowatthour>::value));
+	REQUIRE(metric::kiloohm(2) * metric::ampere(10) == metric::kilovolt(20));
+}
+
+TEST_CASE( "Electricity batch (pass)", "[single-file]" )
+{
+	static_assert((metric::kiloohm(2) * metric::milliampere(10000)).count() == 20000000, "the scale is folded at compile time");
+	static_assert((metric::kilowatt(20) / metric::millivolt(2000000)).count() == 10000, "the scale is folded at compile time");
+
+	const metric::kiloohm    r[4] = {metric::kiloohm(1), metric::kiloohm(2), metric::kiloohm(3), metric::kiloohm(4)};
+	const metric::milliampere i[4] = {metric::milliampere(500), metric::milliampere(1000), metric::milliampere(1500), metric::milliampere(2000)};
+	metric::millivolt u[4];
+	metric::batch_multiply<metric::millivolt>(r, r + 4, i, u);
+	REQUIRE(u[0] == metric::volt(500));
+	REQUIRE(u[3] == metric::volt(8000));
+
+	metric::milliampere back[4];
+	metric::batch_divide<metric::milliampere>(u, u + 4, r, back);
+	REQUIRE(std::equal(i, i + 4, back));
+
+	metric::watt p[4];
+	metric::batch_multiply<metric::watt>(u, u + 4, i, p);
+	REQUIRE(p[1] == metric::watt(2000));
+	REQUIRE(p[2] == metric::watt(6750));
+}
+
+TEST_CASE( "Mixed-unit comparisons (pass)", "[single-file]" )
+{
+	// 1e6 TPa = 7500616827041697.49 mmHg: the common_type of both periods would overflow.
+	REQUIRE(metric::terapascal(1000000) >  metric::millimetremercury(7500616827041697LL));
+	REQUIRE(metric::terapascal(1000000) <  metric::millimetremercury(7500616827041698LL));
+	REQUIRE(metric::terapascal(1000000) != metric::millimetremercury(7500616827041697LL));
+	REQUIRE(metric::bar(3) == metric::hectopascal(3000));
+	REQUIRE(metric::millibar(-1) < metric::pascal(-99));
+	REQUIRE(metric::millibar(-1) > metric::pascal(-101));
+	REQUIRE(metric::kilometre(1) == metric::metre(1000));
+	static_assert(metric::kilometre(1) > metric::metre(999), "comparisons are constant expressions");
+	// Narrower unsigned counts are cross-multiplied too; unsigned 64 bit ones keep the common_type,
+	// since their product with a period may not fit.
+	REQUIRE(metric::distance<unsigned int, std::kilo>(4000000000u) > metric::distance<unsigned int>(4000000000u));
+	REQUIRE(metric::distance<unsigned long long, std::milli>(18446744073000000000ULL) == metric::distance<unsigned long long>(18446744073000000ULL));
+	REQUIRE(metric::distance<unsigned long long, std::milli>(18446744073000000001ULL) > metric::distance<unsigned long long>(18446744073000000ULL));
+
+	const metric::pascal p[6] = {metric::pascal(-150), metric::pascal(-100), metric::pascal(0),
+	                             metric::pascal(99), metric::pascal(100), metric::pascal(101)};
+	bool mask[6];
+	metric::batch_less(p, p + 6, metric::millibar(1), mask);
+	REQUIRE((mask[0] && mask[1] && mask[2] && mask[3] && !mask[4] && !mask[5]));
+	metric::batch_less_equal(p, p + 6, metric::millibar(1), mask);
+	REQUIRE((mask[3] && mask[4] && !mask[5]));
+	metric::batch_greater(p, p + 6, metric::millibar(-1), mask);
+	REQUIRE((!mask[0] && !mask[1] && mask[2]));
+	metric::batch_greater_equal(p, p + 6, metric::millibar(-1), mask);
+	REQUIRE((!mask[0] && mask[1] && mask[2]));
+
+	// 1 mmHg = 133.32 Pa: the bound falls between two counts.
+	metric::batch_less(p, p + 6, metric::millimetremercury(1), mask);
+	REQUIRE((mask[5]));
+	metric::batch_greater(p, p + 6, metric::millimetremercury(-1), mask);
+	REQUIRE((!mask[0] && mask[1]));
+	metric::batch_greater(p, p + 6, metric::terapascal(1000000000), mask);
+	REQUIRE((!mask[0] && !mask[5]));
+	metric::batch_less(p, p + 6, metric::terapascal(-1000000000), mask);
+	REQUIRE((!mask[0] && !mask[5]));
+}
+
+TEST_CASE( "Reductions (pass)", "[single-file]" )
+{
+	std::vector<metric::kilowatt> load;
+	for (long long i = 0; i < 1001; ++i)
+		load.push_back(metric::kilowatt((i * 7919) % 1009 - 500));
+	load[600] = metric::kilowatt(-5000);
+	load[700] = metric::kilowatt(5000);
+	load[701] = metric::kilowatt(5000);
+
+	long long expected = 0;
+	for (std::size_t i = 0; i < load.size(); ++i)
+		expected += load[i].count();
+	auto total = metric::sum(load.data(), load.data() + load.size());
+	REQUIRE(static_cast<long long>(total.count()) == expected);
+	REQUIRE(total == metric::sum(load.begin(), load.end()));
+	REQUIRE(metric::minimum(load.data(), load.data() + load.size()) == metric::megawatt(-5));
+	REQUIRE(metric::maximum(load.begin(), load.end()) == metric::kilowatt(5000));
+	REQUIRE(metric::argmin(load.data(), load.data() + load.size()) == load.data() + 600);
+	REQUIRE(metric::argmax(load.data(), load.data() + load.size()) == load.data() + 700);
+	REQUIRE(metric::argmax(load.begin(), load.end()) == load.begin() + 700);
+	REQUIRE(metric::argmin(load.data(), load.data()) == load.data());
+
+	// The sum of 64-bit counts is exact beyond the range of long long.
+	const metric::pascal high[9] = {metric::pascal::max(), metric::pascal::max(), metric::pascal::max(),
+	                                metric::pascal::max(), metric::pascal::max(), metric::pascal::max(),
+	                                metric::pascal::max(), metric::pascal::max(), metric::pascal(-7)};
+	REQUIRE(metric::sum(high, high + 9).count() == metric::int256(metric::pascal::max().count()) * 8 - 7);
+	REQUIRE(metric::sum(high + 8, high + 9).count() == -7);
+	REQUIRE(metric::mean(high + 7, high + 9).count() == Approx(4.611686018427387904e18));
+
+	// Vector iterators are read as contiguous counts, like pointers.
+	const std::vector<metric::pascal> highs(high, high + 9);
+	REQUIRE(metric::sum(highs.begin(), highs.end()).count() == metric::int256(metric::pascal::max().count()) * 8 - 7);
+	REQUIRE(metric::sum(highs.cbegin() + 8, highs.cend()).count() == -7);
+	REQUIRE(metric::sum(highs.end(), highs.end()).count() == 0);
+	REQUIRE(metric::argmin(highs.begin(), highs.end()) == highs.begin() + 8);
+	REQUIRE(metric::maximum(highs.begin(), highs.end()) == metric::pascal::max());
+
+	const metric::millilitre_second flow[4] = {3_ml_sec, 1_ml_sec, 4_ml_sec, 2_ml_sec};
+	REQUIRE(metric::sum(flow, flow + 4) == 10_ml_sec);
+	REQUIRE(metric::mean(flow, flow + 4).count() == Approx(2.5));
+	REQUIRE(metric::maximum(flow, flow + 4) == 4_ml_sec);
+
+	const metric::power<double, std::kilo> readings[3] = {metric::power<double, std::kilo>(1.5), metric::power<double, std::kilo>(-0.5), metric::power<double, std::kilo>(2.)};
+	REQUIRE(metric::sum(readings, readings + 3).count() == Approx(3.));
+	REQUIRE(metric::argmin(readings, readings + 3) == readings + 1);
+	REQUIRE((std::is_same<decltype(metric::mean(load.begin(), load.end())), metric::power<double, std::kilo> >::value));
+}
+
+TEST_CASE( "Compensated summation (pass)", "[single-file]" )
+{
+	typedef metric::power<double> watt_d;
+
+	const watt_d cancel[3] = {watt_d(1e100), watt_d(1.), watt_d(-1e100)};
+	REQUIRE(metric::neumaier_accumulator<watt_d>().add(cancel, cancel + 3).value().count() == 1.);
+	REQUIRE(metric::reproducible_sum(cancel, cancel + 3).count() == 1.);
+
+	std::vector<watt_d> deltas;
+	for (int i = 0; i < 100000; ++i)
+		deltas.push_back(watt_d(0.1 * ((i * 7919) % 1000) - 50.) );
+	deltas.push_back(watt_d(1e-300));
+	deltas.push_back(watt_d(3.7e15));
+
+	metric::kahan_accumulator<watt_d> kahan;
+	metric::neumaier_accumulator<watt_d> neumaier;
+	for (std::size_t i = 0; i < deltas.size(); ++i)
+	{
+		kahan += deltas[i];
+		neumaier += deltas[i];
+	}
+	const double exact = metric::reproducible_sum(deltas.begin(), deltas.end()).count();
+	REQUIRE(kahan.value().count() == Approx(exact).epsilon(1e-15));
+	REQUIRE(neumaier.value().count() == exact);
+	REQUIRE(metric::neumaier_accumulator<watt_d>().add(deltas.begin(), deltas.end()).value().count() == exact);
+
+	// Bit-identical whatever the order and the split between accumulators.
+	std::vector<watt_d> shuffled(deltas.rbegin(), deltas.rend());
+	std::swap(shuffled[10], shuffled[90000]);
+	metric::reproducible_accumulator<watt_d> first, second;
+	first.add(shuffled.begin(), shuffled.begin() + 33333);
+	for (std::size_t i = 33333; i < shuffled.size(); ++i)
+		second += shuffled[i];
+	REQUIRE(first.merge(second).value().count() == exact);
+
+	const watt_d special[4] = {watt_d(1.), watt_d(std::numeric_limits<double>::infinity()), watt_d(-2.), watt_d(4.9e-324)};
+	REQUIRE(std::isinf(metric::reproducible_sum(special, special + 2).count()));
+	REQUIRE(metric::reproducible_sum(special + 2, special + 4).count() == -2.);
+	REQUIRE(metric::reproducible_sum(special + 3, special + 4).count() == 4.9e-324);
+	REQUIRE(metric::reproducible_sum(special, special).count() == 0.);
+	const watt_d huge[2] = {watt_d(std::numeric_limits<double>::max()), watt_d(std::numeric_limits<double>::max())};
+	REQUIRE(std::isinf(metric::reproducible_sum(huge, huge + 2).count()));
+	REQUIRE(metric::reproducible_sum(huge, huge + 1).count() == std::numeric_limits<double>::max());
+
+	// 2^77 fills the top bit of a limb: half an ulp rounds to even, and 1, two limbs below, rounds up.
+	const watt_d ties[3] = {watt_d(std::ldexp(1., 77)), watt_d(std::ldexp(1., 24)), watt_d(1.)};
+	REQUIRE(metric::reproducible_sum(ties, ties + 2).count() == std::ldexp(1., 77));
+	REQUIRE(metric::reproducible_sum(ties, ties + 3).count() == std::ldexp(1., 77) + std::ldexp(1., 25));
+
+	// The batch add, four addends at a time with AVX2, gives the sum of the single adds.
+	std::vector<watt_d> spread;
+	unsigned long long seed = 42;
+	for (int i = 0; i < 1003; ++i)
+	{
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		const double m = static_cast<double>(seed >> 11) / 9007199254740992.;
+		spread.push_back(watt_d((seed & 1 ? -m : m) * std::ldexp(1., static_cast<int>(seed >> 40) % 2090 - 1074)));
+	}
+	spread[7] = watt_d(4.9e-324);
+	metric::reproducible_accumulator<watt_d> batch, single;
+	batch.add(spread.begin(), spread.end());
+	for (std::size_t i = 0; i < spread.size(); ++i)
+		single += spread[i];
+	REQUIRE(batch.value().count() == single.value().count());
+	spread[500] = watt_d(-std::numeric_limits<double>::infinity());
+	REQUIRE(metric::reproducible_sum(spread.begin(), spread.end()).count() == -std::numeric_limits<double>::infinity());
+}
+
+struct counting_executor : metric::executor
+{
+	std::size_t tasks = 0;
+	void bulk(std::size_t n, const std::function<void(std::size_t)>& f)
+	{
+		tasks += n;
+		for (std::size_t i = n; i-- > 0; )
+			f(i);
+	}
+};
+
+TEST_CASE( "Parallel algorithms (pass)", "[single-file]" )
+{
+	std::vector<metric::wattsecond> usage;
+	for (long long i = 0; i < 300000; ++i)
+		usage.push_back(metric::wattsecond((i * 104729) % 1000003 * 1000000000LL));
+
+	metric::thread_pool pool(4);
+	REQUIRE(pool.size() == 4);
+	const auto sequential = metric::sum(usage.begin(), usage.end());
+	REQUIRE(metric::parallel_sum(usage.begin(), usage.end(), pool) == sequential);
+	REQUIRE(metric::parallel_sum(usage.begin(), usage.end()) == sequential);
+
+	std::vector<metric::kilowatthour> billed(usage.size()), expected(usage.size());
+	metric::batch_cast<metric::kilowatthour>(usage.begin(), usage.end(), expected.begin());
+	REQUIRE(metric::parallel_batch_cast<metric::kilowatthour>(usage.begin(), usage.end(), billed.begin(), pool) == billed.end());
+	REQUIRE(billed == expected);
+
+	counting_executor custom;
+	std::vector<long long> counts(usage.size());
+	metric::parallel_transform(usage.begin(), usage.end(), counts.begin(),
+		[](const metric::wattsecond& e) {return e.count();}, custom);
+	REQUIRE(custom.tasks == 5);
+	REQUIRE(counts[299999] == usage[299999].count());
+
+	auto larger = [](const metric::wattsecond& a, const metric::wattsecond& b) {return a < b ? b : a;};
+	REQUIRE(metric::parallel_reduce(usage.begin(), usage.end(), metric::wattsecond::zero(), larger, pool)
+	        == metric::maximum(usage.begin(), usage.end()));
+
+	// Floating point reductions do not depend on the number of threads.
+	std::vector<double> values(200000);
+	for (std::size_t i = 0; i < values.size(); ++i)
+		values[i] = 1. / (1. + static_cast<double>(i));
+	metric::sequential_executor one;
+	const double reference = metric::parallel_reduce(values.begin(), values.end(), 0., std::plus<double>(), one);
+	REQUIRE(metric::parallel_reduce(values.begin(), values.end(), 0., std::plus<double>(), pool) == reference);
+
+	REQUIRE_THROWS_AS(pool.bulk(100, [](std::size_t i) {if (i == 42) throw std::runtime_error("task");}), std::runtime_error);
+	std::atomic<std::size_t> calls(0);
+	pool.bulk(1000, [&](std::size_t) {pool.bulk(3, [&](std::size_t) {++calls;});});
+	REQUIRE(calls == 3000);
+}
+
+TEST_CASE( "Pipeline (pass)", "[single-file]" )
+{
+	typedef metric::energy<metric::power<double, std::kilo>, std::chrono::hours> kilowatthour_d;
+	typedef std::pair<int, kilowatthour_d> raw_reading;
+	typedef std::pair<int, metric::watthour> reading;
+
+	std::vector<std::string> lines;
+	for (int i = 0; i < 20000; ++i)
+	{
+		std::ostringstream line;
+		if (i % 1000 == 999)
+			line << "garbage";
+		else
+			line << (i % 7) << ' ' << (i % 10) * 0.25;
+		lines.push_back(line.str());
+	}
+
+	metric::stage<std::string, raw_reading> parse("parse", [](const std::string& line, raw_reading& out)
+	{
+		std::istringstream in(line);
+		double kwh;
+		if (!(in >> out.first >> kwh))
+			return false;
+		out.second = kilowatthour_d(kwh);
+		return true;
+	});
+	metric::stage<raw_reading, reading> normalize("normalize", [](const raw_reading& r)
+	{
+		return reading(r.first, metric::round_cast<metric::watthour>(r.second));
+	});
+	auto flow = metric::make_pipeline(parse).then(normalize);
+	flow.options().workers = 4;
+	flow.options().batch_size = 128;
+	flow.options().queue_capacity = 2;
+
+	std::map<int, metric::watthour> per_meter;
+	std::size_t batches = 0;
+	metric::thread_pool pool(3);
+	flow.run(lines.begin(), lines.end(), [&](const std::vector<reading>& batch)
+	{
+		++batches;
+		for (std::size_t i = 0; i < batch.size(); ++i)
+			per_meter[batch[i].first] += batch[i].second;
+	}, pool);
+
+	std::map<int, metric::watthour> expected;
+	for (int i = 0; i < 20000; ++i)
+		if (i % 1000 != 999)
+			expected[i % 7] += metric::watthour((i % 10) * 250);
+	REQUIRE(per_meter == expected);
+	REQUIRE(batches == 157);
+
+	const std::vector<metric::stage_statistics> stats = flow.statistics();
+	REQUIRE(stats.size() == 2);
+	REQUIRE(stats[0].name == "parse");
+	REQUIRE(stats[0].items_in == 20000);
+	REQUIRE(stats[0].items_out == 19980);
+	REQUIRE(stats[1].items_in == 19980);
+	REQUIRE(stats[1].batches == 157);
+
+	metric::sequential_executor one;
+	std::size_t items = 0;
+	flow.run(lines.begin(), lines.begin() + 10, [&](const std::vector<reading>& batch) {items += batch.size();}, one);
+	REQUIRE(items == 10);
+	REQUIRE(flow.statistics()[0].items_in == 20010);
+
+	metric::stage<reading, reading> failing("failing", [](const reading& r) -> reading
+	{
+		if (r.first == 3)
+			throw std::runtime_error("meter 3");
+		return r;
+	});
+	REQUIRE_THROWS_AS(flow.then(failing).run(lines.begin(), lines.end(), [](const std::vector<reading>&) {}, pool), std::runtime_error);
+}
+
+#ifdef METRIC_HAS_COROUTINES
+namespace {
+metric::stream::generator<metric::millilitre_second> flow_sensor(int n)
+{
+	for (int i = 0; i < n; ++i)
+		co_yield metric::millilitre_second(i);
+}
+
+metric::stream::task produce(metric::stream::channel<metric::millilitre_second>& out, int n, int& produced)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		if (!co_await out.send(metric::millilitre_second(i)))
+			break;
+		++produced;
+	}
+	out.close();
+}
+
+template <class T>
+metric::stream::task consume(metric::stream::channel<T>& in, std::vector<T>& values, const int& produced, int& lead)
+{
+	while (std::optional<T> v = co_await in.receive())
+	{
+		lead = std::max(lead, produced - static_cast<int>(values.size()));
+		values.push_back(*v);
+	}
+}
+
+metric::stream::task check_flow(metric::millilitre_second flow)
+{
+	if (flow < 0_ml_sec)
+		throw std::out_of_range("negative flow");
+	co_return;
+}
+}
+
+TEST_CASE( "Coroutine streams (pass)", "[single-file]" )
+{
+	std::vector<metric::microlitre_second> casted;
+	for (const metric::microlitre_second& v : metric::stream::cast<metric::microlitre_second>(flow_sensor(4)))
+		casted.push_back(v);
+	REQUIRE(casted == std::vector<metric::microlitre_second>{0_ul_sec, 1000_ul_sec, 2000_ul_sec, 3000_ul_sec});
+
+	std::vector<metric::millilitre> volume;
+	for (const metric::millilitre& v : metric::stream::integrate(flow_sensor(4), std::chrono::seconds(2)))
+		volume.push_back(v);
+	REQUIRE(volume == std::vector<metric::millilitre>{0_ml, 2_ml, 6_ml, 12_ml});
+
+	std::vector<std::size_t> sizes;
+	for (const std::vector<metric::millilitre_second>& w : metric::stream::window(flow_sensor(5), 2))
+		sizes.push_back(w.size());
+	REQUIRE(sizes == std::vector<std::size_t>{2, 2, 1});
+
+	int doubled = 0;
+	for (const metric::pascal& p : metric::stream::map(flow_sensor(3), [](const metric::millilitre_second& f) {return metric::pascal(2 * f.count());}))
+		doubled += static_cast<int>(p.count());
+	REQUIRE(doubled == 6);
+
+	// The producer never gets more than the capacity ahead of the consumer.
+	metric::stream::single_thread_scheduler loop;
+	metric::stream::channel<metric::millilitre_second> raw(loop, 3);
+	std::vector<metric::millilitre_second> received;
+	int produced = 0, lead = 0;
+	metric::stream::spawn(loop, produce(raw, 100, produced));
+	metric::stream::spawn(loop, consume(raw, received, produced, lead));
+	loop.run();
+	REQUIRE(received.size() == 100);
+	REQUIRE(received[99] == 99_ml_sec);
+	REQUIRE(lead <= 4);
+	REQUIRE(loop.tasks() == 0);
+
+	// Flow sensors integrated into volumes on a pool.
+	metric::stream::pool_scheduler pool(4);
+	metric::stream::channel<metric::millilitre_second> flows(pool, 2);
+	metric::stream::channel<metric::microlitre_second> fine(pool, 2);
+	metric::stream::channel<metric::microlitre> totals(pool, 2);
+	std::vector<metric::microlitre> integrated;
+	int sent = 0, unused = 0;
+	metric::stream::spawn(pool, consume(totals, integrated, unused, lead));
+	metric::stream::spawn(pool, metric::stream::integrate(fine, totals, std::chrono::seconds(1)));
+	metric::stream::spawn(pool, metric::stream::cast(flows, fine));
+	metric::stream::spawn(pool, produce(flows, 1000, sent));
+	pool.wait();
+	REQUIRE(sent == 1000);
+	REQUIRE(integrated.size() == 1000);
+	REQUIRE(integrated.back() == metric::microlitre(999 * 1000 / 2 * 1000));
+
+	// An exception escaping a task is rethrown once, to the thread joining the tasks.
+	metric::stream::spawn(loop, check_flow(metric::millilitre_second(-1)));
+	metric::stream::spawn(loop, check_flow(1_ml_sec));
+	REQUIRE_THROWS_AS(loop.run(), std::out_of_range);
+	REQUIRE(loop.tasks() == 0);
+	REQUIRE_NOTHROW(loop.run());
+	metric::stream::spawn(pool, check_flow(metric::millilitre_second(-1)));
+	metric::stream::spawn(pool, check_flow(metric::millilitre_second(-2)));
+	REQUIRE_THROWS_AS(pool.wait(), std::out_of_range);
+	REQUIRE_NOTHROW(pool.wait());
+}
+#endif
+
+TEST_CASE( "Sample ring buffers (pass)", "[single-file]" )
+{
+	typedef metric::sample<metric::millivolt> mv_sample;
+	static_assert(sizeof(mv_sample) == 16, "a millivolt sample holds a time point and a rep");
+	const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+	metric::spsc_ring<metric::millivolt> ring(5);
+	REQUIRE(ring.capacity() == 8);
+	std::vector<mv_sample> in, out(8);
+	for (int i = 0; i < 10; ++i)
+		in.push_back(mv_sample(t0 + std::chrono::microseconds(i), metric::millivolt(i)));
+	REQUIRE(ring.push(in.data(), 6) == 6);
+	REQUIRE(ring.pop(out.data(), 4) == 4);
+	REQUIRE(ring.push(in.data() + 6, 4) == 4);       // Wraps around.
+	REQUIRE_FALSE(ring.push(in.data(), 3) == 3);
+	REQUIRE(ring.size() == 8);
+	REQUIRE(ring.pop(out.data(), 8) == 8);
+	REQUIRE(out[0].value == 4_mV);
+	REQUIRE(out[5].value == 9_mV);
+	REQUIRE(out[5].time == t0 + std::chrono::microseconds(9));
+	mv_sample one;
+	REQUIRE_FALSE(ring.try_pop(one));
+
+	const long long count = 200000;
+	metric::spsc_ring<metric::millivolt> spsc(1024);
+	std::thread producer([&]
+	{
+		for (long long i = 0; i < count; )
+			if (spsc.try_push(mv_sample(t0, metric::millivolt(i))))
+				++i;
+	});
+	long long expected = 0;
+	bool ordered = true;
+	while (expected < count)
+	{
+		const std::size_t n = spsc.pop(out.data(), out.size());
+		for (std::size_t i = 0; i < n; ++i, ++expected)
+			ordered = ordered && out[i].value.count() == expected;
+	}
+	producer.join();
+	REQUIRE(ordered);
+
+	const long long per_producer = 50000;
+	metric::mpsc_ring<metric::millivolt> mpsc(256);
+	std::vector<std::thread> producers;
+	for (long long p = 0; p < 4; ++p)
+		producers.push_back(std::thread([&, p]
+		{
+			mv_sample batch[3];
+			for (long long i = 0; i < per_producer; )
+			{
+				std::size_t n = 0;
+				for (; n < 3 && i + static_cast<long long>(n) < per_producer; ++n)
+					batch[n] = mv_sample(t0, metric::millivolt(p * per_producer + i + static_cast<long long>(n)));
+				i += static_cast<long long>(mpsc.push(batch, n));
+			}
+		}));
+	std::vector<long long> next(4, 0);
+	long long received = 0;
+	ordered = true;
+	while (received < 4 * per_producer)
+	{
+		const std::size_t n = mpsc.pop(out.data(), out.size());
+		for (std::size_t i = 0; i < n; ++i, ++received)
+		{
+			const long long v = out[i].value.count();
+			ordered = ordered && v % per_producer == next[v / per_producer]++;
+		}
+	}
+	for (std::size_t p = 0; p < producers.size(); ++p)
+		producers[p].join();
+	REQUIRE(ordered);
+	REQUIRE(mpsc.empty());
+}
+
+TEST_CASE( "Compact arrays (pass)", "[single-file]" )
+{
+	std::vector<metric::millivolt> readings;
+	unsigned long long seed = 12345;
+	for (int i = 0; i < 1000; ++i)
+	{
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		readings.push_back(metric::millivolt(static_cast<long long>(seed >> 52) - 2048));
+	}
+	for (int i = 0; i < 64; ++i)
+		readings.push_back(-5_mV);                   // A constant block takes no word.
+
+	metric::compact_array<metric::millivolt> packed(readings.begin(), readings.end());
+	REQUIRE(packed.size() == readings.size());
+	REQUIRE(packed.lossless());
+	REQUIRE(packed.memory() * 4 < readings.size() * sizeof(metric::millivolt));
+	bool same = true;
+	for (std::size_t i = 0; i < readings.size(); ++i)
+		same = same && packed[i] == readings[i];
+	REQUIRE(same);
+	std::vector<metric::millivolt> unpacked(readings.size());
+	REQUIRE(packed.unpack(unpacked.data()) == unpacked.data() + unpacked.size());
+	REQUIRE(unpacked == readings);
+	std::vector<metric::millivolt> slice(100);
+	packed.unpack(50, 100, slice.data());
+	REQUIRE(std::equal(slice.begin(), slice.end(), readings.begin() + 50));
+
+	// The last packed block is constant: it owns no word and is decoded without reading one.
+	std::vector<metric::millivolt> steady(readings.begin(), readings.begin() + 64);
+	steady.insert(steady.end(), 64, 7_mV);
+	const metric::compact_array<metric::millivolt> settled(steady.begin(), steady.end());
+	std::vector<metric::millivolt> decoded(steady.size());
+	settled.unpack(decoded.data());
+	REQUIRE(decoded == steady);
+	settled.unpack(100, 28, decoded.data());
+	REQUIRE(decoded[27] == 7_mV);
+	const unsigned long long counters[] = {~0ULL, 3, 1ULL << 63, 5, 0, 9, 2, 1ULL << 62};
+	metric::compact_array<metric::frequency<unsigned long long>, 64> hits;
+	for (int i = 0; i < 64; ++i)
+		hits.push_back(metric::frequency<unsigned long long>(counters[i % 8]));
+	REQUIRE(hits[0].count() == ~0ULL);
+	REQUIRE(hits[4].count() == 0);
+
+	// 20 bits of range in 8-bit lanes: blocks share an exponent and round to the nearest step.
+	metric::compact_array<metric::pascal, 8> coarse;
+	std::vector<metric::pascal> wide;
+	for (long long i = 0; i < 200; ++i)
+	{
+		wide.push_back(metric::pascal(101325 + (i * 7919 % 1000000) - 500000));
+		coarse.push_back(wide.back());
+	}
+	REQUIRE_FALSE(coarse.lossless());
+	std::vector<metric::pascal> approx(wide.size());
+	coarse.unpack(approx.data());
+	long long worst = 0;
+	for (std::size_t i = 0; i < wide.size(); ++i)
+		worst = std::max(worst, std::abs((approx[i] - wide[i]).count()));
+	REQUIRE(worst <= 2048);
+	REQUIRE(worst > 0);
+	REQUIRE(coarse[199] == wide[199]);               // Still in the unpacked tail.
+}
+
+TEST_CASE( "Half precision representations (pass)", "[single-file]" )
+{
+	typedef metric::pressure<metric::float16, std::ratio<100, 101325> > hpa16;
+	typedef metric::pressure<float, std::ratio<1, 101325> > pa32;
+	typedef metric::power<metric::bfloat16, std::kilo> kw16;
+	static_assert(sizeof(hpa16) == 2 && sizeof(kw16) == 2, "16-bit storage");
+	static_assert(metric::treat_as_floating_point<metric::float16>::value, "float16 is a floating point rep");
+
+	hpa16 p(1013.25);
+	REQUIRE(static_cast<float>(p.count()) == 1013.0f);     // 10-bit mantissa: steps of 0.5 from 512.
+	pa32 pa = p;
+	REQUIRE(pa.count() == 101300.0f);
+	REQUIRE(metric::pressure_cast<metric::hectopascal>(p) == 1013_hPa);
+	REQUIRE(p + p == hpa16(2026));
+	REQUIRE(p < hpa16(1014));
+	REQUIRE(static_cast<float>((p * 2).count()) == 2026.0f);
+	p += hpa16(0.5);
+	REQUIRE(static_cast<float>(p.count()) == 1013.5f);
+
+	REQUIRE(metric::float16(65504.0f).bits() == 0x7bff);
+	REQUIRE(metric::float16(65520.0f).bits() == 0x7c00);   // Ties to even, here infinity.
+	REQUIRE(metric::float16(1.0f + 1.0f / 2048).bits() == 0x3c00);
+	REQUIRE(metric::float16(1.0f + 3.0f / 2048).bits() == 0x3c02);
+	REQUIRE(metric::float16(std::ldexp(1.0f, -24)).bits() == 0x0001);
+	REQUIRE(static_cast<float>(metric::float16::from_bits(0x03ff)) == std::ldexp(1023.0f, -24));
+	REQUIRE(std::isnan(static_cast<float>(metric::float16(std::nanf("")))));
+	REQUIRE(metric::bfloat16(1.0f + 1.0f / 256).bits() == 0x3f80);
+	REQUIRE(metric::bfloat16(1.0f + 3.0f / 256).bits() == 0x3f82);
+	REQUIRE(static_cast<float>(kw16(3.5).count()) == 3.5f);
+	REQUIRE(metric::power<metric::bfloat16>(kw16(2)).count() == 2000.0f);
+
+	std::vector<pa32> wide;
+	unsigned long long seed = 777;
+	for (int i = 0; i < 1003; ++i)
+	{
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		wide.push_back(pa32(std::ldexp(static_cast<float>(seed >> 40) - 8388608.0f, static_cast<int>(seed % 40) - 30)));
+	}
+	wide[5] = pa32(std::numeric_limits<float>::infinity());
+	wide[6] = pa32(std::nanf(""));
+	wide[7] = pa32(1e-7f);
+	typedef metric::pressure<metric::float16, std::ratio<1, 101325> > pa16;
+	typedef metric::pressure<metric::bfloat16, std::ratio<1, 101325> > pab16;
+	std::vector<pa16> narrow(wide.size());
+	std::vector<pab16> brain(wide.size());
+	metric::batch_narrow(wide.data(), wide.data() + wide.size(), narrow.data());
+	metric::batch_narrow(wide.data(), wide.data() + wide.size(), brain.data());
+	bool same = true;
+	for (std::size_t i = 0; i < wide.size(); ++i)
+		same = same && narrow[i].count().bits() == metric::float16(wide[i].count()).bits()
+		            && brain[i].count().bits() == metric::bfloat16(wide[i].count()).bits();
+	REQUIRE(same);
+	std::vector<pa32> back(wide.size()), back_b(wide.size());
+	metric::batch_widen(narrow.data(), narrow.data() + narrow.size(), back.data());
+	metric::batch_widen(brain.data(), brain.data() + brain.size(), back_b.data());
+	for (std::size_t i = 0; i < wide.size(); ++i)
+		same = same && (std::isnan(back[i].count()) || back[i].count() == static_cast<float>(narrow[i].count()))
+		            && (std::isnan(back_b[i].count()) || back_b[i].count() == static_cast<float>(brain[i].count()));
+	REQUIRE(same);
+
+	std::vector<kw16> load(1000, kw16(1.5));
+	auto total = metric::sum(load.begin(), load.end());
+	REQUIRE(total.count() == 1500.0);
+}
+
+TEST_CASE( "Typed views over raw buffers (pass)", "[single-file]" )
+{
+	static_assert(metric::is_rep_layout_compatible<metric::degree_second>::value, "angularspeed");
+	static_assert(metric::is_rep_layout_compatible<metric::attometre>::value, "distance");
+	static_assert(metric::is_rep_layout_compatible<metric::femtoampere>::value, "electriccurrent");
+	static_assert(metric::is_rep_layout_compatible<metric::abohm>::value, "electricresistance");
+	static_assert(metric::is_rep_layout_compatible<metric::microwatthour>::value, "energy");
+	static_assert(metric::is_rep_layout_compatible<metric::millilitre_second>::value, "flowrate");
+	static_assert(metric::is_rep_layout_compatible<metric::millinewton>::value, "force");
+	static_assert(metric::is_rep_layout_compatible<metric::millihertz>::value, "frequency");
+	static_assert(metric::is_rep_layout_compatible<metric::nanogram>::value, "mass");
+	static_assert(metric::is_rep_layout_compatible<metric::nanowatt>::value, "power");
+	static_assert(metric::is_rep_layout_compatible<metric::pascal>::value, "pressure");
+	static_assert(metric::is_rep_layout_compatible<metric::micrometre_second>::value, "speed");
+	static_assert(metric::is_rep_layout_compatible<metric::millivolt>::value, "voltage");
+	static_assert(metric::is_rep_layout_compatible<metric::millilitre>::value, "volume");
+	static_assert(metric::is_rep_layout_compatible<metric::voltage<std::int32_t, std::milli> >::value, "32-bit rep");
+	static_assert(metric::is_rep_layout_compatible<metric::voltage<metric::float16> >::value, "16-bit rep");
+	static_assert(metric::is_rep_layout_compatible<metric::derived_quantity<metric::dimension<1, 0, -2, 0, 0>, double, std::ratio<1> > >::value, "derived");
+
+	typedef metric::voltage<std::int32_t, std::milli> millivolt32;
+	std::int32_t dma[12] = {100, -1, 7, 200, -2, 8, 300, -3, 9, 400, -4, 10};
+	metric::quantity_span<millivolt32> all(dma, 12);
+	REQUIRE(all.size() == 12);
+	REQUIRE(all[3] == millivolt32(200));
+	REQUIRE(static_cast<void*>(all.data()) == static_cast<void*>(dma));
+	all[0] += millivolt32(5);
+	REQUIRE(dma[0] == 105);
+	metric::quantity_span<const millivolt32> ro = all.subspan(3, 3);
+	REQUIRE(ro.counts() == dma + 3);
+	REQUIRE(ro.last(1)[0] == millivolt32(8));
+
+	const std::int64_t raw[4] = {1000, 2000, 3000, 4000};
+	metric::quantity_span<const metric::voltage<std::int64_t, std::milli> > mv(raw, 4);
+	REQUIRE(metric::sum(mv.begin(), mv.end()) == 10_V);
+
+	metric::interleaved_view<millivolt32> frames(dma, 4, 3);
+	metric::strided_span<millivolt32> first = frames.channel(0);
+	REQUIRE(first.size() == 4);
+	REQUIRE(first[3] == millivolt32(400));
+	REQUIRE(metric::sum(first.begin(), first.end()) == 1005_mV);
+	REQUIRE(metric::maximum(frames.channel(1).begin(), frames.channel(1).end()) == millivolt32(-1));
+	REQUIRE(frames.channel(2).end() - frames.channel(2).begin() == 4);
+	REQUIRE(frames.frame(2)[1] == millivolt32(-3));
+	frames(1, 2) = millivolt32(80);
+	REQUIRE(dma[5] == 80);
+	std::vector<millivolt32> copy(frames.channel(2).begin(), frames.channel(2).end());
+	REQUIRE(copy == std::vector<millivolt32>{millivolt32(7), millivolt32(80), millivolt32(9), millivolt32(10)});
+	metric::strided_span<millivolt32> last = frames.channel(2);
+	std::vector<millivolt32> reversed(std::reverse_iterator<metric::strided_iterator<millivolt32> >(last.end()),
+	                                  std::reverse_iterator<metric::strided_iterator<millivolt32> >(last.begin()));
+	REQUIRE(reversed.front() == millivolt32(10));
+	REQUIRE(last.end()[-2] == millivolt32(9));
+	REQUIRE(last.begin() < last.end());
+}
+
+TEST_CASE( "Quantity hashing and flat hash containers (pass)", "[single-file]" )
+{
+	std::hash<metric::kilowatt> hkw;
+	std::hash<metric::watt> hw;
+	REQUIRE(hkw(1_kW) == hw(1000_W));
+	REQUIRE(std::hash<metric::milliwatt>()(500_mW) == std::hash<metric::microwatt>()(500000_uW));
+	REQUIRE(std::hash<metric::pascal>()(metric::pascal(1000)) == std::hash<metric::kilopascal>()(metric::kilopascal(1)));
+	REQUIRE(std::hash<metric::watt>()(-0_W) == std::hash<metric::power<double> >()(metric::power<double>(-0.0)));
+	REQUIRE(std::hash<metric::power<double, std::kilo> >()(metric::power<double, std::kilo>(1.5)) == hw(1500_W));
+	REQUIRE(std::hash<metric::kilometre_hour>()(metric::kilometre_hour(36)) == std::hash<metric::metre_second>()(metric::metre_second(10)));
+	REQUIRE(hw(1_W) != hw(2_W));
+
+	metric::flat_hash_map<metric::watt, int> setpoints;
+	for (int i = 0; i < 1000; ++i)
+		setpoints[metric::watt(i * 10)] = i;
+	REQUIRE(setpoints.size() == 1000);
+	REQUIRE(setpoints.at(metric::watt(5000)) == 500);
+	REQUIRE(setpoints.find(1_kW)->second == 100);
+	REQUIRE(setpoints.contains(metric::milliwatt(20000)));
+	REQUIRE(!setpoints.contains(metric::milliwatt(20001)));
+	REQUIRE_THROWS_AS(setpoints.at(3_W), std::out_of_range);
+	REQUIRE(!setpoints.insert(std::make_pair(10_W, 7)).second);
+	REQUIRE(setpoints[10_W] == 1);
+
+	for (int i = 0; i < 1000; i += 2)
+		REQUIRE(setpoints.erase(metric::watt(i * 10)) == 1);
+	REQUIRE(setpoints.erase(0_W) == 0);
+	REQUIRE(setpoints.size() == 500);
+	int total = 0;
+	for (metric::flat_hash_map<metric::watt, int>::const_iterator it = setpoints.begin(); it != setpoints.end(); ++it)
+		total += it->second;
+	REQUIRE(total == 250000);
+	for (int i = 0; i < 1000; ++i)
+		REQUIRE(setpoints.contains(metric::watt(i * 10)) == (i % 2 == 1));
+
+	metric::flat_hash_map<metric::watt, int> copy = setpoints;
+	setpoints.clear();
+	REQUIRE(setpoints.empty());
+	REQUIRE(copy.size() == 500);
+	REQUIRE(copy[metric::watt(9990)] == 999);
+
+	metric::flat_hash_set<metric::millivolt> thresholds = {100_mV, 1_V, 2500_mV};
+	REQUIRE(thresholds.size() == 3);
+	REQUIRE(thresholds.count(1000_mV) == 1);
+	REQUIRE(thresholds.contains(metric::microvolt(2500000)));
+	REQUIRE(!thresholds.insert(metric::millivolt(1000)).second);
+	REQUIRE(*thresholds.find(metric::microvolt(100000)) == 100_mV);
+	REQUIRE(std::distance(thresholds.begin(), thresholds.end()) == 3);
+}
+
+struct meter_hour
+{
+	int meter;
+	int hour;
+	bool operator==(const meter_hour& o) const {return meter == o.meter && hour == o.hour;}
+};
+
+struct meter_hour_hash
+{
+	std::size_t operator()(const meter_hour& k) const {return std::hash<long long>()(static_cast<long long>(k.meter) << 32 | static_cast<unsigned>(k.hour));}
+};
+
+TEST_CASE( "Group-by aggregation (pass)", "[single-file]" )
+{
+	const std::size_t rows = 300000;
+	std::vector<int> meters(rows);
+	std::vector<metric::watthour> energies(rows);
+	std::vector<metric::kilowatt> peaks(rows);
+	for (std::size_t i = 0; i < rows; ++i)
+	{
+		meters[i] = static_cast<int>((i * 7919) % 1000);
+		energies[i] = metric::watthour(static_cast<long long>(i % 13) - 2);
+		peaks[i] = metric::kilowatt(static_cast<long long>(i % 101));
+	}
+
+	std::map<int, long long> sums;
+	std::map<int, std::size_t> counts;
+	std::map<int, long long> maxima;
+	for (std::size_t i = 0; i < rows; ++i)
+	{
+		sums[meters[i]] += energies[i].count();
+		++counts[meters[i]];
+		maxima[meters[i]] = std::max(maxima[meters[i]], peaks[i].count());
+	}
+
+	metric::thread_pool pool(4);
+	auto groups = metric::parallel_group_by(pool, meters.begin(), meters.end(), energies.begin(), peaks.begin());
+	REQUIRE(groups.size() == 1000);
+	bool all = true;
+	for (std::size_t g = 0; g < groups.size(); ++g)
+	{
+		const int m = groups[g].key;
+		all = all && groups[g].count == counts[m];
+		all = all && groups[g].sum<0>().count() == sums[m];
+		all = all && groups[g].maximum<1>().count() == maxima[m];
+		all = all && groups[g].mean<0>().count() == Approx(static_cast<double>(sums[m]) / counts[m]);
+	}
+	REQUIRE(all);
+	REQUIRE(groups[0].minimum<0>() <= groups[0].maximum<0>());
+
+	auto sequential = metric::group_by(meters.begin(), meters.end(), energies.begin(), peaks.begin());
+	REQUIRE(sequential.size() == groups.size());
+	bool same = true;
+	for (std::size_t g = 0; g < groups.size(); ++g)
+		same = same && sequential[g].key == groups[g].key && sequential[g].sum<0>() == groups[g].sum<0>();
+	REQUIRE(same);
+
+	std::vector<meter_hour> keys = {{1, 0}, {2, 0}, {1, 0}, {1, 1}, {2, 0}};
+	std::vector<metric::kilowatthour> kwh = {1_kWh, 2_kWh, 3_kWh, 4_kWh, 5_kWh};
+	auto hourly = metric::group_by<meter_hour_hash>(keys.begin(), keys.end(), kwh.begin());
+	REQUIRE(hourly.size() == 3);
+	for (std::size_t g = 0; g < hourly.size(); ++g)
+	{
+		if (hourly[g].key == meter_hour{1, 0})
+			REQUIRE(hourly[g].sum<0>() == 4_kWh);
+		else if (hourly[g].key == meter_hour{2, 0})
+			REQUIRE((hourly[g].count == 2 && hourly[g].minimum<0>() == 2_kWh && hourly[g].maximum<0>() == 5_kWh));
+		else
+			REQUIRE(hourly[g].sum<0>() == 4_kWh);
+	}
+
+	std::vector<int> none;
+	REQUIRE(metric::group_by(none.begin(), none.end()).empty());
+}
+
+TEST_CASE( "Radix sorts (pass)", "[single-file]" )
+{
+	std::vector<metric::pascal> pa;
+	for (long long i = 0; i < 5000; ++i)
+		pa.push_back(metric::pascal(((i * 2654435761LL) % 100003) - 50000));
+	pa.push_back(metric::pascal::min());
+	pa.push_back(metric::pascal::max());
+	std::vector<metric::pascal> expected = pa;
+	std::sort(expected.begin(), expected.end());
+	metric::radix_sort(pa.begin(), pa.end());
+	REQUIRE(pa == expected);
+
+	std::vector<metric::power<double> > watts = {metric::power<double>(2.5), metric::power<double>(-0.0), metric::power<double>(-3.25),
+		metric::power<double>(1e300), metric::power<double>(0.0), metric::power<double>(-1e-300), metric::power<double>(7.0)};
+	for (int i = 0; i < 1000; ++i)
+		watts.push_back(metric::power<double>((i % 37) * 0.75 - 10.0));
+	std::vector<std::size_t> order(watts.size());
+	metric::radix_argsort(watts.begin(), watts.end(), order.begin());
+	bool ordered = true, stable = true;
+	for (std::size_t i = 1; i < order.size(); ++i)
+	{
+		ordered = ordered && watts[order[i - 1]] <= watts[order[i]];
+		stable = stable && (watts[order[i - 1]] != watts[order[i]] || order[i - 1] < order[i]);
+	}
+	REQUIRE(ordered);
+	REQUIRE(stable);
+	REQUIRE(order[0] == 7);
+	REQUIRE(order[order.size() - 1] == 3);
+	metric::radix_sort(watts.begin(), watts.end());
+	REQUIRE(std::is_sorted(watts.begin(), watts.end()));
+	REQUIRE(watts.front() == metric::power<double>(-10.0));
+
+	std::vector<metric::voltage<std::int16_t> > small = {metric::voltage<std::int16_t>(3), metric::voltage<std::int16_t>(-4), metric::voltage<std::int16_t>(0)};
+	metric::radix_sort(small.begin(), small.end());
+	REQUIRE(small[0].count() == -4);
+	REQUIRE(small[2].count() == 3);
+
+	typedef metric::power<metric::float16> watt16;
+	std::vector<watt16> half = {watt16(2.5), watt16(-0.0), watt16(-3.25), watt16(60000.), watt16(0.0), watt16(-0.001), watt16(7.0)};
+	metric::radix_sort(half.begin(), half.end());
+	REQUIRE(static_cast<float>(half.front().count()) == -3.25f);
+	REQUIRE(static_cast<float>(half.back().count()) == 60000.f);
+	bool half_sorted = true;
+	for (std::size_t i = 1; i < half.size(); ++i)
+		half_sorted = half_sorted && static_cast<float>(half[i - 1].count()) <= static_cast<float>(half[i].count());
+	REQUIRE(half_sorted);
+	std::vector<metric::power<metric::bfloat16> > brain = {metric::power<metric::bfloat16>(1.0), metric::power<metric::bfloat16>(-2.0),
+		metric::power<metric::bfloat16>(0.5)};
+	std::vector<std::size_t> brain_order(3);
+	metric::radix_argsort(brain.begin(), brain.end(), brain_order.begin());
+	REQUIRE(brain_order == std::vector<std::size_t>{1, 2, 0});
+
+	std::vector<metric::kilopascal> kpa = {metric::kilopascal(3), metric::kilopascal(-1)};
+	std::vector<metric::hectopascal> hpa = {metric::hectopascal(25), metric::hectopascal(-10)};
+	std::vector<metric::pascal> pas = {metric::pascal(2999), metric::pascal(-1000)};
+	metric::mixed_unit_sorter<metric::pascal> mixed;
+	mixed.add(kpa.begin(), kpa.end());
+	mixed.add(hpa.begin(), hpa.end());
+	mixed.add(pas.begin(), pas.end());
+	REQUIRE(mixed.size() == 6);
+	std::vector<metric::pascal> all(6);
+	mixed.sort(all.begin());
+	REQUIRE(all == std::vector<metric::pascal>{metric::pascal(-1000), metric::pascal(-1000), metric::pascal(-1000),
+		metric::pascal(2500), metric::pascal(2999), metric::pascal(3000)});
+	std::vector<std::size_t> from(6);
+	mixed.argsort(from.begin());
+	REQUIRE(from == std::vector<std::size_t>{1, 3, 5, 2, 4, 0});
+}
+
+TEST_CASE( "Quantile sketches (pass)", "[single-file]" )
+{
+	std::vector<metric::millilitre_second> flows;
+	for (long long i = 0; i < 100000; ++i)
+		flows.push_back(metric::millilitre_second((i * 7919) % 100000));
+	std::vector<metric::millilitre_second> sorted = flows;
+	std::sort(sorted.begin(), sorted.end());
+
+	metric::tdigest<metric::millilitre_second> all, low, high;
+	all.add(flows.begin(), flows.end());
+	std::thread first([&] {low.add(flows.begin(), flows.begin() + 50000);});
+	std::thread second([&] {high.add(flows.begin() + 50000, flows.end());});
+	first.join();
+	second.join();
+	low.merge(high);
+	REQUIRE(low.count() == 100000);
+	REQUIRE(low.centroids() <= metric::tdigest<metric::millilitre_second>::capacity);
+	REQUIRE(all.minimum().count() == 0);
+	REQUIRE(all.maximum().count() == 99999);
+	for (double q : {0.01, 0.5, 0.9, 0.99, 0.999})
+	{
+		const double exact = static_cast<double>(sorted[static_cast<std::size_t>(q * 100000)].count());
+		REQUIRE(std::abs(all.quantile(q).count() - exact) < 100000 * 0.01);
+		REQUIRE(std::abs(low.quantile(q).count() - exact) < 100000 * 0.01);
+	}
+	REQUIRE(std::abs(all.quantile(0.99).count() - 99000) < 100);
+	metric::tdigest<metric::millilitre_second>::quantile_type p99 = all.quantile(0.99);
+	REQUIRE(metric::flowrate_cast<metric::flowrate<metric::volume<double>, std::chrono::seconds>>(p99).count() == Approx(99.).epsilon(0.01));
+
+	const std::vector<unsigned char> bytes = low.serialize();
+	const metric::tdigest<metric::millilitre_second> copy = metric::tdigest<metric::millilitre_second>::deserialize(bytes.data(), bytes.size());
+	REQUIRE(copy.count() == low.count());
+	REQUIRE(copy.quantile(0.5).count() == low.quantile(0.5).count());
+	REQUIRE_THROWS_AS(metric::tdigest<metric::millilitre_second>::deserialize(bytes.data(), bytes.size() - 1), std::invalid_argument);
+	REQUIRE_THROWS_AS((metric::tdigest<metric::millilitre_second, 50>::deserialize(bytes.data(), bytes.size())), std::invalid_argument);
+
+	// Const reads leave the sketch as it is, buffered values included: threads may share it.
+	const metric::tdigest<metric::millilitre_second>& shared = all;
+	double seen[2];
+	std::thread reader([&] {seen[0] = shared.quantile(0.99).count();});
+	seen[1] = shared.quantile(0.99).count();
+	reader.join();
+	REQUIRE(seen[0] == seen[1]);
+	const std::size_t centroids = all.centroids();
+	all.compress();
+	REQUIRE(all.centroids() == centroids);
+	REQUIRE(all.quantile(0.99).count() == seen[0]);
+
+	metric::tdigest<metric::millilitre_second> twice = copy;
+	twice.merge(twice);
+	REQUIRE(twice.count() == 2 * copy.count());
+	REQUIRE(std::abs(twice.quantile(0.5).count() - copy.quantile(0.5).count()) < 100000 * 0.01);
+
+	metric::tdigest<metric::millivolt> single;
+	REQUIRE(single.quantile(0.5).count() == 0);
+	single.add(metric::millivolt(42));
+	REQUIRE(single.quantile(0).count() == 42);
+	REQUIRE(single.quantile(0.5).count() == 42);
+	REQUIRE(single.quantile(1).count() == 42);
+
+	typedef metric::log_histogram<metric::millivolt> ripple_histogram;
+	ripple_histogram ripple, other;
+	for (long long i = -1000; i < 9000; ++i)
+		(i < 4000 ? ripple : other).add(metric::millivolt(i));
+	ripple.merge(other);
+	REQUIRE(ripple.count() == 10000);
+	REQUIRE(ripple.minimum() == metric::millivolt(-1000));
+	REQUIRE(ripple.maximum() == metric::millivolt(8999));
+	REQUIRE(ripple.quantile(0).count() == -1000);
+	REQUIRE(ripple.quantile(1).count() == 8999);
+	for (double q : {0.05, 0.1, 0.5, 0.99})
+	{
+		const double exact = q * 10000 - 1001;
+		REQUIRE(std::abs(ripple.quantile(q).count() - exact) <= std::abs(exact) / 32 + 1);
+	}
+	ripple_histogram small;
+	for (int i = 0; i < 10; ++i)
+		small.add(metric::millivolt(i));
+	REQUIRE(small.quantile(0.5).count() == 4);
+	REQUIRE(small.quantile(0.95).count() == 9);
+
+	const std::vector<unsigned char> hist_bytes = ripple.serialize();
+	REQUIRE(hist_bytes.size() < ripple_histogram::buckets * 8);
+	const ripple_histogram restored = ripple_histogram::deserialize(hist_bytes.data(), hist_bytes.size());
+	REQUIRE(restored.count() == ripple.count());
+	REQUIRE(restored.minimum() == ripple.minimum());
+	REQUIRE(restored.quantile(0.99).count() == ripple.quantile(0.99).count());
+	REQUIRE_THROWS_AS(ripple_histogram::deserialize(bytes.data(), bytes.size()), std::invalid_argument);
+}
+
+TEST_CASE( "Rolling windows (pass)", "[single-file]" )
+{
+	std::vector<metric::hectopascal> readings;
+	for (long long i = 0; i < 2000; ++i)
+		readings.push_back(metric::hectopascal(1013 + ((i * 7919) % 61) - 30));
+
+	metric::rolling_window<metric::hectopascal> last(16);
+	REQUIRE(last.empty());
+	REQUIRE(last.capacity() == 16);
+	bool same = true;
+	for (std::size_t i = 0; i < readings.size(); ++i)
+	{
+		last.push(readings[i]);
+		const std::size_t b = i + 1 < 16 ? 0 : i + 1 - 16;
+		metric::hectopascal lo = *std::min_element(readings.begin() + b, readings.begin() + i + 1);
+		metric::hectopascal hi = *std::max_element(readings.begin() + b, readings.begin() + i + 1);
+		long long total = 0;
+		for (std::size_t j = b; j <= i; ++j)
+			total += readings[j].count();
+		same = same && last.minimum() == lo && last.maximum() == hi && last.sum().count() == total
+			&& last.size() == i + 1 - b && last.front() == readings[b] && last.back() == readings[i];
+	}
+	REQUIRE(same);
+	REQUIRE(last.full());
+	REQUIRE(last.mean().count() == Approx(static_cast<double>(last.sum().count()) / 16));
+
+	metric::rolling_window<metric::hectopascal> batch(16);
+	batch.push(readings[0]);
+	batch.push(readings.begin(), readings.end());
+	REQUIRE(batch.size() == 16);
+	REQUIRE(batch.minimum() == last.minimum());
+	REQUIRE(batch.maximum() == last.maximum());
+	REQUIRE(batch.sum().count() == last.sum().count());
+	batch.clear();
+	REQUIRE(batch.empty());
+	batch.push(metric::hectopascal(5));
+	REQUIRE(batch.minimum() == metric::hectopascal(5));
+
+	metric::rolling_window<metric::voltage<double>> smooth(3);
+	for (double v : {1e16, 1.0, -1e16, 2.0, 3.0})
+		smooth.push(metric::voltage<double>(v));
+	REQUIRE(smooth.minimum().count() == -1e16);
+	smooth.push(metric::voltage<double>(4.0));
+	REQUIRE(smooth.sum().count() == 9.0);
+	REQUIRE(smooth.mean().count() == 3.0);
+
+	typedef metric::timed_window<metric::millivolt> volt_window;
+	volt_window recent(std::chrono::seconds(10));
+	const volt_window::time_point start;
+	std::vector<volt_window::value_type> samples;
+	for (int i = 0; i < 100; ++i)
+		samples.push_back(volt_window::value_type(start + std::chrono::seconds(i), metric::millivolt(i % 2 ? 1000 + i : 1000 - i)));
+	recent.push(samples.begin(), samples.begin() + 50);
+	REQUIRE(recent.size() == 10);
+	REQUIRE(recent.oldest() == start + std::chrono::seconds(40));
+	REQUIRE(recent.newest() == start + std::chrono::seconds(49));
+	REQUIRE(recent.minimum() == metric::millivolt(1000 - 48));
+	REQUIRE(recent.maximum() == metric::millivolt(1000 + 49));
+	REQUIRE(recent.sum().count() == 10000 + 5);
+	recent.advance(start + std::chrono::seconds(58));
+	REQUIRE(recent.size() == 1);
+	REQUIRE(recent.front() == metric::millivolt(1049));
+	recent.push(samples[70]);
+	REQUIRE(recent.size() == 1);
+	REQUIRE(recent.minimum() == metric::millivolt(930));
+	recent.clear();
+	REQUIRE(recent.empty());
+	REQUIRE(recent.span() == std::chrono::seconds(10));
+}
+
+TEST_CASE( "Filters (pass)", "[single-file]" )
+{
+	const double pi = 3.14159265358979323846;
+	const metric::hertz rate(1000);
+
+	metric::ema<metric::millivolt> smooth(metric::hertz(10), rate);
+	REQUIRE(smooth.smoothing() == Approx(1 - std::exp(-2 * pi * 0.01)));
+	REQUIRE(smooth(metric::millivolt(1000)) == metric::millivolt(1000));
+	REQUIRE(smooth(metric::millivolt(1000)) == metric::millivolt(1000));
+	REQUIRE(smooth(metric::millivolt(2000)).count() == 1000 + static_cast<long long>(std::nearbyint(1000 * smooth.smoothing())));
+	metric::ema<metric::millivolt> slow(metric::millihertz(10000), metric::kilohertz(1));
+	REQUIRE(slow.smoothing() == smooth.smoothing());
+	REQUIRE_THROWS_AS(metric::ema<metric::millivolt>(metric::hertz(500), rate), std::invalid_argument);
+	REQUIRE_THROWS_AS(metric::ema<metric::millivolt>(metric::hertz(0), rate), std::invalid_argument);
+
+	// 50 Hz hum over an atmospheric pressure, with a 200 Hz component.
+	std::vector<metric::pascal> pressure(2000);
+	for (std::size_t i = 0; i < pressure.size(); ++i)
+		pressure[i] = metric::pascal(101325 + static_cast<long long>(std::nearbyint(
+			40 * std::sin(2 * pi * 50 * i / 1000.) + 40 * std::sin(2 * pi * 200 * i / 1000.))));
+
+	std::vector<metric::pascal> filtered(pressure.size());
+	metric::biquad<metric::pascal> notch = metric::biquad<metric::pascal>::notch(metric::hertz(50), rate, 2);
+	REQUIRE(notch.process(pressure.begin(), pressure.end(), filtered.begin()) == filtered.end());
+	metric::biquad<metric::pascal> lowpass = metric::biquad<metric::pascal>::lowpass(metric::hertz(20), rate);
+	lowpass.process(filtered.begin(), filtered.end(), filtered.begin());
+	REQUIRE(filtered[0] == metric::pascal(101325));
+	long long worst = 0;
+	for (std::size_t i = 1000; i < filtered.size(); ++i)
+		worst = std::max(worst, std::abs(filtered[i].count() - 101325));
+	REQUIRE(worst <= 2);
+
+	metric::biquad<metric::voltage<double>> one = metric::biquad<metric::voltage<double>>::highpass(metric::hertz(10), rate);
+	metric::biquad<metric::voltage<double>> other = one;
+	std::vector<metric::voltage<double>> ramp, block(100), single;
+	for (int i = 0; i < 100; ++i)
+		ramp.push_back(metric::voltage<double>(5 + 0.01 * i));
+	one.process(ramp.begin(), ramp.end(), block.begin());
+	for (const metric::voltage<double>& v : ramp)
+		single.push_back(other(v));
+	for (std::size_t i = 0; i < block.size(); ++i)
+		REQUIRE(block[i].count() == Approx(single[i].count()).margin(1e-12));
+	REQUIRE(block[0].count() == Approx(0).margin(1e-12));
+	metric::biquad<metric::voltage<double>> band = metric::biquad<metric::voltage<double>>::bandpass(metric::hertz(100), rate, 1);
+	band.reset(metric::voltage<double>(3));
+	REQUIRE(band(metric::voltage<double>(3)).count() == Approx(0).margin(1e-12));
+
+	metric::fir_decimator<metric::pascal> decimate(metric::hertz(20), rate, 10, 201);
+	REQUIRE(decimate.factor() == 10);
+	REQUIRE(decimate.taps().size() == 201);
+	std::vector<metric::pascal> low;
+	decimate.process(pressure.begin(), pressure.begin() + 995, std::back_inserter(low));
+	REQUIRE(low.size() == 99);
+	decimate.process(pressure.begin() + 995, pressure.end(), std::back_inserter(low));
+	REQUIRE(low.size() == 200);
+	worst = 0;
+	for (std::size_t i = 21; i < low.size(); ++i)      // Past the 201 taps of the start transient.
+		worst = std::max(worst, std::abs(low[i].count() - 101325));
+	REQUIRE(worst <= 1);
+	metric::pascal out;
+	metric::fir_decimator<metric::pascal> every(metric::hertz(400), rate, 1, 1);
+	REQUIRE(every.push(metric::pascal(7), out));
+	REQUIRE(out == metric::pascal(7));
+	REQUIRE_THROWS_AS(metric::fir_decimator<metric::pascal>(metric::hertz(20), rate, 0), std::invalid_argument);
+}
+
+TEST_CASE( "Resampling (pass)", "[single-file]" )
+{
+	typedef metric::resampler<metric::watt, metric::wattsecond, std::chrono::system_clock> power_resampler;
+	typedef power_resampler::value_type reading;
+	const std::chrono::system_clock::time_point start(std::chrono::hours(24 * 365 * 50));
+	std::vector<power_resampler::bucket> buckets;
+
+	// Constant 100 W, reported at jittery times.
+	power_resampler constant(std::chrono::seconds(1), metric::interpolation::step);
+	REQUIRE(constant.interval() == std::chrono::seconds(1));
+	for (int ms : {300, 1250, 1900, 2050, 3990, 4700})
+		constant.push(reading(start + std::chrono::milliseconds(ms), metric::watt(100)), std::back_inserter(buckets));
+	REQUIRE(buckets.size() == 4);
+	REQUIRE(buckets[0].start == start);
+	REQUIRE(buckets[0].covered == std::chrono::milliseconds(700));
+	REQUIRE(buckets[0].total == metric::wattsecond(70));
+	REQUIRE(buckets[0].mean.count() == Approx(100));
+	for (std::size_t i = 1; i < 4; ++i)
+	{
+		REQUIRE(buckets[i].start == start + std::chrono::seconds(i));
+		REQUIRE(buckets[i].covered == std::chrono::seconds(1));
+		REQUIRE(buckets[i].total == metric::wattsecond(100));
+	}
+	constant.flush(std::back_inserter(buckets));
+	REQUIRE(buckets.size() == 5);
+	REQUIRE(buckets[4].total == metric::wattsecond(70));
+	constant.push(reading(start + std::chrono::seconds(9), metric::watt(1)), std::back_inserter(buckets));
+	REQUIRE_THROWS_AS(constant.push(reading(start, metric::watt(1)), std::back_inserter(buckets)), std::invalid_argument);
+
+	// A ramp of 100 W per second, sampled irregularly: linear interpolation integrates it exactly.
+	std::vector<reading> ramp;
+	for (int ms : {0, 130, 870, 1000, 2600, 3330, 5000, 6400, 8990, 10000})
+		ramp.push_back(reading(start + std::chrono::milliseconds(ms), metric::watt(ms / 10)));
+	buckets.clear();
+	power_resampler linear(std::chrono::seconds(1));
+	linear.push(ramp.begin(), ramp.end(), std::back_inserter(buckets));
+	REQUIRE(buckets.size() == 10);
+	bool exact = true;
+	for (std::size_t k = 0; k < buckets.size(); ++k)
+		exact = exact && buckets[k].total == metric::wattsecond(50 * (2 * static_cast<long long>(k) + 1))
+			&& std::abs(buckets[k].mean.count() - 50. * (2 * k + 1)) < 1e-9;
+	REQUIRE(exact);
+	std::vector<power_resampler::bucket> stepped;
+	power_resampler step(std::chrono::seconds(1), metric::interpolation::step);
+	step.push(ramp.begin(), ramp.end(), std::back_inserter(stepped));
+	REQUIRE(stepped[0].mean.count() == Approx(13 * 0.74 + 87 * 0.13));
+	REQUIRE(stepped[0].total == metric::wattsecond(21));
+
+	// Gaps longer than 5 s are not integrated.
+	buckets.clear();
+	power_resampler gaps(std::chrono::seconds(2), metric::interpolation::step, std::chrono::seconds(5));
+	for (int s : {0, 3, 13, 14})
+		gaps.push(reading(start + std::chrono::seconds(s), metric::watt(10)), std::back_inserter(buckets));
+	REQUIRE(buckets.size() == 7);
+	REQUIRE(buckets[1].total == metric::wattsecond(10));
+	REQUIRE(buckets[1].covered == std::chrono::seconds(1));
+	REQUIRE(buckets[2].covered == std::chrono::seconds(0));
+	REQUIRE(buckets[5].covered == std::chrono::seconds(0));
+	REQUIRE(buckets[5].mean.count() == 0);
+	REQUIRE(buckets[6].covered == std::chrono::seconds(1));
+
+	// 1 ml/s in half second buckets: rounding errors are carried.
+	typedef metric::resampler<metric::millilitre_second, metric::millilitre> flow_resampler;
+	flow_resampler flows(std::chrono::milliseconds(500));
+	std::vector<flow_resampler::bucket> volumes;
+	const flow_resampler::time_point origin;
+	for (int s = 0; s <= 10; ++s)
+		flows.push(flow_resampler::value_type(origin + std::chrono::seconds(s), metric::millilitre_second(1)), std::back_inserter(volumes));
+	REQUIRE(volumes.size() == 20);
+	long long litres = 0;
+	for (const flow_resampler::bucket& b : volumes)
+	{
+		litres += b.total.count();
+		REQUIRE((b.total.count() == 0 || b.total.count() == 1));
+	}
+	REQUIRE(litres == 10);
+	metric::resampler<metric::millilitre_second, metric::litre> coarse(std::chrono::minutes(1));
+	REQUIRE(coarse.interval() == std::chrono::minutes(1));
+	REQUIRE_THROWS_AS(flow_resampler(std::chrono::seconds(0)), std::invalid_argument);
+}